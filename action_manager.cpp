@@ -66,7 +66,7 @@ void Action::getAchievingEffects(const Atom& atom, std::vector<const Atom*>& ach
 	for (std::vector<const Atom*>::const_iterator ci = effects_->begin(); ci != effects_->end(); ci++)
 	{
 		const Atom* effect = *ci;
-		if (effect->getPredicate().getName() != atom.getPredicate().getName())
+		if (effect->getPredicate().getNameId() != atom.getPredicate().getNameId())
 		//if (&effect->getPredicate() != &atom.getPredicate())
 			continue;
 
@@ -30,7 +30,7 @@ ColouredGraphNodePredicates::ColouredGraphNodePredicates(const Predicate& predic
 
 bool ColouredGraphNodePredicates::isEquivalentTo(const Predicate& predicate, int invariables, const std::vector<const Object*>& objects) const
 {
-	if (predicate.getName() != predicates_->getName() || predicate.getArity() != predicates_->getArity() || invariables != invariables_ || objects_.size() != objects.size())
+	if (predicate.getNameId() != predicates_->getNameId() || predicate.getArity() != predicates_->getArity() || invariables != invariables_ || objects_.size() != objects.size())
 	{
 		return false;
 	}
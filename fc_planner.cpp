@@ -1,8 +1,11 @@
 #include "fc_planner.h"
 
 #include <queue>
+#include <set>
+#include <algorithm>
 #include <cmath>
 #include <time.h>
+#include <boost/functional/hash.hpp>
 
 #include "formula.h"
 #include "predicate_manager.h"
@@ -17,6 +20,7 @@
 #include "type_manager.h"
 #include "heuristics/fact_set.h"
 #include "coloured_graph.h"
+#include "search_trace.h"
 
 //#define FC_PLANNER_SAFE_MEMORY
 
@@ -76,13 +80,29 @@ bool StateStoreListener::continueSearching()
 }
 	
 std::vector<const GroundedAction*> GroundedAction::instantiated_grounded_actions_;
+std::vector<unsigned int> GroundedAction::free_ids_;
+boost::unordered_multimap<std::size_t, unsigned int> GroundedAction::grounded_action_index_;
 std::vector<const GroundedAtom*> GroundedAtom::instantiated_grounded_atoms_;
+std::vector<unsigned int> GroundedAtom::free_ids_;
+boost::unordered_multimap<std::size_t, unsigned int> GroundedAtom::grounded_atom_index_;
+
+std::size_t GroundedAction::getKey(const Action& action, const Object** variables)
+{
+	std::size_t key = boost::hash<const Action*>()(&action);
+	for (unsigned int i = 0; i < action.getVariables().size(); ++i)
+	{
+		boost::hash_combine(key, variables[i]->getId());
+	}
+	return key;
+}
 
 const GroundedAction& GroundedAction::getGroundedAction(const Action& action, const Object** variables)
 {
-	for (std::vector<const GroundedAction*>::const_iterator ci = instantiated_grounded_actions_.begin(); ci != instantiated_grounded_actions_.end(); ci++)
+	std::size_t key = getKey(action, variables);
+	std::pair<boost::unordered_multimap<std::size_t, unsigned int>::const_iterator, boost::unordered_multimap<std::size_t, unsigned int>::const_iterator> candidates = grounded_action_index_.equal_range(key);
+	for (boost::unordered_multimap<std::size_t, unsigned int>::const_iterator ci = candidates.first; ci != candidates.second; ++ci)
 	{
-		const GroundedAction* instantiated_action = *ci;
+		const GroundedAction* instantiated_action = instantiated_grounded_actions_[(*ci).second];
 		if (instantiated_action->action_ != &action) continue;
 		bool variables_match = true;
 		for (unsigned int i = 0; i < action.getVariables().size(); i++)
@@ -103,20 +123,54 @@ const GroundedAction& GroundedAction::getGroundedAction(const Action& action, co
 		copied_variables[i] = variables[i];
 	}
 	
-	GroundedAction* new_grounded_action = new GroundedAction(action, copied_variables);
-	instantiated_grounded_actions_.push_back(new_grounded_action);
+	unsigned int id = instantiated_grounded_actions_.size();
+	if (!free_ids_.empty())
+	{
+		id = free_ids_.back();
+		free_ids_.pop_back();
+	}
+	
+	GroundedAction* new_grounded_action = new GroundedAction(id, action, copied_variables);
+	if (id == instantiated_grounded_actions_.size())
+	{
+		instantiated_grounded_actions_.push_back(new_grounded_action);
+	}
+	else
+	{
+		instantiated_grounded_actions_[id] = new_grounded_action;
+	}
+	grounded_action_index_.insert(std::make_pair(key, id));
 	return *new_grounded_action;
 }
 
+void GroundedAction::removeInstantiatedGroundedAction(const GroundedAction& grounded_action)
+{
+	std::pair<boost::unordered_multimap<std::size_t, unsigned int>::iterator, boost::unordered_multimap<std::size_t, unsigned int>::iterator> candidates = grounded_action_index_.equal_range(getKey(*grounded_action.action_, grounded_action.variables_));
+	for (boost::unordered_multimap<std::size_t, unsigned int>::iterator i = candidates.first; i != candidates.second; ++i)
+	{
+		if ((*i).second == grounded_action.id_)
+		{
+			grounded_action_index_.erase(i);
+			break;
+		}
+	}
+	
+	instantiated_grounded_actions_[grounded_action.id_] = NULL;
+	free_ids_.push_back(grounded_action.id_);
+	delete &grounded_action;
+}
+
 void GroundedAction::removeInstantiatedGroundedActions(std::vector<const GroundedAction*>::const_iterator begin, std::vector<const GroundedAction*>::const_iterator end)
 {
-	for (std::vector<const GroundedAction*>::reverse_iterator ri = instantiated_grounded_actions_.rbegin(); ri != instantiated_grounded_actions_.rend(); ++ri)
+	std::vector<const GroundedAction*> sorted_exceptions(begin, end);
+	std::sort(sorted_exceptions.begin(), sorted_exceptions.end());
+	
+	for (std::vector<const GroundedAction*>::const_iterator ci = instantiated_grounded_actions_.begin(); ci != instantiated_grounded_actions_.end(); ++ci)
 	{
-		const GroundedAction* grounded_action = *ri;
-		if (std::find(begin, end, grounded_action) == end)
+		const GroundedAction* grounded_action = *ci;
+		if (grounded_action != NULL && !std::binary_search(sorted_exceptions.begin(), sorted_exceptions.end(), grounded_action))
 		{
-			delete *ri;
-			instantiated_grounded_actions_.erase(ri.base() - 1);
+			removeInstantiatedGroundedAction(*grounded_action);
 		}
 	}
 }
@@ -141,34 +195,36 @@ void GroundedAction::removeInstantiatedGroundedActions()
 		delete *ci;
 	}
 	instantiated_grounded_actions_.clear();
+	free_ids_.clear();
+	grounded_action_index_.clear();
 }
 
 unsigned int GroundedAction::numberOfGroundedActions()
 {
-	return instantiated_grounded_actions_.size();
-}
-	
-GroundedAction::GroundedAction(const Action& action, const Object** variables)
-	: action_(&action), variables_(variables)
-{
-	
-}
-
-GroundedAction::~GroundedAction()
-{
-	delete[] variables_;
+	return instantiated_grounded_actions_.size() - free_ids_.size();
 }
 
-void GroundedAction::applyTo(std::vector<const GroundedAtom*>& facts) const
+std::size_t GroundedAction::getMemoryUsage()
 {
-/*
-	std::cout << "Apply: " << *this << std::endl;
-	for (std::vector<const GroundedAtom*>::const_iterator ci = facts.begin(); ci != facts.end(); ++ci)
+	std::size_t memory_usage = instantiated_grounded_actions_.capacity() * sizeof(const GroundedAction*);
+	for (std::vector<const GroundedAction*>::const_iterator ci = instantiated_grounded_actions_.begin(); ci != instantiated_grounded_actions_.end(); ++ci)
 	{
-		std::cout << "* " << **ci << std::endl;
+		const GroundedAction* grounded_action = *ci;
+		if (grounded_action == NULL)
+		{
+			continue;
+		}
+		memory_usage += sizeof(GroundedAction) + grounded_action->action_->getVariables().size() * sizeof(const Object*) + (grounded_action->add_effects_.capacity() + grounded_action->delete_effects_.capacity()) * sizeof(unsigned int);
 	}
-*/
-	std::vector<const GroundedAtom*> to_add;
+	// The entries of the hash table.
+	memory_usage += grounded_action_index_.size() * (sizeof(std::size_t) + sizeof(unsigned int) + 2 * sizeof(void*));
+	return memory_usage;
+}
+	
+GroundedAction::GroundedAction(unsigned int id, const Action& action, const Object** variables)
+	: id_(id), action_(&action), variables_(variables)
+{
+	// Ground the effects once, so applying this action to a state only has to update the ids of the facts.
 	for (unsigned int effect_index = 0; effect_index < action_->getEffects().size(); ++effect_index)
 	{
 		const Atom* effect = action_->getEffects()[effect_index];
@@ -182,23 +238,49 @@ void GroundedAction::applyTo(std::vector<const GroundedAtom*>& facts) const
 		const GroundedAtom& grounded_effect = GroundedAtom::getGroundedAtom(effect->getPredicate(), effect_variables);
 		if (effect->isNegative())
 		{
-//			std::cout << "Remove: " << grounded_effect << std::endl;
-			// Normalise we assume that effect can only delete facts which are mentioned in the preconditions. But some domains
-			// like Satellite do not conform to this assumption.
-			std::vector<const GroundedAtom*>::iterator ci = std::find(facts.begin(), facts.end(), &grounded_effect);
-			if (ci != facts.end())
-			{
-				facts.erase(ci);
-			}
+			delete_effects_.push_back(grounded_effect.getId());
 		}
 		else
 		{
-//			std::cout << "Add: " << grounded_effect << std::endl;
-			to_add.push_back(&grounded_effect);
+			add_effects_.push_back(grounded_effect.getId());
+		}
+	}
+	
+	std::sort(delete_effects_.begin(), delete_effects_.end());
+	delete_effects_.erase(std::unique(delete_effects_.begin(), delete_effects_.end()), delete_effects_.end());
+	std::sort(add_effects_.begin(), add_effects_.end());
+	add_effects_.erase(std::unique(add_effects_.begin(), add_effects_.end()), add_effects_.end());
+}
+
+GroundedAction::~GroundedAction()
+{
+	delete[] variables_;
+}
+
+void GroundedAction::applyTo(std::vector<unsigned int>& facts, std::size_t& signature) const
+{
+	// The delete effects are applied before the add effects, so a fact which is both deleted and added remains true.
+	for (std::vector<unsigned int>::const_iterator ci = delete_effects_.begin(); ci != delete_effects_.end(); ++ci)
+	{
+		// Normalise we assume that effect can only delete facts which are mentioned in the preconditions. But some domains
+		// like Satellite do not conform to this assumption.
+		std::vector<unsigned int>::iterator fact_i = std::lower_bound(facts.begin(), facts.end(), *ci);
+		if (fact_i != facts.end() && *fact_i == *ci)
+		{
+			signature ^= GroundedAtom::getGroundedAtom(*ci).getSignature();
+			facts.erase(fact_i);
 		}
 	}
 	
-	facts.insert(facts.end(), to_add.begin(), to_add.end());
+	for (std::vector<unsigned int>::const_iterator ci = add_effects_.begin(); ci != add_effects_.end(); ++ci)
+	{
+		std::vector<unsigned int>::iterator fact_i = std::lower_bound(facts.begin(), facts.end(), *ci);
+		if (fact_i == facts.end() || *fact_i != *ci)
+		{
+			signature ^= GroundedAtom::getGroundedAtom(*ci).getSignature();
+			facts.insert(fact_i, *ci);
+		}
+	}
 }
 
 std::ostream& operator<<(std::ostream& os, const GroundedAction& grounded_action)
@@ -220,29 +302,68 @@ void GroundedAtom::removeInstantiatedGroundedAtom()
 		delete grounded_atom;
 	}
 	instantiated_grounded_atoms_.clear();
+	free_ids_.clear();
+	grounded_atom_index_.clear();
 }
 
 void GroundedAtom::removeInstantiatedGroundedAtom(const std::vector<const GroundedAtom*>& exceptions)
 {
-	for (std::vector<const GroundedAtom*>::reverse_iterator ri = instantiated_grounded_atoms_.rbegin(); ri != instantiated_grounded_atoms_.rend(); ++ri)
+	std::vector<const GroundedAtom*> sorted_exceptions(exceptions);
+	std::sort(sorted_exceptions.begin(), sorted_exceptions.end());
+	
+	for (unsigned int i = 0; i < instantiated_grounded_atoms_.size(); ++i)
 	{
-		const GroundedAtom* grounded_atom = *ri;
-		if (std::find(exceptions.begin(), exceptions.end(), grounded_atom) == exceptions.end())
+		const GroundedAtom* grounded_atom = instantiated_grounded_atoms_[i];
+		if (grounded_atom == NULL || std::binary_search(sorted_exceptions.begin(), sorted_exceptions.end(), grounded_atom))
 		{
-			delete grounded_atom;
-			instantiated_grounded_atoms_.erase(ri.base() - 1);
+			continue;
+		}
+		
+		std::pair<boost::unordered_multimap<std::size_t, unsigned int>::iterator, boost::unordered_multimap<std::size_t, unsigned int>::iterator> candidates = grounded_atom_index_.equal_range(grounded_atom->getSignature());
+		for (boost::unordered_multimap<std::size_t, unsigned int>::iterator index_i = candidates.first; index_i != candidates.second; ++index_i)
+		{
+			if ((*index_i).second == i)
+			{
+				grounded_atom_index_.erase(index_i);
+				break;
+			}
 		}
+		
+		// Leave the slot empty so the ids of the remaining grounded atoms do not change.
+		delete grounded_atom;
+		instantiated_grounded_atoms_[i] = NULL;
+		free_ids_.push_back(i);
+	}
+}
+
+std::size_t GroundedAtom::getKey(const Predicate& predicate, const Object** variables)
+{
+	// Predicates with the same name are treated as the same predicate, so the name id is hashed instead of the predicate's id.
+	std::size_t key = boost::hash<unsigned int>()(predicate.getNameId());
+	for (unsigned int i = 0; i < predicate.getArity(); ++i)
+	{
+		boost::hash_combine(key, variables[i]->getId());
 	}
+	
+	// Spread the bits of the key, the keys of the facts are XOR-ed together to form the signature of a state.
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+	key *= 0xc4ceb9fe1a85ec53ULL;
+	key ^= key >> 33;
+	return key;
 }
 
 const GroundedAtom& GroundedAtom::getGroundedAtom(const Predicate& predicate, const Object** variables)
 {
-	for (std::vector<const GroundedAtom*>::const_iterator ci = instantiated_grounded_atoms_.begin(); ci != instantiated_grounded_atoms_.end(); ++ci)
+	std::size_t key = getKey(predicate, variables);
+	std::pair<boost::unordered_multimap<std::size_t, unsigned int>::const_iterator, boost::unordered_multimap<std::size_t, unsigned int>::const_iterator> candidates = grounded_atom_index_.equal_range(key);
+	for (boost::unordered_multimap<std::size_t, unsigned int>::const_iterator ci = candidates.first; ci != candidates.second; ++ci)
 	{
-		const GroundedAtom* grounded_atom = *ci;
+		const GroundedAtom* grounded_atom = instantiated_grounded_atoms_[(*ci).second];
 		
 		if (grounded_atom->getPredicate().getArity() != predicate.getArity() ||
-		    grounded_atom->getPredicate().getName() != predicate.getName())
+		    grounded_atom->getPredicate().getNameId() != predicate.getNameId())
 		{
 			continue;
 		}
@@ -263,8 +384,23 @@ const GroundedAtom& GroundedAtom::getGroundedAtom(const Predicate& predicate, co
 		}
 	}
 	
-	GroundedAtom* new_grounded_atom = new GroundedAtom(predicate, variables);
-	instantiated_grounded_atoms_.push_back(new_grounded_atom);
+	unsigned int id = instantiated_grounded_atoms_.size();
+	if (!free_ids_.empty())
+	{
+		id = free_ids_.back();
+		free_ids_.pop_back();
+	}
+	
+	GroundedAtom* new_grounded_atom = new GroundedAtom(id, predicate, variables);
+	if (id == instantiated_grounded_atoms_.size())
+	{
+		instantiated_grounded_atoms_.push_back(new_grounded_atom);
+	}
+	else
+	{
+		instantiated_grounded_atoms_[id] = new_grounded_atom;
+	}
+	grounded_atom_index_.insert(std::make_pair(key, id));
 	return *new_grounded_atom;
 }
 
@@ -332,11 +468,28 @@ const GroundedAtom& GroundedAtom::getGroundedAtom(const SAS_Plus::BoundedAtom& b
 */
 unsigned int GroundedAtom::numberOfGroundedAtoms()
 {
-	return instantiated_grounded_atoms_.size();
+	return instantiated_grounded_atoms_.size() - free_ids_.size();
+}
+
+std::size_t GroundedAtom::getMemoryUsage()
+{
+	std::size_t memory_usage = instantiated_grounded_atoms_.capacity() * sizeof(const GroundedAtom*);
+	for (std::vector<const GroundedAtom*>::const_iterator ci = instantiated_grounded_atoms_.begin(); ci != instantiated_grounded_atoms_.end(); ++ci)
+	{
+		const GroundedAtom* grounded_atom = *ci;
+		if (grounded_atom == NULL)
+		{
+			continue;
+		}
+		memory_usage += sizeof(GroundedAtom) + grounded_atom->predicate_->getArity() * sizeof(const Object*);
+	}
+	// The entries of the hash table.
+	memory_usage += grounded_atom_index_.size() * (sizeof(std::size_t) + sizeof(unsigned int) + 2 * sizeof(void*));
+	return memory_usage;
 }
 
-GroundedAtom::GroundedAtom(const Predicate& predicate, const Object** variables)
-	: predicate_(&predicate), variables_(variables)
+GroundedAtom::GroundedAtom(unsigned int id, const Predicate& predicate, const Object** variables)
+	: id_(id), predicate_(&predicate), variables_(variables), signature_(getKey(predicate, variables))
 {
 //	std::cout << "New Grounded atom: " << *this << std::endl;
 }
@@ -362,7 +515,7 @@ GroundedAtom::~GroundedAtom()
 
 bool GroundedAtom::operator==(const GroundedAtom& rhs) const
 {
-	if (predicate_->getName() != rhs.predicate_->getName() ||
+	if (predicate_->getNameId() != rhs.predicate_->getNameId() ||
 	    predicate_->getArity() != rhs.predicate_->getArity()) return false;
 	
 	for (unsigned int i = 0; i < predicate_->getArity(); i++)
@@ -388,28 +541,138 @@ std::ostream& operator<<(std::ostream& os, const GroundedAtom& grounded_atom)
 	return os;
 }
 
-/*
-State::State(const std::vector<const GroundedAtom*>& facts, bool created_by_helpful_action)
-	: parent_(NULL), achieving_action_(NULL), facts_(facts), distance_to_goal_(0), distance_from_start_(0), created_by_helpful_action_(created_by_helpful_action)
+FactIndex::FactIndex(const State& state)
 {
-	assert (facts_.size() == facts.size());
-	std::sort(facts_.begin(), facts_.end());
-	//checkSanity();
+	for (std::vector<unsigned int>::const_iterator ci = state.getFactIds().begin(); ci != state.getFactIds().end(); ++ci)
+	{
+		const GroundedAtom& fact = GroundedAtom::getGroundedAtom(*ci);
+		std::pair<unsigned int, unsigned int> predicate_key(fact.getPredicate().getNameId(), fact.getPredicate().getArity());
+		predicate_buckets_[predicate_key].push_back(&fact);
+		
+		for (unsigned int term_index = 0; term_index < fact.getPredicate().getArity(); ++term_index)
+		{
+			term_buckets_[std::make_pair(predicate_key, std::make_pair(term_index, &fact.getObject(term_index)))].push_back(&fact);
+		}
+	}
+}
+
+const std::vector<const GroundedAtom*>* FactIndex::getFacts(unsigned int name_id, unsigned int arity) const
+{
+	boost::unordered_map<std::pair<unsigned int, unsigned int>, std::vector<const GroundedAtom*> >::const_iterator ci = predicate_buckets_.find(std::make_pair(name_id, arity));
+	if (ci == predicate_buckets_.end())
+	{
+		return NULL;
+	}
+	return &(*ci).second;
+}
+
+const std::vector<const GroundedAtom*>* FactIndex::getFacts(unsigned int name_id, unsigned int arity, unsigned int term_index, const Object& object) const
+{
+	boost::unordered_map<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, const Object*> >, std::vector<const GroundedAtom*> >::const_iterator ci = term_buckets_.find(std::make_pair(std::make_pair(name_id, arity), std::make_pair(term_index, &object)));
+	if (ci == term_buckets_.end())
+	{
+		return NULL;
+	}
+	return &(*ci).second;
+}
+
+CompiledAction::CompiledAction(const Action& action, const TypeManager& type_manager)
+	: action_(&action)
+{
+	std::vector<const Atom*> preconditions;
+	std::vector<const Equality*> equalities;
+	Utility::convertFormula(preconditions, equalities, &action.getPrecondition());
+	
+	// Order the preconditions greedily, the next precondition to match is the one with the most variables which are already
+	// assigned by the preconditions before it.
+	std::vector<bool> is_variable_assigned(action.getVariables().size(), false);
+	std::vector<bool> is_precondition_ordered(preconditions.size(), false);
+	for (unsigned int i = 0; i < preconditions.size(); ++i)
+	{
+		unsigned int best_precondition_index = preconditions.size();
+		unsigned int best_assigned_terms = 0;
+		for (unsigned int precondition_index = 0; precondition_index < preconditions.size(); ++precondition_index)
+		{
+			if (is_precondition_ordered[precondition_index]) continue;
+			
+			const Atom* precondition = preconditions[precondition_index];
+			unsigned int assigned_terms = 0;
+			for (unsigned int term_index = 0; term_index < precondition->getArity(); ++term_index)
+			{
+				unsigned int variable_index = action.getActionVariable(*precondition->getTerms()[term_index]);
+				assert (variable_index < action.getVariables().size());
+				if (is_variable_assigned[variable_index]) ++assigned_terms;
+			}
+			
+			if (best_precondition_index == preconditions.size() || assigned_terms > best_assigned_terms)
+			{
+				best_precondition_index = precondition_index;
+				best_assigned_terms = assigned_terms;
+			}
+		}
+		
+		is_precondition_ordered[best_precondition_index] = true;
+		const Atom* precondition = preconditions[best_precondition_index];
+		
+		CompiledPrecondition compiled_precondition;
+		compiled_precondition.name_id_ = precondition->getPredicate().getNameId();
+		compiled_precondition.arity_ = precondition->getArity();
+		compiled_precondition.bound_term_index_ = -1;
+		for (unsigned int term_index = 0; term_index < precondition->getArity(); ++term_index)
+		{
+			unsigned int variable_index = action.getActionVariable(*precondition->getTerms()[term_index]);
+			compiled_precondition.variable_indexes_.push_back(variable_index);
+			if (compiled_precondition.bound_term_index_ == -1 && is_variable_assigned[variable_index])
+			{
+				compiled_precondition.bound_term_index_ = term_index;
+			}
+		}
+		
+		for (std::vector<unsigned int>::const_iterator ci = compiled_precondition.variable_indexes_.begin(); ci != compiled_precondition.variable_indexes_.end(); ++ci)
+		{
+			is_variable_assigned[*ci] = true;
+		}
+		preconditions_.push_back(compiled_precondition);
+	}
+	
+	for (std::vector<const Equality*>::const_iterator ci = equalities.begin(); ci != equalities.end(); ++ci)
+	{
+		const Equality* equality = *ci;
+		unsigned int lhs_term_index = action.getActionVariable(equality->getLHSTerm());
+		unsigned int rhs_term_index = action.getActionVariable(equality->getRHSTerm());
+		assert (lhs_term_index < action.getVariables().size());
+		assert (rhs_term_index < action.getVariables().size());
+		equalities_.push_back(std::make_pair(std::make_pair(lhs_term_index, rhs_term_index), equality->isNegative()));
+	}
+	
+	objects_.resize(action.getVariables().size());
+	for (unsigned int i = 0; i < action.getVariables().size(); ++i)
+	{
+		type_manager.getObjectsOfType(objects_[i], *action.getVariables()[i]->getType());
+	}
 }
-*/
 
-State::State(bool created_by_helpful_action)
-	: parent_(NULL), achieving_action_(NULL), distance_to_goal_(0), distance_from_start_(0), created_by_helpful_action_(created_by_helpful_action)
+State::State(const std::vector<const GroundedAtom*>& facts, bool created_by_helpful_action)
+	: parent_(NULL), achieving_action_(NULL), distance_to_goal_(0), distance_from_start_(0), signature_(0), created_by_helpful_action_(created_by_helpful_action)
 {
+	for (std::vector<const GroundedAtom*>::const_iterator ci = facts.begin(); ci != facts.end(); ++ci)
+	{
+		facts_.push_back((*ci)->getId());
+	}
+	std::sort(facts_.begin(), facts_.end());
+	facts_.erase(std::unique(facts_.begin(), facts_.end()), facts_.end());
 	
+	for (std::vector<unsigned int>::const_iterator ci = facts_.begin(); ci != facts_.end(); ++ci)
+	{
+		signature_ ^= GroundedAtom::getGroundedAtom(*ci).getSignature();
+	}
+	//checkSanity();
 }
 
 State::State(const State& rhs, const GroundedAction& grounded_action, bool created_by_helpful_action)
-	: parent_(&rhs), achieving_action_(&grounded_action)/*, facts_(rhs.facts_)*/, distance_to_goal_(rhs.distance_to_goal_), distance_from_start_(rhs.distance_from_start_ + 1), created_by_helpful_action_(created_by_helpful_action)
+	: parent_(&rhs), achieving_action_(&grounded_action), facts_(rhs.facts_), distance_to_goal_(rhs.distance_to_goal_), distance_from_start_(rhs.distance_from_start_ + 1), signature_(rhs.signature_), created_by_helpful_action_(created_by_helpful_action)
 {
-	//achievers_.insert(achievers_.end(), rhs.achievers_.begin(), rhs.achievers_.end());
-	//achievers_.push_back(&grounded_action);
-	//	std::sort(facts_.begin(), facts_.end());
+	grounded_action.applyTo(facts_, signature_);
 	//checkSanity();
 }
 
@@ -477,7 +740,7 @@ bool State::areSymmetrical(const State& state, const HEURISTICS::HeuristicInterf
 	ColouredGraph rhs_cg(rhs_symmetrical_groups);
 	
 	std::vector<const GroundedAtom*> state_facts;
-	getFacts(initial_facts, state_facts);
+	getFacts(state_facts);
 	
 	//for (std::vector<const GroundedAtom*>::const_iterator ci = getFacts().begin(); ci != getFacts().end(); ++ci)
 	for (std::vector<const GroundedAtom*>::const_iterator ci = state_facts.begin(); ci != state_facts.end(); ++ci)
@@ -501,7 +764,7 @@ bool State::areSymmetrical(const State& state, const HEURISTICS::HeuristicInterf
 	}
 	
 	std::vector<const GroundedAtom*> other_state_facts;
-	state.getFacts(initial_facts, other_state_facts);
+	state.getFacts(other_state_facts);
 	
 	//for (std::vector<const GroundedAtom*>::const_iterator ci = state.getFacts().begin(); ci != state.getFacts().end(); ++ci)
 	for (std::vector<const GroundedAtom*>::const_iterator ci = other_state_facts.begin(); ci != other_state_facts.end(); ++ci)
@@ -683,7 +946,7 @@ void State::getSymmetricalObjects(std::vector<REACHABILITY::ReachableFact*>& sta
 
 //void State::getSuccessors(NewStateReachedListener& listener, const std::multimap<const Object*, const Object*>& symmetrical_groups, const ActionManager& action_manager, const TypeManager& type_manager, bool prune_unhelpful_actions, const std::vector<const State*>& all_states) const
 //void State::getSuccessors(NewStateReachedListener& listener, const std::multimap<const Object*, const Object*>& symmetrical_groups, const ActionManager& action_manager, const TypeManager& type_manager, bool prune_unhelpful_actions, const std::vector<const State*>& all_states, const TermManager& term_manager, const std::vector<const GroundedAtom*>& goals, const HEURISTICS::HeuristicInterface& heuristic) const
-void State::getSuccessors(NewStateReachedListener& listener, const std::multimap<const Object*, const Object*>& symmetrical_groups, const ActionManager& action_manager, const TypeManager& type_manager, bool prune_unhelpful_actions, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >& helpful_actions) const
+void State::getSuccessors(NewStateReachedListener& listener, const std::multimap<const Object*, const Object*>& symmetrical_groups, const std::vector<const CompiledAction*>& compiled_actions, bool prune_unhelpful_actions, const std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >& helpful_actions) const
 {
 #ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
 	std::cout << "Find successors of" << std::endl << *this << std::endl;
@@ -808,64 +1071,43 @@ void State::getSuccessors(NewStateReachedListener& listener, const std::multimap
 	}
 	else*/
 	{
-		for (std::vector<Action*>::const_iterator ci = action_manager.getManagableObjects().begin(); ci != action_manager.getManagableObjects().end(); ci++)
+		FactIndex fact_index(*this);
+		for (std::vector<const CompiledAction*>::const_iterator ci = compiled_actions.begin(); ci != compiled_actions.end() && listener.continueSearching(); ci++)
 		{
-			const Action* action = *ci;
-			
-			std::vector<const Atom*> preconditions;
-			std::vector<const Equality*> equalities;
-			Utility::convertFormula(preconditions, equalities, &action->getPrecondition());
+			const CompiledAction* compiled_action = *ci;
 			
 			// Construct all grounded variants of this action which are applicable in this state.
-			const Object* assigned_variables[action->getVariables().size()];
-			memset(assigned_variables, 0, sizeof(Object*) * action->getVariables().size());
+			const Object* assigned_variables[compiled_action->getAction().getVariables().size()];
+			memset(assigned_variables, 0, sizeof(Object*) * compiled_action->getAction().getVariables().size());
 			
-			instantiateAndExecuteAction(listener, symmetrical_groups, *action, preconditions, equalities, 0, assigned_variables, type_manager, prune_unhelpful_actions, initial_facts, helpful_actions);
+			instantiateAndExecuteAction(listener, symmetrical_groups, *compiled_action, fact_index, 0, assigned_variables, prune_unhelpful_actions, helpful_actions);
 		}
 	}
 #ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
-	std::cout << "Found: " << action_manager.getManagableObjects().size() << " successors states for: " << std::endl << *this << std::endl;
+	std::cout << "Found: " << compiled_actions.size() << " successors states for: " << std::endl << *this << std::endl;
 #endif
 }
 
-bool State::isSuperSetOf(const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& facts) const
+bool State::isSuperSetOf(const std::vector<const GroundedAtom*>& facts) const
 {
 	for (std::vector<const GroundedAtom*>::const_iterator ci = facts.begin(); ci != facts.end(); ci++)
 	{
-		const GroundedAtom* goal_fact = *ci;
-		bool is_satisfied = false;
-		
-		std::vector<const GroundedAtom*> state_facts;
-		getFacts(initial_facts, state_facts);
-		
-		//for (std::vector<const GroundedAtom*>::const_iterator ci = facts_.begin(); ci != facts_.end(); ci++)
-		for (std::vector<const GroundedAtom*>::const_iterator ci = state_facts.begin(); ci != state_facts.end(); ++ci)
-		{
-			if (**ci == *goal_fact)
-			{
-				is_satisfied = true;
-				break;
-			}
-		}
-		if (!is_satisfied) return false;
+		if (!std::binary_search(facts_.begin(), facts_.end(), (*ci)->getId())) return false;
 	}
 	return true;
 }
 
-void State::getFacts(const std::vector<const GroundedAtom*>& initial_facts, std::vector<const GroundedAtom*>& facts) const
+void State::releaseFacts()
 {
-	if (parent_ != NULL)
-	{
-		parent_->getFacts(initial_facts, facts);
-		achieving_action_->applyTo(facts);
-	}
-	
-	// If there is no parent then we are at the initial state.
-	else
+	std::vector<unsigned int>().swap(facts_);
+}
+
+void State::getFacts(std::vector<const GroundedAtom*>& facts) const
+{
+	for (std::vector<unsigned int>::const_iterator ci = facts_.begin(); ci != facts_.end(); ++ci)
 	{
-		facts.insert(facts.end(), initial_facts.begin(), initial_facts.end());
+		facts.push_back(&GroundedAtom::getGroundedAtom(*ci));
 	}
-	std::sort(facts.begin(), facts.end());
 }
 
 /*
@@ -1010,22 +1252,44 @@ void State::removeFact(const GroundedAtom& fact)
 	std::sort(facts_.begin(), facts_.end());
 }
 */
-void State::instantiateAndExecuteAction(NewStateReachedListener& listener, const std::multimap<const Object*, const Object*>& symmetrical_groups, const Action& action, const std::vector<const Atom*>& preconditions, const std::vector<const Equality*>& equalities, unsigned int uninitialised_precondition_index, const Object** assigned_variables, const TypeManager& type_manager, bool prune_unhelpful_actions, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >& helpful_actions) const
+void State::instantiateAndExecuteAction(NewStateReachedListener& listener, const std::multimap<const Object*, const Object*>& symmetrical_groups, const CompiledAction& compiled_action, const FactIndex& fact_index, unsigned int uninitialised_precondition_index, const Object** assigned_variables, bool prune_unhelpful_actions, const std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >& helpful_actions) const
 {
+	const Action& action = compiled_action.getAction();
+	
+	// All the preconditions are satisfied.
+	if (uninitialised_precondition_index == compiled_action.getPreconditions().size())
+	{
+		executeAction(listener, compiled_action, assigned_variables, prune_unhelpful_actions, helpful_actions);
+		return;
+	}
+	
 	// Find facts in the current state which can unify with the 'uninitialised_precondition_index'th precondition and does not violate the already assigned variables.
-	const Atom* precondition = preconditions[uninitialised_precondition_index];
+	const CompiledPrecondition& precondition = compiled_action.getPreconditions()[uninitialised_precondition_index];
+	const std::vector<const GroundedAtom*>* candidate_facts = NULL;
+	if (precondition.bound_term_index_ == -1)
+	{
+		candidate_facts = fact_index.getFacts(precondition.name_id_, precondition.arity_);
+	}
+	else
+	{
+		const Object* bound_object = assigned_variables[precondition.variable_indexes_[precondition.bound_term_index_]];
+		assert (bound_object != NULL);
+		candidate_facts = fact_index.getFacts(precondition.name_id_, precondition.arity_, precondition.bound_term_index_, *bound_object);
+	}
+	
+	if (candidate_facts == NULL)
+	{
+		return;
+	}
+	
+	bool is_last_precondition = uninitialised_precondition_index + 1 == compiled_action.getPreconditions().size();
 	std::vector<const GroundedAtom*> already_tried_facts;
 	
 	//std::cout << "Try to apply: " << action << "." << std::endl;
 	
-	std::vector<const GroundedAtom*> state_facts;
-	getFacts(initial_facts, state_facts);
-	
-	//for (std::vector<const GroundedAtom*>::const_iterator ci = facts_.begin(); ci != facts_.end() && listener.continueSearching(); ci++)
-	for (std::vector<const GroundedAtom*>::const_iterator ci = state_facts.begin(); ci != state_facts.end() && listener.continueSearching(); ++ci)
+	for (std::vector<const GroundedAtom*>::const_iterator ci = candidate_facts->begin(); ci != candidate_facts->end() && listener.continueSearching(); ++ci)
 	{
 		const GroundedAtom* grounded_atom = *ci;
-		if (grounded_atom->getPredicate().getArity() != precondition->getArity() || grounded_atom->getPredicate().getName() != precondition->getPredicate().getName()) continue;
 		
 		// Check if none of the assigned variables are violated.
 		bool constraints_satisfied = true;
@@ -1033,11 +1297,10 @@ void State::instantiateAndExecuteAction(NewStateReachedListener& listener, const
 		const Object* new_assigned_variables[action.getVariables().size()];
 		memcpy(new_assigned_variables, assigned_variables, sizeof(const Object*) * action.getVariables().size());
 		
-		for (unsigned int i = 0; i < grounded_atom->getPredicate().getArity(); i++)
+		for (unsigned int i = 0; i < precondition.arity_; i++)
 		{
-			assert (std::find(action.getVariables().begin(), action.getVariables().end(), precondition->getTerms()[i]) != action.getVariables().end());
-			unsigned int variable_index = std::distance(action.getVariables().begin(), std::find(action.getVariables().begin(), action.getVariables().end(), precondition->getTerms()[i]));
-			if ((assigned_variables[variable_index] != NULL && assigned_variables[variable_index] != &grounded_atom->getObject(i)) || !grounded_atom->getObject(i).getType()->isCompatible(*action.getVariables()[variable_index]->getType()))
+			unsigned int variable_index = precondition.variable_indexes_[i];
+			if ((new_assigned_variables[variable_index] != NULL && new_assigned_variables[variable_index] != &grounded_atom->getObject(i)) || !grounded_atom->getObject(i).getType()->isCompatible(*action.getVariables()[variable_index]->getType()))
 			{
 				constraints_satisfied = false;
 				break;
@@ -1048,18 +1311,15 @@ void State::instantiateAndExecuteAction(NewStateReachedListener& listener, const
 		// Check if the equality constraints are also satisfied.
 		if (constraints_satisfied)
 		{
-			for (std::vector<const Equality*>::const_iterator ci = equalities.begin(); ci != equalities.end(); ci++)
+			for (std::vector<std::pair<std::pair<unsigned int, unsigned int>, bool> >::const_iterator ci = compiled_action.getEqualities().begin(); ci != compiled_action.getEqualities().end(); ci++)
 			{
-				const Equality* equality = *ci;
-				assert (std::find(action.getVariables().begin(), action.getVariables().end(), &equality->getLHSTerm()) != action.getVariables().end());
-				unsigned int lhs_term_index = std::distance(action.getVariables().begin(), std::find(action.getVariables().begin(), action.getVariables().end(), &equality->getLHSTerm()));
+				unsigned int lhs_term_index = (*ci).first.first;
+				unsigned int rhs_term_index = (*ci).first.second;
 				
-				assert (std::find(action.getVariables().begin(), action.getVariables().end(), &equality->getRHSTerm()) != action.getVariables().end());
-				unsigned int rhs_term_index = std::distance(action.getVariables().begin(), std::find(action.getVariables().begin(), action.getVariables().end(), &equality->getRHSTerm()));
-				
-				if (assigned_variables[lhs_term_index] != NULL && assigned_variables[rhs_term_index] != NULL && (assigned_variables[lhs_term_index] == assigned_variables[rhs_term_index]) == equality->isNegative())
+				if (new_assigned_variables[lhs_term_index] != NULL && new_assigned_variables[rhs_term_index] != NULL && (new_assigned_variables[lhs_term_index] == new_assigned_variables[rhs_term_index]) == (*ci).second)
 				{
 					constraints_satisfied = false;
+					break;
 				}
 			}
 		}
@@ -1082,16 +1342,19 @@ void State::instantiateAndExecuteAction(NewStateReachedListener& listener, const
 		std::cout << ")" << std::endl;
 #endif
 		
-		// Make sure a symmetrical precondition has not been used.
+		// Add it as a precondition and try to find atoms to satisfy the remainder of the preconditions.
+		if (!is_last_precondition)
+		{
+			instantiateAndExecuteAction(listener, symmetrical_groups, compiled_action, fact_index, uninitialised_precondition_index + 1, new_assigned_variables, prune_unhelpful_actions, helpful_actions);
+			continue;
+		}
+		
+		// Make sure a symmetrical precondition has not been used. All the facts match the same precondition so they share the
+		// same predicate.
 		bool is_symmetrical = false;
 		for (std::vector<const GroundedAtom*>::const_iterator ci = already_tried_facts.begin(); ci != already_tried_facts.end(); ++ci)
 		{
 			const GroundedAtom* fact = *ci;
-			if (fact->getPredicate().getArity() != grounded_atom->getPredicate().getArity() ||
-			    fact->getPredicate().getName() != grounded_atom->getPredicate().getName())
-			{
-				continue;
-			}
 			
 			bool terms_are_symmetrical = true;
 			for (unsigned int term_index = 0; term_index < fact->getPredicate().getArity(); ++term_index)
@@ -1134,175 +1397,96 @@ void State::instantiateAndExecuteAction(NewStateReachedListener& listener, const
 			continue;
 		}
 		
-		// Found an atom which satisfies all constraints, check if we now have a full assignment!
-		if (uninitialised_precondition_index + 1 == preconditions.size())
-		{
-			already_tried_facts.push_back(grounded_atom);
+		// Found an atom which satisfies all constraints, we now have a full assignment!
+		already_tried_facts.push_back(grounded_atom);
 #ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
-			std::cout << "Found a successor state!" << std::endl;
+		std::cout << "Found a successor state!" << std::endl;
 #endif
+		executeAction(listener, compiled_action, new_assigned_variables, prune_unhelpful_actions, helpful_actions);
+	}
+}
+
+void State::executeAction(NewStateReachedListener& listener, const CompiledAction& compiled_action, const Object** assigned_variables, bool prune_unhelpful_actions, const std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >& helpful_actions) const
+{
+	const Action& action = compiled_action.getAction();
+	
+	// Check if all the variables have been assigned. Those which are not assigned are free variables.
+	std::vector<const Object**> all_grounded_action_variables;
+	createAllGroundedVariables(all_grounded_action_variables, assigned_variables, compiled_action);
+	
+	for (std::vector<const Object**>::const_iterator ci = all_grounded_action_variables.begin(); ci != all_grounded_action_variables.end(); ci++)
+	{
+		const Object** grounded_action_variables = *ci;
 
-			const Object** grounded_action_variables_templates = new const Object*[action.getVariables().size()];
-			memcpy(grounded_action_variables_templates, new_assigned_variables, sizeof(const Object*) * action.getVariables().size());
+		// Check if this is a helpful action or not.
+		bool is_helpful = helpful_actions.empty();
+		for (std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >::const_iterator ci = helpful_actions.begin(); ci != helpful_actions.end(); ++ci)
+		{
+			const REACHABILITY::AchievingTransition* helpful_action = (*ci).first;
+			const std::vector<HEURISTICS::VariableDomain*>* variable_domains = (*ci).second;
 			
-			// Check if all the variables have been assigned. Those which are not assigned are free variables.
-			std::vector<const Object**> all_grounded_action_variables;
-			createAllGroundedVariables(all_grounded_action_variables, grounded_action_variables_templates, action, type_manager);
+			if (action.getPredicate() != helpful_action->getAchiever()->getTransition().getAction().getPredicate() ||
+			    action.getVariables().size() != variable_domains->size())
+			{
+				continue;
+			}
 			
-			delete[] grounded_action_variables_templates;
-/*
-#ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
-			std::cout << "(" << all_grounded_action_variables.size() << ") Helpful actions: " << std::endl;
-			for (std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>*> >::const_iterator ci = helpful_actions.begin(); ci != helpful_actions.end(); ++ci)
+			bool all_variable_domains_match = true;
+			for (unsigned int i = 0; i < action.getVariables().size(); ++i)
 			{
-				const REACHABILITY::AchievingTransition* action = (*ci).first;
-				const std::vector<HEURISTICS::VariableDomain*>* variable = (*ci).second;
-				
-				std::cout << *action << std::endl;
-				
-				for (std::vector<HEURISTICS::VariableDomain*>::const_iterator ci = variable->begin(); ci != variable->end(); ++ci)
+				const HEURISTICS::VariableDomain& helpful_variable_domain = (*variable_domains)[i]->getVariableDomain();
+				if (!helpful_variable_domain.contains(*grounded_action_variables[i]))
 				{
-					std::cout << **ci << std::endl;
+					all_variable_domains_match = false;
+					break;
 				}
 			}
-#endif
-*/
-			for (std::vector<const Object**>::const_iterator ci = all_grounded_action_variables.begin(); ci != all_grounded_action_variables.end(); ci++)
+			if (all_variable_domains_match)
 			{
-				const Object** grounded_action_variables = *ci;
-
-				// Check if this is a helpful action or not.
-				bool is_helpful = helpful_actions.empty();
-				//for (std::vector<const REACHABILITY::AchievingTransition*>::const_iterator ci = helpful_actions_.begin(); ci != helpful_actions_.end(); ++ci)
-				for (std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >::const_iterator ci = helpful_actions.begin(); ci != helpful_actions.end(); ++ci)
-				{
-					const REACHABILITY::AchievingTransition* helpful_action = (*ci).first;
-					const std::vector<HEURISTICS::VariableDomain*>* variable_domains = (*ci).second;
-					//const REACHABILITY::AchievingTransition* helpful_action = *ci;
-//					std::cout << "Helpful action: " << *helpful_action << std::endl;
-					
-					if (action.getPredicate() != helpful_action->getAchiever()->getTransition().getAction().getPredicate() ||
-					    action.getVariables().size() != variable_domains->size())
-					{
-						continue;
-					}
-					
-					bool all_variable_domains_match = true;
-					for (unsigned int i = 0; i < action.getVariables().size(); ++i)
-					{
-						//std::vector<const Object*>* helpful_variable_domain = variable_domains[i];
-						//const HEURISTICS::VariableDomain& helpful_variable_domain = helpful_action->getVariableAssignments()[i]->getVariableDomain();
-						const HEURISTICS::VariableDomain& helpful_variable_domain = (*variable_domains)[i]->getVariableDomain();
-						if (!helpful_variable_domain.contains(*grounded_action_variables[i]))
-						{
-							all_variable_domains_match = false;
-							break;
-						}
-					}
-					if (all_variable_domains_match)
-					{
-						is_helpful = true;
-						break;
-					}
-				}
+				is_helpful = true;
+				break;
+			}
+		}
 
-//				const GroundedAction& dummy_grounded_action = GroundedAction::getGroundedAction(action, grounded_action_variables);
-				if (prune_unhelpful_actions && !is_helpful)
-				{
+		if (prune_unhelpful_actions && !is_helpful)
+		{
 #ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
-					std::cout << "\tUnhelpful action." << std::endl;
-					//std::cout << "Unhelpful: " << dummy_grounded_action << std::endl;
+			std::cout << "\tUnhelpful action." << std::endl;
 #endif
-					continue;
-				}
-				//std::cout << "Helpful: " << dummy_grounded_action << std::endl;
+			continue;
+		}
 
-				const GroundedAction& grounded_action = GroundedAction::getGroundedAction(action, grounded_action_variables);
-				
-				// Apply the action to the new state!
-				State* new_state = new State(*this, grounded_action, is_helpful);
-#ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
-				std::cout << "Successor state: " << *new_state << std::endl;
-#endif
-				/*
-				// Check if this state is symmetrical to any state we are already considering.
-				
+		const GroundedAction& grounded_action = GroundedAction::getGroundedAction(action, grounded_action_variables);
+		
+		// Apply the action to the new state!
+		State* new_state = new State(*this, grounded_action, is_helpful);
 #ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
-//				std::cout << "Copy the old state: " << *new_state << std::endl;
+		std::cout << "Successor state: " << *new_state << std::endl;
 #endif
-
-				std::vector<const GroundedAtom*> to_add;
-				for (std::vector<const Atom*>::const_iterator ci = action.getEffects().begin(); ci != action.getEffects().end(); ci++)
-				{
-					const Atom* effect = *ci;
-					const Object** effect_variables = new const Object*[effect->getArity()];
-					
-					for (unsigned int i = 0; i < effect->getArity(); i++)
-					{
-						assert (std::find(action.getVariables().begin(), action.getVariables().end(), effect->getTerms()[i]) != action.getVariables().end());
-						unsigned int variable_index = std::distance(action.getVariables().begin(), std::find(action.getVariables().begin(), action.getVariables().end(), effect->getTerms()[i]));
-
-						assert (grounded_action_variables[variable_index] != NULL);
-						effect_variables[i] = grounded_action_variables[variable_index];
-					}
-					
-					const GroundedAtom& grounded_effect = GroundedAtom::getGroundedAtom(effect->getPredicate(), effect_variables);
-					if (effect->isNegative())
-					{
-#ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
-//						std::cout << "Remove: " << *grounded_effect << std::endl;
-#endif
-						new_state->removeFact(grounded_effect);
-					}
-					else
-					{
-						to_add.push_back(&grounded_effect);
-					}
-				}
-				
-				for (std::vector<const GroundedAtom*>::const_iterator ci = to_add.begin(); ci != to_add.end(); ci++)
-				{
-#ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
-//					std::cout << "Add: " << *grounded_effect << std::endl;
-#endif
-					new_state->addFact(**ci, true);
-				}
-							
-#ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
-//				std::cout << "Successor state: " << *new_state << std::endl;
-#endif
-				*/
-				listener.addNewState(*new_state);
-				//successor_states.push_back(new_state);
-				if (!listener.continueSearching())
-				{
-					break;
-				}
-			}
-			
-			for (std::vector<const Object**>::const_iterator ci = all_grounded_action_variables.begin(); ci != all_grounded_action_variables.end(); ci++)
-			{
-				const Object** grounded_action_variables = *ci;
-				delete[] grounded_action_variables;
-			}
-		}
-		// Add it as a precondition and try to find atoms to satisfy the remainder of the preconditions.
-		else
+		listener.addNewState(*new_state);
+		if (!listener.continueSearching())
 		{
-			instantiateAndExecuteAction(listener, symmetrical_groups, action, preconditions, equalities, uninitialised_precondition_index + 1, new_assigned_variables, type_manager, prune_unhelpful_actions, initial_facts, helpful_actions);
+			break;
 		}
 	}
+	
+	for (std::vector<const Object**>::const_iterator ci = all_grounded_action_variables.begin(); ci != all_grounded_action_variables.end(); ci++)
+	{
+		const Object** grounded_action_variables = *ci;
+		delete[] grounded_action_variables;
+	}
 }
 
-void State::createAllGroundedVariables(std::vector<const Object**>& all_grounded_action_variables, const Object** grounded_action_variables, const Action& action, const TypeManager& type_manager) const
+void State::createAllGroundedVariables(std::vector<const Object**>& all_grounded_action_variables, const Object** grounded_action_variables, const CompiledAction& compiled_action) const
 {
+	const Action& action = compiled_action.getAction();
 	unsigned int counters[action.getVariables().size()];
 	memset(counters, 0, sizeof(unsigned int) * action.getVariables().size());
 	
-	std::vector<const Object*> object_sets[action.getVariables().size()];
+	// If a free variable cannot be assigned any object there are no grounded actions.
 	for (unsigned int i = 0; i < action.getVariables().size(); i++)
 	{
-		type_manager.getObjectsOfType(object_sets[i], *action.getVariables()[i]->getType());
+		if (grounded_action_variables[i] == NULL && compiled_action.getObjects(i).empty()) return;
 	}
 	
 	while (true)
@@ -1313,12 +1497,7 @@ void State::createAllGroundedVariables(std::vector<const Object**>& all_grounded
 		for (unsigned int i = 0; i < action.getVariables().size(); i++)
 		{
 			if (grounded_action_variables[i] != NULL) continue;
-			new_grounded_action_variables[i] = object_sets[i][counters[i]];
-		}
-		
-		for (unsigned int i = 0; i < action.getVariables().size(); i++)
-		{
-			assert (new_grounded_action_variables[i] != NULL);
+			new_grounded_action_variables[i] = compiled_action.getObjects(i)[counters[i]];
 		}
 		
 		all_grounded_action_variables.push_back(new_grounded_action_variables);
@@ -1328,7 +1507,7 @@ void State::createAllGroundedVariables(std::vector<const Object**>& all_grounded
 		{
 			if (grounded_action_variables[i] != NULL) continue;
 			
-			if (counters[i] + 1 != object_sets[i].size())
+			if (counters[i] + 1 != compiled_action.getObjects(i).size())
 			{
 				counters[i] = counters[i] + 1;
 				counter_updated = true;
@@ -1362,24 +1541,12 @@ void State::deleteHelpfulActions()
 }
 */
 
-bool State::isEqualTo(const State& other, const std::vector<const GroundedAtom*>& initial_facts) const
+bool State::isEqualTo(const State& other) const
 {
-	std::vector<const GroundedAtom*> state_facts, other_state_facts;
-	getFacts(initial_facts, state_facts);
-	other.getFacts(initial_facts, other_state_facts);
-	
-	if (state_facts.size() != other_state_facts.size()) return false;
-	
-	for (unsigned int i = 0; i < other_state_facts.size(); ++i)
-	{
-		if (other_state_facts[i] != state_facts[i])
-		{
-			return false;
-		}
-	}
-	return true;
+	return signature_ == other.signature_ && facts_ == other.facts_;
 }
 
+
 bool State::operator==(const State& state) const
 {
 	assert (false);
@@ -1435,43 +1602,305 @@ std::ostream& operator<<(std::ostream& os, const State& state)
 	return os;
 }
 
-bool CompareStates::operator()(const State* lhs, const State* rhs)
+OpenList::~OpenList()
+{
+	
+}
+
+BucketOpenList::BucketOpenList(unsigned int g_weight, unsigned int h_weight, TIE_BREAKING tie_breaking, boost::mt19937& random_generator)
+	: g_weight_(g_weight), h_weight_(h_weight), tie_breaking_(tie_breaking), random_generator_(&random_generator), lowest_bucket_(0), size_(0), memory_usage_(0)
+{
+	
+}
+
+BucketOpenList::~BucketOpenList()
 {
-/*	if (!lhs->isCreatedByHelpfulAction() && rhs->isCreatedByHelpfulAction())
+	clear();
+}
+
+void BucketOpenList::push(State& state)
+{
+	++size_;
+	memory_usage_ += state.getMemoryUsage();
+	if (state.getHeuristic() == std::numeric_limits<unsigned int>::max())
 	{
-		return true;
+		dead_ends_.push_back(&state);
+		return;
 	}
-	else if (lhs->isCreatedByHelpfulAction() && !rhs->isCreatedByHelpfulAction())
+	
+	unsigned int priority = g_weight_ * state.getDistanceFromStart() + h_weight_ * state.getHeuristic();
+	if (priority >= buckets_.size())
 	{
-		return false;
+		buckets_.resize(priority + 1);
 	}
-	else*/
+	buckets_[priority].push_back(&state);
+	lowest_bucket_ = std::min(lowest_bucket_, priority);
+}
+
+State* BucketOpenList::pop()
+{
+	if (size_ == 0)
+	{
+		return NULL;
+	}
+	--size_;
+	
+	while (lowest_bucket_ < buckets_.size() && buckets_[lowest_bucket_].empty())
+	{
+		++lowest_bucket_;
+	}
+	
+	State* state = NULL;
+	if (lowest_bucket_ == buckets_.size())
+	{
+		state = pop(dead_ends_);
+	}
+	else
+	{
+		state = pop(buckets_[lowest_bucket_]);
+	}
+	memory_usage_ -= state->getMemoryUsage();
+	return state;
+}
+
+State* BucketOpenList::pop(std::deque<State*>& bucket)
+{
+	State* state = NULL;
+	switch (tie_breaking_)
+	{
+		case TIE_BREAKING_FIFO:
+			state = bucket.front();
+			bucket.pop_front();
+			break;
+		case TIE_BREAKING_LIFO:
+			state = bucket.back();
+			bucket.pop_back();
+			break;
+		case TIE_BREAKING_RANDOM:
+		{
+			std::deque<State*>::iterator random_state = bucket.begin() + (*random_generator_)() % bucket.size();
+			state = *random_state;
+			*random_state = bucket.back();
+			bucket.pop_back();
+			break;
+		}
+	}
+	return state;
+}
+
+void BucketOpenList::clear()
+{
+	for (std::vector<std::deque<State*> >::iterator i = buckets_.begin(); i != buckets_.end(); ++i)
+	{
+		for (std::deque<State*>::const_iterator ci = (*i).begin(); ci != (*i).end(); ++ci)
+		{
+			delete *ci;
+		}
+		(*i).clear();
+	}
+	for (std::deque<State*>::const_iterator ci = dead_ends_.begin(); ci != dead_ends_.end(); ++ci)
+	{
+		delete *ci;
+	}
+	dead_ends_.clear();
+	lowest_bucket_ = 0;
+	size_ = 0;
+	memory_usage_ = 0;
+}
+
+std::size_t BucketOpenList::prune(std::size_t memory_to_free)
+{
+	std::size_t memory_freed = 0;
+	// The best state is never pruned, so the search can always continue.
+	while (memory_freed < memory_to_free && size_ > 1 && !dead_ends_.empty())
+	{
+		memory_freed += dead_ends_.back()->getMemoryUsage();
+		delete dead_ends_.back();
+		dead_ends_.pop_back();
+		--size_;
+	}
+	
+	// Within a bucket the states which would be popped last are pruned first.
+	for (std::vector<std::deque<State*> >::reverse_iterator ri = buckets_.rbegin(); ri != buckets_.rend() && memory_freed < memory_to_free; ++ri)
+	{
+		std::deque<State*>& bucket = *ri;
+		while (memory_freed < memory_to_free && size_ > 1 && !bucket.empty())
+		{
+			State* state = NULL;
+			if (tie_breaking_ == TIE_BREAKING_LIFO)
+			{
+				state = bucket.front();
+				bucket.pop_front();
+			}
+			else
+			{
+				state = bucket.back();
+				bucket.pop_back();
+			}
+			memory_freed += state->getMemoryUsage();
+			delete state;
+			--size_;
+		}
+	}
+	memory_usage_ -= memory_freed;
+	return memory_freed;
+}
+
+void BucketOpenList::getStates(std::vector<const State*>& states) const
+{
+	for (std::vector<std::deque<State*> >::const_iterator ci = buckets_.begin(); ci != buckets_.end(); ++ci)
+	{
+		states.insert(states.end(), (*ci).begin(), (*ci).end());
+	}
+	states.insert(states.end(), dead_ends_.begin(), dead_ends_.end());
+}
+
+AlternatingOpenList::AlternatingOpenList(OpenList& helpful_states, OpenList& other_states)
+	: helpful_states_(&helpful_states), other_states_(&other_states), pop_helpful_state_(true)
+{
+	
+}
+
+AlternatingOpenList::~AlternatingOpenList()
+{
+	delete helpful_states_;
+	delete other_states_;
+}
+
+void AlternatingOpenList::push(State& state)
+{
+	if (state.isCreatedByHelpfulAction())
+	{
+		helpful_states_->push(state);
+	}
+	else
+	{
+		other_states_->push(state);
+	}
+}
+
+State* AlternatingOpenList::pop()
+{
+	OpenList* open_list = pop_helpful_state_ ? helpful_states_ : other_states_;
+	if (open_list->empty())
+	{
+		open_list = pop_helpful_state_ ? other_states_ : helpful_states_;
+	}
+	pop_helpful_state_ = !pop_helpful_state_;
+	return open_list->pop();
+}
+
+void AlternatingOpenList::clear()
+{
+	helpful_states_->clear();
+	other_states_->clear();
+}
+
+std::size_t AlternatingOpenList::prune(std::size_t memory_to_free)
+{
+	std::size_t memory_freed = other_states_->prune(memory_to_free);
+	if (memory_freed < memory_to_free)
+	{
+		memory_freed += helpful_states_->prune(memory_to_free - memory_freed);
+	}
+	return memory_freed;
+}
+
+void AlternatingOpenList::getStates(std::vector<const State*>& states) const
+{
+	helpful_states_->getStates(states);
+	other_states_->getStates(states);
+}
+
+SearchStrategy::SearchStrategy()
+	: g_weight_(0), h_weight_(1), tie_breaking_(TIE_BREAKING_RANDOM), alternate_helpful_states_(false)
+{
+	
+}
+
+OpenList* SearchStrategy::createOpenList(boost::mt19937& random_generator) const
+{
+	if (alternate_helpful_states_)
+	{
+		return new AlternatingOpenList(*new BucketOpenList(g_weight_, h_weight_, tie_breaking_, random_generator), *new BucketOpenList(g_weight_, h_weight_, tie_breaking_, random_generator));
+	}
+	return new BucketOpenList(g_weight_, h_weight_, tie_breaking_, random_generator);
+}
+
+ClosedList::ClosedList()
+	: compact_(false)
+{
+	
+}
 
-	if (lhs->getHeuristic() == rhs->getHeuristic())
+bool ClosedList::contains(const State& state) const
+{
+	if (signatures_.find(state.getSignature()) != signatures_.end())
 	{
-		//return lhs->getAchievers().size() > rhs->getAchievers().size();
 		return true;
 	}
+	
+	std::pair<boost::unordered_multimap<std::size_t, const State*>::const_iterator, boost::unordered_multimap<std::size_t, const State*>::const_iterator> candidates = states_.equal_range(state.getSignature());
+	for (boost::unordered_multimap<std::size_t, const State*>::const_iterator ci = candidates.first; ci != candidates.second; ++ci)
+	{
+		if (state.isEqualTo(*(*ci).second))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void ClosedList::add(const State& state)
+{
+	if (compact_)
+	{
+		signatures_.insert(state.getSignature());
+	}
 	else
 	{
-		return lhs->getHeuristic() > rhs->getHeuristic();
+		states_.insert(std::make_pair(state.getSignature(), &state));
+	}
+}
+
+void ClosedList::clear()
+{
+	states_.clear();
+	signatures_.clear();
+	compact_ = false;
+}
+
+void ClosedList::compact()
+{
+	for (boost::unordered_multimap<std::size_t, const State*>::const_iterator ci = states_.begin(); ci != states_.end(); ++ci)
+	{
+		signatures_.insert((*ci).first);
 	}
+	states_.clear();
+	compact_ = true;
 }
 
+volatile sig_atomic_t ForwardChainingPlanner::stop_requested_ = 0;
+
 ForwardChainingPlanner::ForwardChainingPlanner(const ActionManager& action_manager, PredicateManager& predicate_manager, const TypeManager& type_manager, HEURISTICS::HeuristicInterface& heuristic)
-	: action_manager_(&action_manager), predicate_manager_(&predicate_manager), type_manager_(&type_manager), heuristic_(&heuristic)
+	: action_manager_(&action_manager), predicate_manager_(&predicate_manager), type_manager_(&type_manager), heuristic_(&heuristic), random_generator_(std::time(NULL)), search_trace_(NULL), memory_budget_(0)
 {
-	
+	for (std::vector<Action*>::const_iterator ci = action_manager.getManagableObjects().begin(); ci != action_manager.getManagableObjects().end(); ci++)
+	{
+		compiled_actions_.push_back(new CompiledAction(**ci, type_manager));
+	}
 }
 
 ForwardChainingPlanner::~ForwardChainingPlanner()
 {
-	
+	for (std::vector<const CompiledAction*>::const_iterator ci = compiled_actions_.begin(); ci != compiled_actions_.end(); ci++)
+	{
+		delete *ci;
+	}
 }
 
 std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedAction*>& plan, const std::vector<const Atom*>& initial_facts, const std::vector<const Atom*>& goal_facts, const TermManager& term_manager, bool prune_unhelpful_actions, bool allow_restarts, bool allow_new_goals_to_be_added)
 {
-	std::srand(std::time(NULL));
 	unsigned int states_seen_without_improvement = 0;
 	std::vector<const GroundedAtom*> grounded_initial_facts;
 	for (std::vector<const Atom*>::const_iterator ci = initial_facts.begin(); ci != initial_facts.end(); ci++)
@@ -1501,28 +1930,37 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 		grounded_goal_facts.push_back(&GroundedAtom::getGroundedAtom(goal_fact->getPredicate(), variables));
 	}
 	
-	// All the grounded atoms that should never be removed.
-	std::vector<const GroundedAtom*> grounded_atoms_not_to_be_removed;
-	grounded_atoms_not_to_be_removed.insert(grounded_atoms_not_to_be_removed.end(), grounded_initial_facts.begin(), grounded_initial_facts.end());
-	grounded_atoms_not_to_be_removed.insert(grounded_atoms_not_to_be_removed.end(), grounded_goal_facts.begin(), grounded_goal_facts.end());
-	
-	std::vector<const State*> processed_states;
-	//State* initial_state = new State(grounded_initial_facts, true);
-	State* initial_state = new State(true);
+	// The states refer to the grounded atoms by their ids, so the grounded atoms are not removed during the search.
+	std::vector<State*> processed_states;
+	// The number of states at the front of processed_states whose facts have been released by enforceMemoryBudget.
+	std::size_t released_states = 0;
+	// The actions which lead to the state the search last restarted from, the states on that path are deleted at the restart.
+	std::vector<const GroundedAction*> plan_prefix;
+	ClosedList closed_list;
+	State* initial_state = new State(grounded_initial_facts, true);
 	
 	// Test.
 	//std::map<const Object*, std::vector<const Object*>*> symmetrical_object_mappings;
 	//initial_state->getSymmetricalObjects(symmetrical_object_mappings, grounded_goal_facts, eog_manager);
 	
 	
+	// Do not start the search if the goals cannot be reached at all.
+	if (heuristic_->isDeadEnd(*initial_state, grounded_goal_facts))
+	{
+		std::cerr << "The goals cannot be reached from the initial state." << std::endl;
+		delete initial_state;
+		return std::make_pair(-1, -1);
+	}
+	
 	heuristic_->setHeuristicForState(*initial_state, grounded_initial_facts, grounded_goal_facts, term_manager, true, allow_new_goals_to_be_added);
-	GroundedAtom::removeInstantiatedGroundedAtom(grounded_atoms_not_to_be_removed);
 	
-	std::priority_queue<State*, std::vector<State*>, CompareStates> queue;
-	queue.push(initial_state);
+	OpenList* open_list = search_strategy_.createOpenList(random_generator_);
+	open_list->push(*initial_state);
 	
 	unsigned int states_visited = 0;
 	unsigned int successors_generated = 0;
+	// The number of states visited when the memory budget was last checked.
+	unsigned int states_visited_at_memory_check = 0;
 	
 	unsigned int best_heuristic_estimate = std::numeric_limits<unsigned int>::max();
 	
@@ -1532,35 +1970,28 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 	unsigned int max_power = 12;
 	unsigned int current_power = min_power;
 	
-	std::vector<State*> current_states_to_explore;
-	unsigned int current_best_value_in_list = initial_state->getHeuristic();
-	
-	while (!queue.empty() || !current_states_to_explore.empty())
+	while (!open_list->empty())
 	{
-		// Create a list of states which have the same heuristic value.
-		if (current_states_to_explore.empty() || queue.top()->getHeuristic() == current_best_value_in_list)
+		if (stop_requested_)
 		{
-			current_best_value_in_list = queue.top()->getHeuristic();
-			
-			while (!queue.empty() && queue.top()->getHeuristic() == current_best_value_in_list)
-			{
-				State* state = queue.top();
-				queue.pop();
-				current_states_to_explore.push_back(state);
-			}
+			std::cerr << "Search stopped." << std::endl;
+			break;
 		}
 		
-		// From all the elements in the list, pick one at random to explore.
-		unsigned int random_state_index = std::rand() % current_states_to_explore.size();
+		// Only check once per interval, states which are popped but not expanded do not advance states_visited.
+		if (memory_budget_ != 0 && states_visited - states_visited_at_memory_check >= MEMORY_CHECK_INTERVAL)
+		{
+			states_visited_at_memory_check = states_visited;
+			enforceMemoryBudget(*open_list, closed_list, processed_states, released_states, plan_prefix, *last_best_state_seen, grounded_initial_facts, grounded_goal_facts);
+		}
 		
-		State* state = current_states_to_explore[random_state_index];
-		current_states_to_explore.erase(current_states_to_explore.begin() + random_state_index);
+		State* state = open_list->pop();
 		
 #ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
 		std::cout << "Current state: " << *state << std::endl;
 		
 		std::vector<const GroundedAtom*> grounded_atom;
-		state->getFacts(grounded_initial_facts, grounded_atom);
+		state->getFacts(grounded_atom);
 		
 		for (std::vector<const GroundedAtom*>::const_iterator ci = grounded_atom.begin(); ci != grounded_atom.end(); ci++)
 		{
@@ -1569,27 +2000,12 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 		}
 #endif
 		
-//		State* state = queue.top();
-//		queue.pop();
-		
-		bool already_processed = false;
-		for (std::vector<const State*>::const_iterator ci = processed_states.begin(); ci != processed_states.end(); ci++)
-		{
-			//if (*state == **ci)
-			if (state->isEqualTo(**ci, grounded_initial_facts))
-			{
-				already_processed = true;
-				break;
-			}
-#ifdef FC_PLANNER_SAFE_MEMORY
-			GroundedAtom::removeInstantiatedGroundedAtom(grounded_atoms_not_to_be_removed);
-#endif
-		}
+		bool already_processed = closed_list.contains(*state);
 		
 		if (already_processed)
 		{
 #ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
-			std::cout << "Already processed!?" << queue.size() << std::endl;
+			std::cout << "Already processed!?" << open_list->size() << std::endl;
 			std::cout << *state << std::endl;
 #endif
 			delete state;
@@ -1603,7 +2019,7 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 			std::cerr << *state << std::endl;
 			
 			std::vector<const GroundedAtom*> grounded_atom;
-			state->getFacts(grounded_initial_facts, grounded_atom);
+			state->getFacts(grounded_atom);
 			
 			for (std::vector<const GroundedAtom*>::const_iterator ci = grounded_atom.begin(); ci != grounded_atom.end(); ci++)
 			{
@@ -1674,34 +2090,40 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 		else if (allow_restarts && states_seen_without_improvement > std::pow(base, current_power))
 		{
 			std::cerr << "\tRestart!" << states_seen_without_improvement << "/" << std::pow(base, current_power) << std::endl;
-			while (!queue.empty())
+			open_list->clear();
+			
+			// Only the actions on the path to the best state are still needed, so all the other processed states are deleted.
+			std::vector<const GroundedAction*> path_to_best_state;
+			for (const State* parent = last_best_state_seen->getParent(); parent != NULL; parent = parent->getParent())
 			{
-				const State* dead_state = queue.top();
-				queue.pop();
-				delete dead_state;
+				if (parent->getAchievingAction() != NULL)
+				{
+					path_to_best_state.push_back(parent->getAchievingAction());
+				}
 			}
+			plan_prefix.insert(plan_prefix.end(), path_to_best_state.rbegin(), path_to_best_state.rend());
+			last_best_state_seen->detachFromParent();
 			
-			for (std::vector<const State*>::const_iterator ci = processed_states.begin(); ci != processed_states.end(); ci++)
+			for (std::vector<State*>::const_iterator ci = processed_states.begin(); ci != processed_states.end(); ci++)
 			{
 				if (*ci != last_best_state_seen)
 				{
-					//delete *ci;
+					delete *ci;
 				}
 			}
 			processed_states.clear();
-			
-			for (std::vector<State*>::const_iterator ci = current_states_to_explore.begin(); ci != current_states_to_explore.end(); ++ci)
-			{
-				delete *ci;
-			}
-			current_states_to_explore.clear();
+			released_states = 0;
+			closed_list.clear();
 			
 			// Delete all grounded actions which are not stored in the states.
 			//GroundedAction::removeInstantiatedGroundedActions(last_best_state_seen->getAchievers().begin(), last_best_state_seen->getAchievers().end());
 //			GroundedAction::removeInstantiatedGroundedActions(*last_best_state_seen);
-//			delete state;
+			delete state;
 			state = last_best_state_seen;
-			current_best_value_in_list = state->getHeuristic();
+			if (search_trace_ != NULL)
+			{
+				search_trace_->addEvent(SearchTrace::RESTART, *state);
+			}
 			states_seen_without_improvement = 0;
 			
 			// If we could not find a solution in a reasonable amount of steps then we stop the search!
@@ -1709,6 +2131,7 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 			{
 				std::cerr << "Too many restarts, abort!" << std::endl;
 				processed_states.push_back(state);
+				closed_list.add(*state);
 				break;
 			}
 			
@@ -1717,8 +2140,13 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 		++states_seen_without_improvement;
 		++states_visited;
 		processed_states.push_back(state);
+		closed_list.add(*state);
+		if (search_trace_ != NULL)
+		{
+			search_trace_->addEvent(SearchTrace::EXPAND, *state);
+		}
 		
-		if (states_visited % 1000 == 0) std::cerr << "M" << "s=" << processed_states.size() << ";g=" << GroundedAction::numberOfGroundedActions() << "q=" << queue.size();
+		if (states_visited % 1000 == 0) std::cerr << "M" << "s=" << processed_states.size() << ";g=" << GroundedAction::numberOfGroundedActions() << "q=" << open_list->size();
 		else if (states_visited % 100 == 0) std::cerr << ".";
 		//else std::cerr << "@";
 		
@@ -1727,8 +2155,12 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 		std::cout << *state << std::endl;
 #endif
 		
-		if (state->isSuperSetOf(grounded_initial_facts, grounded_goal_facts))
+		if (state->isSuperSetOf(grounded_goal_facts))
 		{
+			if (search_trace_ != NULL)
+			{
+				search_trace_->addEvent(SearchTrace::GOAL, *state);
+			}
 #ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
 			std::cout << "Found a goal state:" << std::endl;
 			std::cout << *state << std::endl;
@@ -1744,46 +2176,26 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 				plan.insert(plan.begin(), parent->getAchievingAction());
 				parent = parent->getParent();
 			}
+			plan.insert(plan.begin(), plan_prefix.begin(), plan_prefix.end());
 			
-			while (!queue.empty())
-			{
-				const State* state = queue.top();
-				queue.pop();
-				delete state;
-			}
-			
-			for (std::vector<const State*>::const_iterator ci = processed_states.begin(); ci != processed_states.end(); ci++)
-			{
-				delete *ci;
-			}
+			delete open_list;
 			
-			for (std::vector<State*>::const_iterator ci = current_states_to_explore.begin(); ci != current_states_to_explore.end(); ++ci)
+			for (std::vector<State*>::const_iterator ci = processed_states.begin(); ci != processed_states.end(); ci++)
 			{
 				delete *ci;
 			}
-			current_states_to_explore.clear();
 			return std::make_pair(states_visited, plan.size());
 		}
 		
 		std::vector<State*> successor_states;
 		
-		NewStateReachedListener* new_state_reached_listener = NULL;
-		//if (prune_unhelpful_actions)
-		{
-			new_state_reached_listener = new StateHeuristicListener(successor_states, *state,  *heuristic_, grounded_initial_facts, grounded_goal_facts, term_manager, prune_unhelpful_actions, allow_new_goals_to_be_added);
-		}
-		//else
-		//{
-		//	new_state_reached_listener = new StateStoreListener(successor_states);
-		//}
+		// The successors are evaluated as a batch once they have all been generated, so they can be scored in parallel.
+		NewStateReachedListener* new_state_reached_listener = new StateStoreListener(successor_states);
 		
-		// Before finding the successors, search for helpful actions (if this option is enabled).
-		if (prune_unhelpful_actions)
+		// Before finding the successors, search for helpful actions (if they are used to prune or order the successors).
+		if (prune_unhelpful_actions || open_list->usesHelpfulActions())
 		{
 			heuristic_->setHeuristicForState(*state, grounded_initial_facts, grounded_goal_facts, term_manager, true, allow_new_goals_to_be_added);
-#ifdef FC_PLANNER_SAFE_MEMORY
-			GroundedAtom::removeInstantiatedGroundedAtom(grounded_atoms_not_to_be_removed);
-#endif
 		}
 		else
 		{
@@ -1792,31 +2204,10 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 		
 		std::multimap<const Object*, const Object*> symmetrical_groups;
 		heuristic_->getFunctionalSymmetricSets(symmetrical_groups, *state, grounded_initial_facts, grounded_goal_facts, term_manager);
-		GroundedAtom::removeInstantiatedGroundedAtom(grounded_atoms_not_to_be_removed);
 	
-		std::vector<const State*> all_states;
-		all_states.insert(all_states.end(), current_states_to_explore.begin(), current_states_to_explore.end());
-		
-		//std::priority_queue<State*, std::vector<State*>, CompareStates> queue;
-		
-		State* const* first_state = &queue.top();
-		for (unsigned int i = 0; i < queue.size(); ++i)
-		{
-			const State* state = first_state[i];
-			all_states.push_back(state);
-		}
-		/*
-		for (std::vector<const State*>::const_iterator ci = all_states.begin(); ci != all_states.end(); ++ci)
-		{
-			std::cout << **ci << std::endl;
-		}
-		*/
-		
-		state->getSuccessors(*new_state_reached_listener, symmetrical_groups, *action_manager_, *type_manager_, prune_unhelpful_actions, grounded_initial_facts, heuristic_->getHelpfulActions());
-#ifdef FC_PLANNER_SAFE_MEMORY
-		GroundedAtom::removeInstantiatedGroundedAtom(grounded_atoms_not_to_be_removed);
-#endif
+		state->getSuccessors(*new_state_reached_listener, symmetrical_groups, compiled_actions_, prune_unhelpful_actions, heuristic_->getHelpfulActions());
 		delete new_state_reached_listener;
+		heuristic_->setHeuristicForStates(successor_states, grounded_initial_facts, grounded_goal_facts, term_manager, allow_new_goals_to_be_added);
 		
 		
 		//TODO: REMOVE.
@@ -1873,7 +2264,7 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 			std::cout << *successor_state << std::endl;
 			
 			std::vector<const GroundedAtom*> grounded_atom;
-			successor_state->getFacts(grounded_initial_facts, grounded_atom);
+			successor_state->getFacts(grounded_atom);
 			
 			for (std::vector<const GroundedAtom*>::const_iterator ci = grounded_atom.begin(); ci != grounded_atom.end(); ci++)
 			{
@@ -1888,7 +2279,7 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 //				std::cout << **ci << std::endl;
 //			}
 //#endif
-			queue.push(successor_state);
+			open_list->push(*successor_state);
 /*
 			if (prune_unhelpful_actions && successor_state->getHeuristic() < state->getHeuristic())
 			{
@@ -1905,28 +2296,108 @@ std::pair<int, int> ForwardChainingPlanner::findPlan(std::vector<const GroundedA
 		//state->deleteHelpfulActions();
 	}
 	
-	while (!queue.empty())
-	{
-		const State* state = queue.top();
-		queue.pop();
-		delete state;
-	}
+	delete open_list;
 	
-	for (std::vector<const State*>::const_iterator ci = processed_states.begin(); ci != processed_states.end(); ci++)
+	for (std::vector<State*>::const_iterator ci = processed_states.begin(); ci != processed_states.end(); ci++)
 	{
 		delete *ci;
 	}
 	processed_states.clear();
 	
-	for (std::vector<State*>::const_iterator ci = current_states_to_explore.begin(); ci != current_states_to_explore.end(); ++ci)
+	std::cerr << "No plan found :((((((((((" << std::endl;
+	
+	return std::make_pair(-1, -1);
+}
+
+void ForwardChainingPlanner::enforceMemoryBudget(OpenList& open_list, ClosedList& closed_list, const std::vector<State*>& processed_states, std::size_t& released_states, const std::vector<const GroundedAction*>& plan_prefix, const State& last_best_state_seen, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts) const
+{
+	std::size_t processed_states_memory_usage = 0;
+	for (std::vector<State*>::const_iterator ci = processed_states.begin(); ci != processed_states.end(); ++ci)
+	{
+		processed_states_memory_usage += (*ci)->getMemoryUsage();
+	}
+	processed_states_memory_usage += plan_prefix.capacity() * sizeof(const GroundedAction*);
+	std::size_t grounded_memory_usage = GroundedAtom::getMemoryUsage() + GroundedAction::getMemoryUsage();
+	
+	std::size_t memory_usage = processed_states_memory_usage + open_list.getMemoryUsage() + grounded_memory_usage;
+	if (memory_usage <= memory_budget_)
 	{
-		delete *ci;
+		return;
 	}
-	current_states_to_explore.clear();
+	std::cerr << "\tMemory budget exceeded: " << memory_usage << " / " << memory_budget_ << " bytes";
 	
-	std::cerr << "No plan found :((((((((((" << std::endl;
+	// 1. The expanded states only need to be recognised, not expanded again.
+	if (released_states < processed_states.size())
+	{
+		if (!closed_list.isCompact())
+		{
+			closed_list.compact();
+		}
+		for (std::vector<State*>::const_iterator ci = processed_states.begin() + released_states; ci != processed_states.end(); ++ci)
+		{
+			State* state = *ci;
+			if (state != &last_best_state_seen)
+			{
+				memory_usage -= state->getMemoryUsage();
+				state->releaseFacts();
+				memory_usage += state->getMemoryUsage();
+			}
+		}
+		released_states = processed_states.size();
+		std::cerr << "; compacted the closed list: " << memory_usage;
+	}
 	
-	return std::make_pair(-1, -1);
+	// 2. Free some extra memory, so we do not have to prune again after the next few expansions.
+	if (memory_usage > memory_budget_)
+	{
+		std::size_t memory_to_free = memory_usage - memory_budget_ + memory_budget_ / 4;
+		std::size_t open_states = open_list.size();
+		memory_usage -= open_list.prune(memory_to_free);
+		std::cerr << "; pruned " << open_states - open_list.size() << " open states: " << memory_usage;
+	}
+	
+	// 3. Remove the grounded actions and atoms which are no longer referred to by any state.
+	if (memory_usage > memory_budget_)
+	{
+		std::vector<const State*> live_states(processed_states.begin(), processed_states.end());
+		open_list.getStates(live_states);
+		
+		std::vector<const GroundedAction*> live_grounded_actions(plan_prefix);
+		for (std::vector<const State*>::const_iterator ci = live_states.begin(); ci != live_states.end(); ++ci)
+		{
+			if ((*ci)->getAchievingAction() != NULL)
+			{
+				live_grounded_actions.push_back((*ci)->getAchievingAction());
+			}
+		}
+		GroundedAction::removeInstantiatedGroundedActions(live_grounded_actions.begin(), live_grounded_actions.end());
+		
+		std::vector<unsigned int> live_grounded_atom_ids;
+		for (std::vector<const State*>::const_iterator ci = live_states.begin(); ci != live_states.end(); ++ci)
+		{
+			live_grounded_atom_ids.insert(live_grounded_atom_ids.end(), (*ci)->getFactIds().begin(), (*ci)->getFactIds().end());
+		}
+		for (std::vector<const GroundedAction*>::const_iterator ci = live_grounded_actions.begin(); ci != live_grounded_actions.end(); ++ci)
+		{
+			live_grounded_atom_ids.insert(live_grounded_atom_ids.end(), (*ci)->getAddEffects().begin(), (*ci)->getAddEffects().end());
+			live_grounded_atom_ids.insert(live_grounded_atom_ids.end(), (*ci)->getDeleteEffects().begin(), (*ci)->getDeleteEffects().end());
+		}
+		std::sort(live_grounded_atom_ids.begin(), live_grounded_atom_ids.end());
+		live_grounded_atom_ids.erase(std::unique(live_grounded_atom_ids.begin(), live_grounded_atom_ids.end()), live_grounded_atom_ids.end());
+		
+		std::vector<const GroundedAtom*> live_grounded_atoms(initial_facts);
+		live_grounded_atoms.insert(live_grounded_atoms.end(), goal_facts.begin(), goal_facts.end());
+		for (std::vector<unsigned int>::const_iterator ci = live_grounded_atom_ids.begin(); ci != live_grounded_atom_ids.end(); ++ci)
+		{
+			live_grounded_atoms.push_back(&GroundedAtom::getGroundedAtom(*ci));
+		}
+		GroundedAtom::removeInstantiatedGroundedAtom(live_grounded_atoms);
+		
+		memory_usage -= grounded_memory_usage;
+		memory_usage += GroundedAtom::getMemoryUsage() + GroundedAction::getMemoryUsage();
+		std::cerr << "; removed unused grounded atoms and actions: " << memory_usage;
+	}
+	std::cerr << " bytes." << std::endl;
 }
 
 };
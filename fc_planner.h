@@ -3,6 +3,12 @@
 
 #include <vector>
 #include <ostream>
+#include <deque>
+#include <stdint.h>
+#include <csignal>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <boost/random/mersenne_twister.hpp>
 
 #include "heuristics/heuristic_interface.h"
 
@@ -16,6 +22,7 @@ class PredicateManager;
 class TypeManager;
 class Object;
 class Predicate;
+class SearchTrace;
 
 /*namespace SAS_Plus
 {
@@ -113,6 +120,17 @@ public:
 	static void removeInstantiatedGroundedActions(const State& state);
 	static unsigned int numberOfGroundedActions();
 	
+	/**
+	 * @return An estimate of the number of bytes used by all the grounded actions.
+	 */
+	static std::size_t getMemoryUsage();
+	
+	/**
+	 * Every grounded action is assigned a unique id, the ids are dense so they can be used to index arrays. An id is stable for
+	 * as long as the grounded action exists.
+	 */
+	unsigned int getId() const { return id_; }
+	
 	const Action& getAction() const { return *action_; }
 	
 	const Object& getVariablesAssignment(unsigned int index) const { return *variables_[index]; }
@@ -120,18 +138,48 @@ public:
 	/**
 	 * Apply the grounded action to a set of facts which constitute a state. We assume that all the preconditions
 	 * are satisfied already.
+	 * @param facts The sorted ids of the facts which are true in the state, after the call they are the ids of the 
+	 * facts true in the resulting state (also sorted).
+	 * @param signature The signature of the state, it is updated with the facts that are added and removed.
 	 */
-	void applyTo(std::vector<const GroundedAtom*>& facts) const;
+	void applyTo(std::vector<unsigned int>& facts, std::size_t& signature) const;
+	
+	/**
+	 * Get the ids of the grounded atoms added and deleted by this action.
+	 */
+	const std::vector<unsigned int>& getAddEffects() const { return add_effects_; }
+	const std::vector<unsigned int>& getDeleteEffects() const { return delete_effects_; }
 private:
 	
+	/**
+	 * Calculate the key under which the grounded action is stored in the hash table.
+	 */
+	static std::size_t getKey(const Action& action, const Object** variables);
+	
+	/**
+	 * Remove the grounded action from the table, its id will be reused.
+	 */
+	static void removeInstantiatedGroundedAction(const GroundedAction& grounded_action);
+	
+	// All the grounded actions, indexed by their id. The slots of removed actions are NULL until their ids are reused.
 	static std::vector<const GroundedAction*> instantiated_grounded_actions_;
-	GroundedAction(const Action& action, const Object** variables);
+	static std::vector<unsigned int> free_ids_;
+	
+	// Maps the key of a grounded action to its id.
+	static boost::unordered_multimap<std::size_t, unsigned int> grounded_action_index_;
+	
+	GroundedAction(unsigned int id, const Action& action, const Object** variables);
 	
 	~GroundedAction();
 	
+	unsigned int id_;
 	const Action* action_;
 	const Object** variables_;
 	
+	// The ids of the grounded atoms deleted and added by this action.
+	std::vector<unsigned int> delete_effects_;
+	std::vector<unsigned int> add_effects_;
+	
 	friend std::ostream& operator<<(std::ostream& os, const GroundedAction& grounded_action);
 };
 
@@ -144,42 +192,162 @@ class GroundedAtom
 {
 public:
 	static void removeInstantiatedGroundedAtom();
+	
+	/**
+	 * Remove all the grounded atoms, except those in @param exceptions. The ids of the remaining grounded atoms do not change
+	 * but the ids of the removed atoms will be reused, so this should not be called while states refer to the removed atoms.
+	 */
 	static void removeInstantiatedGroundedAtom(const std::vector<const GroundedAtom*>& exceptions);
 	static const GroundedAtom& getGroundedAtom(const Predicate& predicate, const Object** variables);
+	
+	/**
+	 * Get the grounded atom with the given id.
+	 */
+	static const GroundedAtom& getGroundedAtom(unsigned int id) { return *instantiated_grounded_atoms_[id]; }
 	static void generateGroundedAtoms(std::vector<const GroundedAtom*>& grounded_objects, const PredicateManager& predicate_manager, const TermManager& term_manager);
 //	static const GroundedAtom& getGroundedAtom(const SAS_Plus::BoundedAtom& bounded_atom, const Bindings& bindings);
 	
 	static unsigned int numberOfGroundedAtoms();
 	
+	/**
+	 * @return An estimate of the number of bytes used by all the grounded atoms.
+	 */
+	static std::size_t getMemoryUsage();
+	
 	virtual ~GroundedAtom();
+	
+	/**
+	 * Every grounded atom is assigned a unique id, the ids are dense so they can be used to index arrays. An id is stable for
+	 * as long as the grounded atom exists.
+	 */
+	unsigned int getId() const { return id_; }
 
 	//const Atom& getAtom() const { return *atom_; }
 	const Predicate& getPredicate() const { return *predicate_; }
 	const Object& getObject(unsigned int term_index) const { return *variables_[term_index]; }
+	
+	/**
+	 * Get the Zobrist key of this fact. The key is derived from the predicate's name id and the objects, so a fact gets the same
+	 * key every time it is instantiated (even if the previous instance has been removed).
+	 */
+	std::size_t getSignature() const { return signature_; }
  	
 	bool operator==(const GroundedAtom& rhs) const;
 	bool operator!=(const GroundedAtom& rhs) const;
 	
 private:
-	GroundedAtom(const Predicate& predicate, const Object** variables);
+	GroundedAtom(unsigned int id, const Predicate& predicate, const Object** variables);
 //	GroundedAtom(const SAS_Plus::BoundedAtom& bounded_atom, const Bindings& bindings);
 	
+	/**
+	 * Calculate the key of a grounded atom, this is the same as the signature of the grounded atom.
+	 */
+	static std::size_t getKey(const Predicate& predicate, const Object** variables);
+	
+	// All the grounded atoms, indexed by their id. The slots of removed atoms are NULL until their ids are reused.
 	static std::vector<const GroundedAtom*> instantiated_grounded_atoms_;
+	static std::vector<unsigned int> free_ids_;
+	
+	// Maps the key of a grounded atom to its id.
+	static boost::unordered_multimap<std::size_t, unsigned int> grounded_atom_index_;
 
+	unsigned int id_;
 	const Predicate* predicate_;
 	const Object** variables_;
+	std::size_t signature_;
 	
 	friend std::ostream& operator<<(std::ostream& os, const GroundedAtom& grounded_atom);
 };
 
 std::ostream& operator<<(std::ostream& os, const GroundedAtom& grounded_atom);
 
-class State
+/**
+ * The facts of a state grouped by their predicate, and indexed by the objects of their terms. This index is used to match the
+ * preconditions of the compiled actions against a state without scanning all the facts of the state.
+ */
+class FactIndex
 {
 public:
-	//State(const std::vector<const GroundedAtom*>& facts, bool created_by_helpful_action);
+	FactIndex(const State& state);
 	
-	State(bool created_by_helpful_action);
+	/**
+	 * Get all the facts with the given predicate name id and arity.
+	 * @return The facts, or NULL if there are none.
+	 */
+	const std::vector<const GroundedAtom*>* getFacts(unsigned int name_id, unsigned int arity) const;
+	
+	/**
+	 * Get all the facts with the given predicate name id and arity whose @param term_index'th term is @param object.
+	 * @return The facts, or NULL if there are none.
+	 */
+	const std::vector<const GroundedAtom*>* getFacts(unsigned int name_id, unsigned int arity, unsigned int term_index, const Object& object) const;
+	
+private:
+	// The facts indexed by the name id and arity of their predicate.
+	boost::unordered_map<std::pair<unsigned int, unsigned int>, std::vector<const GroundedAtom*> > predicate_buckets_;
+	
+	// The facts indexed by the name id and arity of their predicate, the index of a term, and the object of that term.
+	boost::unordered_map<std::pair<std::pair<unsigned int, unsigned int>, std::pair<unsigned int, const Object*> >, std::vector<const GroundedAtom*> > term_buckets_;
+};
+
+/**
+ * A precondition of a compiled action.
+ */
+struct CompiledPrecondition
+{
+	// The name id and arity of the predicate.
+	unsigned int name_id_;
+	unsigned int arity_;
+	
+	// For each term, the index of the action variable it is bound to.
+	std::vector<unsigned int> variable_indexes_;
+	
+	// The index of a term which is assigned by a precondition earlier in the match order, or -1 if there is none.
+	int bound_term_index_;
+};
+
+/**
+ * The match plan of an action schema, which is compiled once before the search starts. The preconditions are ordered such
+ * that each precondition shares as many variables as possible with the preconditions matched before it, so the facts it is
+ * matched against can be looked up in a FactIndex.
+ */
+class CompiledAction
+{
+public:
+	CompiledAction(const Action& action, const TypeManager& type_manager);
+	
+	const Action& getAction() const { return *action_; }
+	
+	/**
+	 * Get the preconditions in the order they are to be matched.
+	 */
+	const std::vector<CompiledPrecondition>& getPreconditions() const { return preconditions_; }
+	
+	/**
+	 * Get the (in)equality constraints, each pair contains the indexes of the action variables and whether they must be different.
+	 */
+	const std::vector<std::pair<std::pair<unsigned int, unsigned int>, bool> >& getEqualities() const { return equalities_; }
+	
+	/**
+	 * Get all the objects which can be assigned to the @param variable_index'th action variable.
+	 */
+	const std::vector<const Object*>& getObjects(unsigned int variable_index) const { return objects_[variable_index]; }
+	
+private:
+	const Action* action_;
+	std::vector<CompiledPrecondition> preconditions_;
+	std::vector<std::pair<std::pair<unsigned int, unsigned int>, bool> > equalities_;
+	std::vector<std::vector<const Object*> > objects_;
+};
+
+/**
+ * A state stores the ids of the grounded atoms which are true, sorted in ascending order. A successor state is created by
+ * applying a grounded action to the facts of its parent.
+ */
+class State
+{
+public:
+	State(const std::vector<const GroundedAtom*>& facts, bool created_by_helpful_action);
 	State(const State& rhs, const GroundedAction& achiever, bool created_by_helpful_action);
 	
 	~State();
@@ -188,14 +356,43 @@ public:
 	
 	unsigned int getHeuristic() const { return /*distance_from_start_ + */distance_to_goal_; }
 	
+	/**
+	 * @return The number of actions executed to reach this state from the initial state.
+	 */
+	unsigned int getDistanceFromStart() const { return distance_from_start_; }
+	
+	/**
+	 * @return An estimate of the number of bytes used by this state.
+	 */
+	std::size_t getMemoryUsage() const { return sizeof(State) + facts_.capacity() * sizeof(unsigned int); }
+	
+	/**
+	 * Free the facts of this state. Afterwards the state can no longer be expanded or compared with other states, only the path
+	 * to this state can still be extracted.
+	 */
+	void releaseFacts();
+	
+	/**
+	 * Make this state the first state of its path, so the states before it can be deleted. The actions which led to this state
+	 * must be stored elsewhere, only the action which created this state is kept.
+	 */
+	void detachFromParent() { parent_ = NULL; }
+	
 	//void getSuccessors(NewStateReachedListener& listener, const std::multimap<const Object*, const Object*>& symmetrical_groups, const ActionManager& action_manager, const TypeManager& type_manager, bool prune_unhelpful_actions, const std::vector<const State*>& all_states) const;
 	//void getSuccessors(NewStateReachedListener& listener, const std::multimap<const Object*, const Object*>& symmetrical_groups, const ActionManager& action_manager, const TypeManager& type_manager, bool prune_unhelpful_actions, const std::vector<const State*>& all_states, const TermManager& term_manager, const std::vector<const GroundedAtom*>& goals, const HEURISTICS::HeuristicInterface& heuristic) const;
-	void getSuccessors(NewStateReachedListener& listener, const std::multimap<const Object*, const Object*>& symmetrical_groups, const ActionManager& action_manager, const TypeManager& type_manager, bool prune_unhelpful_actions, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >& helpful_actions) const;
+	void getSuccessors(NewStateReachedListener& listener, const std::multimap<const Object*, const Object*>& symmetrical_groups, const std::vector<const CompiledAction*>& compiled_actions, bool prune_unhelpful_actions, const std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >& helpful_actions) const;
 	
-	bool isSuperSetOf(const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& facts) const;
+	bool isSuperSetOf(const std::vector<const GroundedAtom*>& facts) const;
 	
-	//const std::vector<const GroundedAtom*>& getFacts() const { return facts_; }
-	void getFacts(const std::vector<const GroundedAtom*>& initial_facts, std::vector<const GroundedAtom*>& facts) const;
+	/**
+	 * Get the ids of the grounded atoms which are true in this state, sorted in ascending order.
+	 */
+	const std::vector<unsigned int>& getFactIds() const { return facts_; }
+	
+	/**
+	 * Add the grounded atoms which are true in this state to @param facts.
+	 */
+	void getFacts(std::vector<const GroundedAtom*>& facts) const;
 	
 	//void setHelpfulActions(const std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >& helpful_actions);
 	
@@ -205,9 +402,15 @@ public:
 	
 	//void deleteHelpfulActions();
 	
-	bool isEqualTo(const State& state, const std::vector<const GroundedAtom*>& initial_facts) const;
+	bool isEqualTo(const State& state) const;
 	bool operator==(const State& state) const;
 	
+	/**
+	 * Get the signature of this state, which is the XOR of the Zobrist keys of all its facts. Equal states always have the same
+	 * signature, but states with the same signature are not necessarily equal.
+	 */
+	std::size_t getSignature() const { return signature_; }
+	
 	/**
 	 * Check if two states are symmetrical.
 	 */
@@ -223,11 +426,13 @@ private:
 
 	const State* parent_;
 	const GroundedAction* achieving_action_;
-	//std::vector<const GroundedAtom*> facts_;
+	std::vector<unsigned int> facts_;
 	
 	unsigned int distance_to_goal_;
 	unsigned int distance_from_start_;
 	
+	std::size_t signature_;
+	
 	//std::vector<const GroundedAction*> achievers_;
 	
 	//std::vector<std::pair<const Action*, std::vector<const Object*>**> > helpful_actions_;
@@ -240,9 +445,15 @@ private:
 	//bool addFact(const GroundedAtom& fact, bool remove_fact);
 	//void removeFact(const GroundedAtom& fact);
 	
-	void instantiateAndExecuteAction(NewStateReachedListener& listener, const std::multimap<const Object*, const Object*>& symmetrical_groups, const MyPOP::Action& action, const std::vector< const MyPOP::Atom* >& preconditions, const std::vector< const MyPOP::Equality* >& equalities, unsigned int uninitialised_precondition_index, const MyPOP::Object** assigned_variables, const MyPOP::TypeManager& type_manager, bool prune_unhelpful_actions, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >& helpful_actions) const;
+	void instantiateAndExecuteAction(NewStateReachedListener& listener, const std::multimap<const Object*, const Object*>& symmetrical_groups, const CompiledAction& compiled_action, const FactIndex& fact_index, unsigned int uninitialised_precondition_index, const MyPOP::Object** assigned_variables, bool prune_unhelpful_actions, const std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >& helpful_actions) const;
 	
-	void createAllGroundedVariables(std::vector<const Object**>& all_grounded_action_variables, const Object** grounded_action_variables, const Action& action, const TypeManager& type_manager) const;
+	/**
+	 * Create the successor states for all the grounded actions which match the partial assignment @param assigned_variables,
+	 * all the preconditions are satisfied by this assignment.
+	 */
+	void executeAction(NewStateReachedListener& listener, const CompiledAction& compiled_action, const MyPOP::Object** assigned_variables, bool prune_unhelpful_actions, const std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >& helpful_actions) const;
+	
+	void createAllGroundedVariables(std::vector<const Object**>& all_grounded_action_variables, const Object** grounded_action_variables, const CompiledAction& compiled_action) const;
 	
 	//void checkSanity() const;
 	
@@ -251,9 +462,211 @@ private:
 
 std::ostream& operator<<(std::ostream& os, const State& state);
 
-class CompareStates {
+/**
+ * The states which have been reached, but not yet expanded, by the forward chaining planner. The open list owns the states
+ * it contains.
+ */
+class OpenList
+{
 public:
-	bool operator()(const State* lhs, const State* rhs);
+	virtual ~OpenList();
+	
+	virtual void push(State& state) = 0;
+	
+	/**
+	 * Remove the state which should be expanded next from the open list, the caller takes ownership of the state.
+	 * @return The next state, or NULL if the open list is empty.
+	 */
+	virtual State* pop() = 0;
+	
+	virtual bool empty() const = 0;
+	
+	virtual unsigned int size() const = 0;
+	
+	/**
+	 * Delete all the states in the open list.
+	 */
+	virtual void clear() = 0;
+	
+	/**
+	 * @return True if the order in which states are popped depends on whether they are created by helpful actions.
+	 */
+	virtual bool usesHelpfulActions() const { return false; }
+	
+	/**
+	 * @return An estimate of the number of bytes used by the states in the open list.
+	 */
+	virtual std::size_t getMemoryUsage() const = 0;
+	
+	/**
+	 * Delete the states which would be popped last until at least @param memory_to_free bytes have been freed, or only the
+	 * state which would be popped next is left.
+	 * @return The number of bytes freed.
+	 */
+	virtual std::size_t prune(std::size_t memory_to_free) = 0;
+	
+	/**
+	 * Add all the states in the open list to @param states.
+	 */
+	virtual void getStates(std::vector<const State*>& states) const = 0;
+};
+
+/**
+ * How states with the same priority are ordered.
+ */
+enum TIE_BREAKING { TIE_BREAKING_RANDOM, TIE_BREAKING_FIFO, TIE_BREAKING_LIFO };
+
+/**
+ * Open list which orders states by the priority g_weight * g + h_weight * h, where g is the distance from the initial state and
+ * h the heuristic estimate. All priorities are integers, so every priority has its own bucket and states are pushed and popped
+ * in constant time. States with an infinite heuristic estimate are popped last.
+ */
+class BucketOpenList : public OpenList
+{
+public:
+	/**
+	 * @param random_generator Used to break ties at random.
+	 */
+	BucketOpenList(unsigned int g_weight, unsigned int h_weight, TIE_BREAKING tie_breaking, boost::mt19937& random_generator);
+	
+	~BucketOpenList();
+	
+	void push(State& state);
+	
+	State* pop();
+	
+	bool empty() const { return size_ == 0; }
+	
+	unsigned int size() const { return size_; }
+	
+	void clear();
+	
+	std::size_t getMemoryUsage() const { return memory_usage_; }
+	
+	std::size_t prune(std::size_t memory_to_free);
+	
+	void getStates(std::vector<const State*>& states) const;
+	
+private:
+	
+	State* pop(std::deque<State*>& bucket);
+	
+	unsigned int g_weight_;
+	unsigned int h_weight_;
+	TIE_BREAKING tie_breaking_;
+	boost::mt19937* random_generator_;
+	
+	std::vector<std::deque<State*> > buckets_;
+	// The states which cannot reach the goal.
+	std::deque<State*> dead_ends_;
+	// All buckets with a lower priority are empty.
+	unsigned int lowest_bucket_;
+	unsigned int size_;
+	std::size_t memory_usage_;
+};
+
+/**
+ * Open list which keeps the states created by helpful actions and the other states in two separate open lists, states are
+ * popped from both open lists in turn.
+ */
+class AlternatingOpenList : public OpenList
+{
+public:
+	/**
+	 * The alternating open list takes ownership of both open lists.
+	 */
+	AlternatingOpenList(OpenList& helpful_states, OpenList& other_states);
+	
+	~AlternatingOpenList();
+	
+	void push(State& state);
+	
+	State* pop();
+	
+	bool empty() const { return helpful_states_->empty() && other_states_->empty(); }
+	
+	unsigned int size() const { return helpful_states_->size() + other_states_->size(); }
+	
+	void clear();
+	
+	bool usesHelpfulActions() const { return true; }
+	
+	std::size_t getMemoryUsage() const { return helpful_states_->getMemoryUsage() + other_states_->getMemoryUsage(); }
+	
+	/**
+	 * The states not created by helpful actions are pruned first.
+	 */
+	std::size_t prune(std::size_t memory_to_free);
+	
+	void getStates(std::vector<const State*>& states) const;
+	
+private:
+	OpenList* helpful_states_;
+	OpenList* other_states_;
+	bool pop_helpful_state_;
+};
+
+/**
+ * The search strategy of the forward chaining planner, determines the open list to use.
+ */
+struct SearchStrategy
+{
+	/**
+	 * The default strategy is greedy best first search with random tie breaking.
+	 */
+	SearchStrategy();
+	
+	OpenList* createOpenList(boost::mt19937& random_generator) const;
+	
+	// The weights of the distance from the initial state and of the heuristic estimate, (0, 1) is greedy best first search,
+	// (1, w) is weighted A*.
+	unsigned int g_weight_;
+	unsigned int h_weight_;
+	TIE_BREAKING tie_breaking_;
+	// Keep the states created by helpful actions in a separate open list.
+	bool alternate_helpful_states_;
+};
+
+/**
+ * The set of states which have been expanded by the forward chaining planner. States are indexed by their signature so we 
+ * only need to compare the facts of two states if their signatures collide.
+ */
+class ClosedList
+{
+public:
+	ClosedList();
+	
+	/**
+	 * Check if a state equal to the given state has been added to the closed list.
+	 */
+	bool contains(const State& state) const;
+	
+	/**
+	 * Add the given state to the closed list. The closed list does not take ownership of the state.
+	 */
+	void add(const State& state);
+	
+	/**
+	 * Remove all the states from the closed list, states added from now on are stored in full again.
+	 */
+	void clear();
+	
+	unsigned int size() const { return states_.size() + signatures_.size(); }
+	
+	/**
+	 * Only store the signatures of the states from now on, so the facts of the states in the closed list can be released. Two
+	 * states with the same signature are then considered to be equal.
+	 */
+	void compact();
+	
+	bool isCompact() const { return compact_; }
+	
+private:
+	boost::unordered_multimap<std::size_t, const State*> states_;
+	
+	// The signatures of the states added after the closed list has been compacted.
+	boost::unordered_set<std::size_t> signatures_;
+	bool compact_;
 };
 
 /**
@@ -266,6 +679,33 @@ public:
 	
 	virtual ~ForwardChainingPlanner();
 	
+	void setSearchStrategy(const SearchStrategy& search_strategy) { search_strategy_ = search_strategy; }
+	
+	/**
+	 * Seed the random number generator used by the search, by default it is seeded with the time the planner is created. Given
+	 * the same seed the planner explores the same states in the same order.
+	 */
+	void setSeed(uint32_t seed) { random_generator_.seed(seed); }
+	
+	/**
+	 * Record the search to, or compare it against, the given trace. The planner does not take ownership of the trace.
+	 */
+	void setSearchTrace(SearchTrace* search_trace) { search_trace_ = search_trace; }
+	
+	/**
+	 * Limit the memory used by the states, grounded atoms and grounded actions of the search to @param memory_budget bytes, 0
+	 * means there is no limit. See @ref enforceMemoryBudget.
+	 */
+	void setMemoryBudget(std::size_t memory_budget) { memory_budget_ = memory_budget; }
+	
+	/**
+	 * Ask all running searches to stop, @ref findPlan then returns as if no plan was found. Only sets a flag, so it is safe to
+	 * call from a signal handler.
+	 */
+	static void requestStop() { stop_requested_ = 1; }
+	
+	static bool isStopRequested() { return stop_requested_ != 0; }
+	
 	std::pair<int, int> findPlan(std::vector< const MyPOP::GroundedAction* >& plan, const std::vector< const MyPOP::Atom* >& initial_facts, const std::vector< const MyPOP::Atom* >& goal_facts, const TermManager& term_manager, bool prune_unhelpful_actions, bool allow_restarts, bool allow_new_goals_to_be_added);
 	
 private:
@@ -280,11 +720,40 @@ private:
 	 */
 	bool satisfyGoal(const State& current_state, const std::vector<const GroundedAtom*>& goal_facts) const;
 	
+	/**
+	 * If the memory used by the search exceeds the memory budget, the following steps are taken until it no longer does:
+	 * 1. The closed list is compacted and the facts of the states expanded since the last time are released.
+	 * 2. The open states which would be expanded last are deleted.
+	 * 3. The grounded actions and grounded atoms no state or action of @ref plan_prefix refers to are removed.
+	 * @param processed_states The states which have been expanded.
+	 * @param released_states The number of states at the front of @ref processed_states whose facts have already been released,
+	 * updated by this function.
+	 * @param plan_prefix The actions which lead to the state the search last restarted from.
+	 * @param last_best_state_seen The state the search restarts from, its facts are kept.
+	 */
+	void enforceMemoryBudget(OpenList& open_list, ClosedList& closed_list, const std::vector<State*>& processed_states, std::size_t& released_states, const std::vector<const GroundedAction*>& plan_prefix, const State& last_best_state_seen, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts) const;
+	
 	const ActionManager* action_manager_;
 	PredicateManager* predicate_manager_;
 	const TypeManager* type_manager_;
 	
+	// The match plans of all the actions.
+	std::vector<const CompiledAction*> compiled_actions_;
+	
 	HEURISTICS::HeuristicInterface* heuristic_;
+	
+	SearchStrategy search_strategy_;
+	
+	boost::mt19937 random_generator_;
+	
+	SearchTrace* search_trace_;
+	
+	std::size_t memory_budget_;
+	
+	// The number of expansions between two checks of the memory budget.
+	static const unsigned int MEMORY_CHECK_INTERVAL = 128;
+	
+	static volatile sig_atomic_t stop_requested_;
 };
 
 };
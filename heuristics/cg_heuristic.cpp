@@ -7,12 +7,14 @@
 #include "fact_set.h"
 #include <sas/property_space.h>
 #include <queue>
+#include <algorithm>
 #include <parser_utils.h>
 #include <action_manager.h>
 #include "term_manager.h"
 #include <predicate_manager.h>
 
 ///#define LIFTED_CAUSAL_GRAPH_COMMENTS
+//#define LIFTED_CAUSAL_GRAPH_KEEP_STATISTICS
 
 namespace MyPOP {
 
@@ -143,7 +145,7 @@ std::ostream& operator<<(std::ostream& os, const LCGSearchNode& search_node)
 }
 	
 LiftedCausalGraphHeuristic::LiftedCausalGraphHeuristic(const std::vector<SAS_Plus::LiftedDTG*>& lifted_dtgs, const ActionManager& action_manager, const PredicateManager& predicate_manager, const std::vector< const GroundedAtom* >& goal_facts)
-	: lifted_dtgs_(&lifted_dtgs), predicate_manager_(&predicate_manager)
+	: lifted_dtgs_(&lifted_dtgs), predicate_manager_(&predicate_manager), nr_evaluations_(0), nr_cached_solutions_(0), cache_hits_(0), cache_misses_(0)
 {
 	causal_graph_ = new SAS_Plus::CausalGraph(lifted_dtgs, action_manager, predicate_manager);
 	Graphviz::printToDot("cg", *causal_graph_);
@@ -152,16 +154,48 @@ LiftedCausalGraphHeuristic::LiftedCausalGraphHeuristic(const std::vector<SAS_Plu
 #ifdef LIFTED_CAUSAL_GRAPH_COMMENTS
 	//std::cout << *causal_graph_ << std::endl;
 #endif
+	
+	// A search through a lifted DTG only considers the facts of the state which match the values of that lifted DTG or the values of
+	// the lifted DTGs it depends on.
+	for (std::vector<SAS_Plus::LiftedDTG*>::const_iterator ci = lifted_dtgs.begin(); ci != lifted_dtgs.end(); ++ci)
+	{
+		std::vector<bool>& relevant_predicates = relevant_predicates_[*ci];
+		std::vector<const SAS_Plus::LiftedDTG*> dependencies;
+		causal_graph_->getAllDependencies(dependencies, **ci);
+		for (std::vector<const SAS_Plus::LiftedDTG*>::const_iterator ci = dependencies.begin(); ci != dependencies.end(); ++ci)
+		{
+			for (std::vector<SAS_Plus::MultiValuedValue*>::const_iterator ci2 = (*ci)->getNodes().begin(); ci2 != (*ci)->getNodes().end(); ++ci2)
+			{
+				for (std::vector<HEURISTICS::Fact*>::const_iterator ci3 = (*ci2)->getValues().begin(); ci3 != (*ci2)->getValues().end(); ++ci3)
+				{
+					unsigned int name_id = (*ci3)->getPredicate().getNameId();
+					if (name_id >= relevant_predicates.size())
+					{
+						relevant_predicates.resize(name_id + 1, false);
+					}
+					relevant_predicates[name_id] = true;
+				}
+			}
+		}
+	}
 }
 
 LiftedCausalGraphHeuristic::~LiftedCausalGraphHeuristic()
 {
+#ifdef LIFTED_CAUSAL_GRAPH_KEEP_STATISTICS
+	std::cerr << "Lifted causal graph cache: " << cache_hits_ << " hits, " << cache_misses_ << " misses." << std::endl;
+#endif
 	delete causal_graph_;
-	for (std::map<const SAS_Plus::MultiValuedValue*, std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> >* >::const_iterator ci = cache_.begin(); ci != cache_.end(); ++ci)
+	clearCache();
+}
+
+void LiftedCausalGraphHeuristic::clearCache()
+{
+	for (Cache::const_iterator ci = cache_.begin(); ci != cache_.end(); ++ci)
 	{
-		std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> >* cache_item = (*ci).second;
+		CachedSolutions* cache_item = (*ci).second;
 		
-		for (std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> >::const_iterator ci = cache_item->begin(); ci != cache_item->end(); ++ci)
+		for (CachedSolutions::const_iterator ci = cache_item->begin(); ci != cache_item->end(); ++ci)
 		{
 			delete (*ci).first;
 			delete &(*ci).second->getStartingNode();
@@ -170,6 +204,37 @@ LiftedCausalGraphHeuristic::~LiftedCausalGraphHeuristic()
 		
 		delete cache_item;
 	}
+	cache_.clear();
+	nr_cached_solutions_ = 0;
+}
+
+const LiftedCausalGraphHeuristic::RelevantFactKeys& LiftedCausalGraphHeuristic::getRelevantFactKeys(const SAS_Plus::LiftedDTG& lifted_dtg)
+{
+	RelevantFactKeys& relevant_fact_keys = relevant_fact_keys_[&lifted_dtg];
+	if (relevant_fact_keys.evaluation_ == nr_evaluations_)
+	{
+		return relevant_fact_keys;
+	}
+	
+	// The keys are independent of the ids of the grounded atoms so the cached solutions remain valid if the grounded atoms are removed.
+	relevant_fact_keys.evaluation_ = nr_evaluations_;
+	relevant_fact_keys.keys_.clear();
+	const std::vector<bool>& relevant_predicates = (*relevant_predicates_.find(&lifted_dtg)).second;
+	for (unsigned int name_id = 0; name_id < relevant_predicates.size() && name_id < state_facts_by_predicate_.size(); ++name_id)
+	{
+		if (!relevant_predicates[name_id])
+		{
+			continue;
+		}
+		
+		for (std::vector<const GroundedAtom*>::const_iterator ci = state_facts_by_predicate_[name_id].begin(); ci != state_facts_by_predicate_[name_id].end(); ++ci)
+		{
+			relevant_fact_keys.keys_.push_back((*ci)->getSignature());
+		}
+	}
+	std::sort(relevant_fact_keys.keys_.begin(), relevant_fact_keys.keys_.end());
+	relevant_fact_keys.hash_ = boost::hash_range(relevant_fact_keys.keys_.begin(), relevant_fact_keys.keys_.end());
+	return relevant_fact_keys;
 }
 
 void LiftedCausalGraphHeuristic::setHeuristicForState(MyPOP::State& state, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts, const TermManager& term_manager, bool find_helpful_actions, bool allow_new_goals_to_be_added)
@@ -180,27 +245,42 @@ void LiftedCausalGraphHeuristic::setHeuristicForState(MyPOP::State& state, const
 #endif
 	deleteHelpfulActions();
 	std::vector<const GroundedAtom*> facts_in_state;
-	state.getFacts(initial_facts, facts_in_state);
+	state.getFacts(facts_in_state);
 	unsigned int h = getHeuristic(facts_in_state, initial_facts, goal_facts);
 	state.setDistanceToGoal(h);
 }
 
 unsigned int LiftedCausalGraphHeuristic::getHeuristic(const std::vector<const GroundedAtom*>& facts_in_state, const std::vector<const GroundedAtom*>& initial_facts, const std::vector< const GroundedAtom* >& bounded_goal_facts)
 {
-	for (std::map<const SAS_Plus::MultiValuedValue*, std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> >* >::const_iterator ci = cache_.begin(); ci != cache_.end(); ++ci)
+	if (nr_cached_solutions_ >= MAX_CACHED_SOLUTIONS)
 	{
-		std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> >* cache_item = (*ci).second;
-		
-		for (std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> >::const_iterator ci = cache_item->begin(); ci != cache_item->end(); ++ci)
+		clearCache();
+	}
+	
+	// Index the facts of the state so the facts which can be assigned to the values of a node are found without scanning the state.
+	for (std::vector<std::vector<const GroundedAtom*> >::iterator i = state_facts_by_predicate_.begin(); i != state_facts_by_predicate_.end(); ++i)
+	{
+		(*i).clear();
+	}
+	state_facts_by_term_.clear();
+	for (std::vector<const GroundedAtom*>::const_iterator ci = facts_in_state.begin(); ci != facts_in_state.end(); ++ci)
+	{
+		const GroundedAtom* fact = *ci;
+		unsigned int name_id = fact->getPredicate().getNameId();
+		if (name_id >= state_facts_by_predicate_.size())
 		{
-			delete (*ci).first;
-			delete &(*ci).second->getStartingNode();
-			delete (*ci).second;
+			state_facts_by_predicate_.resize(name_id + 1);
 		}
+		state_facts_by_predicate_[name_id].push_back(fact);
 		
-		delete cache_item;
+		for (unsigned int term_index = 0; term_index < fact->getPredicate().getArity(); ++term_index)
+		{
+			state_facts_by_term_[std::make_pair(std::make_pair(name_id, term_index), fact->getObject(term_index).getId())].push_back(fact);
+		}
 	}
-	cache_.clear();
+	
+	// The projections of the state on the lifted DTGs are computed by getRelevantFactKeys when they are first needed.
+	++nr_evaluations_;
 	
 //	std::vector<const Fact*> all_created_facts;
 	
@@ -276,29 +356,47 @@ const LCGSearchNode* LiftedCausalGraphHeuristic::getCost(const std::vector<const
 {
 	// Check if we have this solution cached.
 	const SAS_Plus::MultiValuedValue* current_node = NULL;
+	const SAS_Plus::MultiValuedValue* best_node = NULL;
+	static const RelevantFactKeys no_relevant_fact_keys;
+	const RelevantFactKeys* relevant_fact_keys = &no_relevant_fact_keys;
 	if (current_search_node != NULL)
 	{
 		current_node = &current_search_node->getNode();
+		relevant_fact_keys = &getRelevantFactKeys(current_node->getLiftedDTG());
 	}
+	else
+	{
+		best_node = findNode(goal, lifted_dtgs);
+		if (best_node != NULL)
+		{
+			relevant_fact_keys = &getRelevantFactKeys(best_node->getLiftedDTG());
+		}
+	}
+	CacheLookupKey cache_key(current_node, *relevant_fact_keys);
 	
-	std::map<const SAS_Plus::MultiValuedValue*, std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> >* >::const_iterator cache_ci = cache_.find(current_node);
+	Cache::const_iterator cache_ci = cache_.find(cache_key, CacheKeyHash(), CacheKeyEqual());
 	if (cache_ci != cache_.end())
 	{
-		std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> >* cached_solutions = (*cache_ci).second;
-		for (std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> >::const_iterator ci = cached_solutions->begin(); ci != cached_solutions->end(); ++ci)
+		CachedSolutions* cached_solutions = (*cache_ci).second;
+		for (CachedSolutions::const_iterator ci = cached_solutions->begin(); ci != cached_solutions->end(); ++ci)
 		{
 			if ((*ci).first->canUnifyWith(goal))
 			{
 #ifdef LIFTED_CAUSAL_GRAPH_COMMENTS
 				std::cout << "Found cached solution: " << *(*ci).second << std::endl;
 #endif
+				++cache_hits_;
 				return &(*ci).second->createDeepCopy();
 			}
 		}
 	}
+	++cache_misses_;
 
 	// If the fact is not part of the from node, then we look for the DTG it does belong to.
-	const SAS_Plus::MultiValuedValue* best_node = findNode(goal, lifted_dtgs);
+	if (best_node == NULL)
+	{
+		best_node = findNode(goal, lifted_dtgs);
+	}
 	
 	if (best_node == NULL)
 	{
@@ -425,18 +523,16 @@ const LCGSearchNode* LiftedCausalGraphHeuristic::getCost(const std::vector<const
 	// Store the cached value.
 	if (result != NULL)
 	{
-		std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> >* cached_items = NULL;
-		if (cache_ci != cache_.end())
+		// The searches for the preconditions add to the cache, so the iterator found before the search is no longer valid.
+		Cache::iterator cache_i = cache_.find(cache_key, CacheKeyHash(), CacheKeyEqual());
+		if (cache_i == cache_.end())
 		{
-			cached_items = (*cache_ci).second;
-		}
-		else
-		{
-			cached_items = new std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> >();
-			cache_[current_node] = cached_items;
+			cache_i = cache_.insert(std::make_pair(std::make_pair(current_node, relevant_fact_keys->keys_), new CachedSolutions())).first;
 		}
+		CachedSolutions* cached_items = (*cache_i).second;
 		
 		cached_items->push_back(std::make_pair(new HEURISTICS::Fact(goal), &result->createDeepCopy()));
+		++nr_cached_solutions_;
 	}
 
 	for (std::vector<std::pair<const SAS_Plus::MultiValuedValue*, const std::vector<const HEURISTICS::Fact*>* > >::const_iterator ci = new_from_assignments.begin(); ci != new_from_assignments.end(); ++ci)
@@ -1034,6 +1130,22 @@ void LiftedCausalGraphHeuristic::getNodes(std::vector<std::pair<const SAS_Plus::
 			continue;
 		}
 		
+		// A node can only be mapped to the state if every value has a fact in the state with the same predicate.
+		bool all_values_in_state = true;
+		for (std::vector<HEURISTICS::Fact*>::const_iterator ci = node->getValues().begin(); ci != node->getValues().end(); ++ci)
+		{
+			unsigned int name_id = (*ci)->getPredicate().getNameId();
+			if (name_id >= state_facts_by_predicate_.size() || state_facts_by_predicate_[name_id].empty())
+			{
+				all_values_in_state = false;
+				break;
+			}
+		}
+		if (!all_values_in_state)
+		{
+			continue;
+		}
+		
 #ifdef LIFTED_CAUSAL_GRAPH_COMMENTS
 		std::cout << "Process: " << *node << std::endl;
 #endif
@@ -1100,9 +1212,25 @@ void LiftedCausalGraphHeuristic::findMappings(std::vector<std::vector<const HEUR
 //	std::vector<const GroundedAtom*> state_facts;
 //	state.getFacts(initial_facts, state_facts);
 	
+	// Only the facts of the state with the same predicate can be mapped to this fact. If the invariable is bound to a single
+	// object we only need to consider those facts which contain that object as their invariable.
+	static const std::vector<const GroundedAtom*> no_facts;
+	const std::vector<const GroundedAtom*>* candidate_facts = &no_facts;
+	if (property->getIndex() != std::numeric_limits<unsigned int>::max() && invariable_domain.size() == 1)
+	{
+		boost::unordered_map<FactTermKey, std::vector<const GroundedAtom*> >::const_iterator ci = state_facts_by_term_.find(std::make_pair(std::make_pair(fact->getPredicate().getNameId(), property->getIndex()), invariable_domain.getVariableDomain()[0]->getId()));
+		if (ci != state_facts_by_term_.end())
+		{
+			candidate_facts = &(*ci).second;
+		}
+	}
+	else if (fact->getPredicate().getNameId() < state_facts_by_predicate_.size())
+	{
+		candidate_facts = &state_facts_by_predicate_[fact->getPredicate().getNameId()];
+	}
+	
 	// Check which facts from the state can be mapped to this fact.
-	///for (std::vector<const GroundedAtom*>::const_iterator ci = state.getFacts().begin(); ci != state.getFacts().end(); ++ci)
-	for (std::vector<const GroundedAtom*>::const_iterator ci = facts_in_state.begin(); ci != facts_in_state.end(); ++ci)
+	for (std::vector<const GroundedAtom*>::const_iterator ci = candidate_facts->begin(); ci != candidate_facts->end(); ++ci)
 	{
 		const GroundedAtom* atom = *ci;
 		if (!fact->canUnifyWith(*atom))
@@ -4,6 +4,8 @@
 #include <vector>
 #include <map>
 #include <ostream>
+#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
 
 //#include "fc_planner.h"
 #include "heuristic_interface.h"
@@ -92,6 +94,21 @@ public:
 	
 private:
 	
+	/**
+	 * The keys of the facts of the state which is being evaluated, projected on the relevant predicates of a lifted DTG.
+	 */
+	struct RelevantFactKeys
+	{
+		RelevantFactKeys() : evaluation_(0), hash_(0) { }
+		
+		// The evaluation in which the projection was made.
+		unsigned int evaluation_;
+		
+		// The sorted keys and their hash, which is computed once per projection.
+		std::vector<std::size_t> keys_;
+		std::size_t hash_;
+	};
+	
 	unsigned int getHeuristic(const std::vector<const GroundedAtom*>& facts_in_state, const std::vector<const GroundedAtom*>& initial_facts, const std::vector< const GroundedAtom* >& bounded_goal_facts);
 	
 	const LCGSearchNode* getCost(const std::vector<const GroundedAtom*>& facts_in_state, const std::vector<const SAS_Plus::LiftedDTG*>& lifted_dtgs, const HEURISTICS::Fact& goal, const LCGSearchNode* current_search_node, const std::vector<const GroundedAtom*>& initial_facts);
@@ -108,14 +125,85 @@ private:
 
 	void findMappings(std::vector<std::vector<const HEURISTICS::Fact*>* >& found_mappings, const std::vector<const HEURISTICS::Fact*>& current_mappings, const SAS_Plus::MultiValuedValue& node, const HEURISTICS::VariableDomain& invariable_domain, const std::vector<const GroundedAtom*>& facts_in_state, const std::vector<const GroundedAtom*>& initial_facts) const;
 	
+	/**
+	 * Find the facts of the state which can influence a search through @param lifted_dtg. They are only projected the first time
+	 * they are needed during the evaluation of a state.
+	 * @return The sorted keys of the facts of the state whose predicate is part of a value of @param lifted_dtg or of one of the lifted
+	 * DTGs it depends on.
+	 */
+	const RelevantFactKeys& getRelevantFactKeys(const SAS_Plus::LiftedDTG& lifted_dtg);
+	
+	void clearCache();
+	
 	SAS_Plus::CausalGraph* causal_graph_;
 	
+	// For every lifted DTG the name ids of the predicates of the values of that lifted DTG and of all the lifted DTGs it depends on.
+	std::map<const SAS_Plus::LiftedDTG*, std::vector<bool> > relevant_predicates_;
+	
+	// The keys of the facts of the state which is being evaluated, projected on the relevant predicates of every lifted DTG.
+	std::map<const SAS_Plus::LiftedDTG*, RelevantFactKeys> relevant_fact_keys_;
+	
+	// The number of states evaluated so far, including the one which is being evaluated.
+	unsigned int nr_evaluations_;
+	
+	// The facts of the state which is being evaluated indexed by the name id of their predicate, in the order of the state.
+	std::vector<std::vector<const GroundedAtom*> > state_facts_by_predicate_;
+	
+	// The facts of the state which is being evaluated indexed by the name id of their predicate, a term index and the id of the
+	// object of that term, in the order of the state.
+	typedef std::pair<std::pair<unsigned int, unsigned int>, unsigned int> FactTermKey;
+	boost::unordered_map<FactTermKey, std::vector<const GroundedAtom*> > state_facts_by_term_;
+	
 	// Cached solutions.
 	// We can use the cache of a solution iff:
 	// The start end end nodes are the same and the invariables match too.
-	std::map<const SAS_Plus::MultiValuedValue*, std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> >* > cache_;
-	//LCGSearchNode
-	
+	// A solution only depends on the facts of the state which are relevant to the lifted DTG of the node the search started from (or
+	// of the goal if the search started from the state), so solutions are reused by all the states which agree on those facts. Most
+	// successors only change the values of a few variables, so most solutions of their parent remain valid.
+	typedef std::vector<std::pair<const HEURISTICS::Fact*, LCGSearchNode*> > CachedSolutions;
+	typedef std::pair<const SAS_Plus::MultiValuedValue*, std::vector<std::size_t> > CacheKey;
+	
+	// Solutions are looked up with a key which refers to the projection of the state rather than copying it, the projection is only
+	// copied into a CacheKey when a new solution is stored.
+	struct CacheLookupKey
+	{
+		CacheLookupKey(const SAS_Plus::MultiValuedValue* node, const RelevantFactKeys& relevant_fact_keys)
+			: node_(node), relevant_fact_keys_(&relevant_fact_keys) { }
+		
+		const SAS_Plus::MultiValuedValue* node_;
+		const RelevantFactKeys* relevant_fact_keys_;
+	};
+	
+	struct CacheKeyHash
+	{
+		std::size_t operator()(const CacheKey& key) const { return getHash(key.first, boost::hash_range(key.second.begin(), key.second.end())); }
+		std::size_t operator()(const CacheLookupKey& key) const { return getHash(key.node_, key.relevant_fact_keys_->hash_); }
+		
+		static std::size_t getHash(const SAS_Plus::MultiValuedValue* node, std::size_t keys_hash)
+		{
+			boost::hash_combine(keys_hash, node);
+			return keys_hash;
+		}
+	};
+	
+	struct CacheKeyEqual
+	{
+		bool operator()(const CacheKey& lhs, const CacheKey& rhs) const { return lhs == rhs; }
+		bool operator()(const CacheLookupKey& lhs, const CacheKey& rhs) const { return lhs.node_ == rhs.first && lhs.relevant_fact_keys_->keys_ == rhs.second; }
+		bool operator()(const CacheKey& lhs, const CacheLookupKey& rhs) const { return (*this)(rhs, lhs); }
+	};
+	
+	typedef boost::unordered_map<CacheKey, CachedSolutions*, CacheKeyHash, CacheKeyEqual> Cache;
+	Cache cache_;
+	
+	unsigned int nr_cached_solutions_;
+	
+	// The number of times a solution was found in the cache and the number of searches performed because it was not.
+	unsigned int cache_hits_;
+	unsigned int cache_misses_;
+	
+	// The maximum number of solutions to store.
+	static const unsigned int MAX_CACHED_SOLUTIONS = 100000;
 };
 
 };
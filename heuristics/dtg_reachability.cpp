@@ -1,7 +1,10 @@
 #include <cstring>
+#include <algorithm>
 #include <iterator>
 #include <sys/time.h>
 #include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/tss.hpp>
 #include <queue>
 
 #include "formula.h"
@@ -66,8 +69,172 @@ bool doVariableDomainsOverlap(const std::vector<const Object*>& set1, const std:
 }
 
 namespace REACHABILITY {
+
+/**
+ * The reachable facts, fact layers and achieving transitions which are created and deleted by the thread which evaluates
+ * the heuristic. They are allocated from memory pools owned by that thread, so the memory released at the start of a
+ * heuristic evaluation is reused by the next one instead of being handed back to the heap.
+ */
+struct ThreadMemory
+{
+	ThreadMemory();
+	~ThreadMemory();
+	
+	void addReachableFact(ReachableFact& reachable_fact);
+	
+	/**
+	 * @return The reachable facts whose predicate has the same name as @param predicate.
+	 */
+	std::vector<ReachableFact*>& getReachableFacts(const Predicate& predicate);
+	
+	/**
+	 * Remove all the reachable facts, except those in @param facts_to_keep.
+	 */
+	void removeReachableFacts(const boost::unordered_set<const ReachableFact*>& facts_to_keep);
+	
+	/**
+	 * Remove all the reachable facts at once, their memory pool is reset rather than freed fact by fact.
+	 */
+	void removeAllReachableFacts();
+	
+	std::vector<ReachableFact*> reachable_facts_;
+	
+	// The reachable facts indexed by the name id of their predicate.
+	std::vector<std::vector<ReachableFact*> > reachable_facts_by_name_;
+	
+	std::vector<AchievingTransition*> achieving_transitions_;
+	
+	// The reachable facts and their terms, by arity.
+	UTILITY::SizeClassMemoryPool reachable_fact_memory_;
+	
+	// All achieving transitions are deleted at once, so their memory pool is reset rather than freed unit by unit.
+	UTILITY::MemoryPool achieving_transition_memory_;
+	
+	// The fact layers and their items.
+	UTILITY::SizeClassMemoryPool fact_layer_memory_;
+	
+	// The number of leaves considered by ReachableTransition::generateReachableFacts and how many of those were part of
+	// the delta, only updated if DTG_REACHABILITY_KEEP_TIME is defined.
+	unsigned int total_leaves_;
+	unsigned int delta_leaves_;
+	
+	// The largest number of units allocated at once by the memory pools.
+	static const unsigned int MAX_UNITS_PER_CHUNK = 4096;
+};
+
+ThreadMemory::ThreadMemory()
+	: reachable_fact_memory_(MAX_UNITS_PER_CHUNK), achieving_transition_memory_(sizeof(AchievingTransition), MAX_UNITS_PER_CHUNK), fact_layer_memory_(MAX_UNITS_PER_CHUNK), total_leaves_(0), delta_leaves_(0)
+{
+
+}
+
+ThreadMemory::~ThreadMemory()
+{
+	// The achieving transitions own memory on the heap, the reachable facts and their terms only live in the memory pools.
+	for (std::vector<AchievingTransition*>::const_iterator ci = achieving_transitions_.begin(); ci != achieving_transitions_.end(); ++ci)
+	{
+		(*ci)->~AchievingTransition();
+	}
+}
+
+void ThreadMemory::addReachableFact(ReachableFact& reachable_fact)
+{
+	reachable_facts_.push_back(&reachable_fact);
+	getReachableFacts(reachable_fact.getPredicate()).push_back(&reachable_fact);
+}
+
+std::vector<ReachableFact*>& ThreadMemory::getReachableFacts(const Predicate& predicate)
+{
+	if (predicate.getNameId() >= reachable_facts_by_name_.size())
+	{
+		reachable_facts_by_name_.resize(predicate.getNameId() + 1);
+	}
+	return reachable_facts_by_name_[predicate.getNameId()];
+}
+
+void ThreadMemory::removeReachableFacts(const boost::unordered_set<const ReachableFact*>& facts_to_keep)
+{
+	for (std::vector<std::vector<ReachableFact*> >::iterator i = reachable_facts_by_name_.begin(); i != reachable_facts_by_name_.end(); ++i)
+	{
+		(*i).clear();
+	}
+	
+	// Compact the facts which are kept at the front, preserving their order.
+	std::vector<ReachableFact*>::iterator last_kept = reachable_facts_.begin();
+	for (std::vector<ReachableFact*>::const_iterator ci = reachable_facts_.begin(); ci != reachable_facts_.end(); ++ci)
+	{
+		if (facts_to_keep.count(*ci) != 0)
+		{
+			*last_kept = *ci;
+			++last_kept;
+			getReachableFacts((*ci)->getPredicate()).push_back(*ci);
+		}
+		else
+		{
+			ReachableFact::destroy(**ci);
+		}
+	}
+	reachable_facts_.erase(last_kept, reachable_facts_.end());
 	
-std::vector<ReachableFact*> ReachableFact::all_created_reachable_facts_;
+	if (reachable_facts_.empty())
+	{
+		reachable_fact_memory_.reset();
+	}
+}
+
+void ThreadMemory::removeAllReachableFacts()
+{
+	// The destructor of a reachable fact is trivial, so there is nothing to do for each fact.
+	reachable_facts_.clear();
+	for (std::vector<std::vector<ReachableFact*> >::iterator i = reachable_facts_by_name_.begin(); i != reachable_facts_by_name_.end(); ++i)
+	{
+		(*i).clear();
+	}
+	reachable_fact_memory_.reset();
+}
+
+std::ostream& operator<<(std::ostream& os, const ThreadMemory& thread_memory)
+{
+	UTILITY::MemoryPoolStatistics reachable_fact_statistics;
+	thread_memory.reachable_fact_memory_.getStatistics(reachable_fact_statistics);
+	UTILITY::MemoryPoolStatistics fact_layer_statistics;
+	thread_memory.fact_layer_memory_.getStatistics(fact_layer_statistics);
+	
+	os << "Reachable facts: " << reachable_fact_statistics << std::endl;
+	os << "Achieving transitions: " << thread_memory.achieving_transition_memory_.getStatistics() << std::endl;
+	os << "Fact layers: " << fact_layer_statistics << std::endl;
+	return os;
+}
+
+static boost::thread_specific_ptr<ThreadMemory> g_thread_memory;
+
+static ThreadMemory& getThreadMemory()
+{
+	ThreadMemory* thread_memory = g_thread_memory.get();
+	if (thread_memory == NULL)
+	{
+		thread_memory = new ThreadMemory();
+		g_thread_memory.reset(thread_memory);
+	}
+	return *thread_memory;
+}
+
+void* ReachableFact::operator new (size_t size, unsigned int arity)
+{
+	return getThreadMemory().reachable_fact_memory_.allocate(size + arity * sizeof(EquivalentObjectGroup*));
+}
+
+void ReachableFact::operator delete (void* p, unsigned int arity)
+{
+	getThreadMemory().reachable_fact_memory_.free(p, sizeof(ReachableFact) + arity * sizeof(EquivalentObjectGroup*));
+}
+
+void ReachableFact::destroy(ReachableFact& reachable_fact)
+{
+	unsigned int arity = reachable_fact.predicate_->getArity();
+	reachable_fact.~ReachableFact();
+	ReachableFact::operator delete(&reachable_fact, arity);
+}
 
 /*ReachableFact& ReachableFact::createReachableFact(const SAS_Plus::BoundedAtom& bounded_atom, const Bindings& bindings, const EquivalentObjectGroupManager& eog_manager)
 {
@@ -76,15 +243,16 @@ std::vector<ReachableFact*> ReachableFact::all_created_reachable_facts_;
 	return *reachable_fact;
 }*/
 	
-ReachableFact& ReachableFact::createReachableFact(const Predicate& predicate, std::vector<EquivalentObjectGroup*>& term_domain_mapping, bool allow_reuse)
+ReachableFact& ReachableFact::createReachableFact(const Predicate& predicate, const std::vector<EquivalentObjectGroup*>& term_domain_mapping, bool allow_reuse)
 {
 	if (allow_reuse)
 	{
-		for (std::vector<ReachableFact*>::const_iterator ci = all_created_reachable_facts_.begin(); ci != all_created_reachable_facts_.end(); ++ci)
+		const std::vector<ReachableFact*>& candidates = getThreadMemory().getReachableFacts(predicate);
+		for (std::vector<ReachableFact*>::const_iterator ci = candidates.begin(); ci != candidates.end(); ++ci)
 		{
 			ReachableFact* rf = *ci;
 			
-			if (predicate.getArity() != rf->getPredicate().getArity() || predicate.getName() != rf->getPredicate().getName())
+			if (predicate.getArity() != rf->getPredicate().getArity())
 			{
 				continue;
 			}
@@ -110,8 +278,8 @@ ReachableFact& ReachableFact::createReachableFact(const Predicate& predicate, st
 		}
 	}
 	
-	ReachableFact* reachable_fact = new ReachableFact(predicate, term_domain_mapping);
-	all_created_reachable_facts_.push_back(reachable_fact);
+	ReachableFact* reachable_fact = new (predicate.getArity()) ReachableFact(predicate, term_domain_mapping);
+	getThreadMemory().addReachableFact(*reachable_fact);
 	return *reachable_fact;
 }
 
@@ -119,11 +287,12 @@ ReachableFact& ReachableFact::createReachableFact(const GroundedAtom& grounded_a
 {
 	if (allow_reuse)
 	{
-		for (std::vector<ReachableFact*>::const_iterator ci = all_created_reachable_facts_.begin(); ci != all_created_reachable_facts_.end(); ++ci)
+		const std::vector<ReachableFact*>& candidates = getThreadMemory().getReachableFacts(grounded_atom.getPredicate());
+		for (std::vector<ReachableFact*>::const_iterator ci = candidates.begin(); ci != candidates.end(); ++ci)
 		{
 			ReachableFact* rf = *ci;
 			
-			if (grounded_atom.getPredicate().getArity() != rf->getPredicate().getArity() || grounded_atom.getPredicate().getName() != rf->getPredicate().getName())
+			if (grounded_atom.getPredicate().getArity() != rf->getPredicate().getArity())
 			{
 				continue;
 			}
@@ -149,37 +318,27 @@ ReachableFact& ReachableFact::createReachableFact(const GroundedAtom& grounded_a
 		}
 	}
 	
-	ReachableFact* reachable_fact = new ReachableFact(grounded_atom, eog_manager);
-	all_created_reachable_facts_.push_back(reachable_fact);
+	ReachableFact* reachable_fact = new (grounded_atom.getPredicate().getArity()) ReachableFact(grounded_atom, eog_manager);
+	getThreadMemory().addReachableFact(*reachable_fact);
 	return *reachable_fact;
 }
 
 ReachableFact& ReachableFact::createReachableFact(const ReachableFact& other)
 {
-	ReachableFact* reachable_fact = new ReachableFact(other);
-	all_created_reachable_facts_.push_back(reachable_fact);
+	ReachableFact* reachable_fact = new (other.getPredicate().getArity()) ReachableFact(other);
+	getThreadMemory().addReachableFact(*reachable_fact);
 	return *reachable_fact;
 }
 
 void ReachableFact::deleteAllReachableFacts(const std::vector<REACHABILITY::ReachableFact*>& initial_facts)
 {
-	for (std::vector<ReachableFact*>::reverse_iterator ri = all_created_reachable_facts_.rbegin(); ri != all_created_reachable_facts_.rend(); ++ri)
-	{
-		if (std::find(initial_facts.begin(), initial_facts.end(), *ri) == initial_facts.end())
-		{
-			delete *ri;
-			all_created_reachable_facts_.erase(ri.base() - 1);
-		}
-	}
+	boost::unordered_set<const ReachableFact*> facts_to_keep(initial_facts.begin(), initial_facts.end());
+	getThreadMemory().removeReachableFacts(facts_to_keep);
 }
 
 void ReachableFact::deleteAllReachableFacts()
 {
-	for (std::vector<ReachableFact*>::const_iterator ci = all_created_reachable_facts_.begin(); ci != all_created_reachable_facts_.end(); ++ci)
-	{
-		delete *ci;
-	}
-	all_created_reachable_facts_.clear();
+	getThreadMemory().removeAllReachableFacts();
 }
 
 
@@ -212,10 +371,11 @@ void ReachableFact::deleteAllReachableFacts()
 	assert (term_domain_mapping_->size() == bounded_atom.getAtom().getArity());
 }*/
 
-ReachableFact::ReachableFact(const Predicate& predicate, std::vector<EquivalentObjectGroup*>& term_domain_mapping)
-	: predicate_(&predicate), term_domain_mapping_(&term_domain_mapping), replaced_by_(NULL)
+ReachableFact::ReachableFact(const Predicate& predicate, const std::vector<EquivalentObjectGroup*>& term_domain_mapping)
+	: predicate_(&predicate), term_domain_mapping_(reinterpret_cast<EquivalentObjectGroup**>(this + 1)), replaced_by_(NULL)
 {
 	assert (term_domain_mapping.size() == predicate.getArity());
+	std::copy(term_domain_mapping.begin(), term_domain_mapping.end(), term_domain_mapping_);
 }
 /*
 ReachableFact::ReachableFact(const Atom& atom, EquivalentObjectGroup** term_domain_mapping)
@@ -232,55 +392,29 @@ ReachableFact::ReachableFact(const Atom& atom, EquivalentObjectGroup** term_doma
 }
 */
 ReachableFact::ReachableFact(const GroundedAtom& grounded_atom, const EquivalentObjectGroupManager& eog_manager)
-	: predicate_(&grounded_atom.getPredicate()), replaced_by_(NULL)
+	: predicate_(&grounded_atom.getPredicate()), term_domain_mapping_(reinterpret_cast<EquivalentObjectGroup**>(this + 1)), replaced_by_(NULL)
 {
-//	term_domain_mapping_ = EquivalentObjectGroup::allocateMemory(grounded_atom.getAtom().getArity());
-	term_domain_mapping_ = new std::vector<EquivalentObjectGroup*>(grounded_atom.getPredicate().getArity());
 	for (unsigned int i = 0; i < grounded_atom.getPredicate().getArity(); i++)
 	{
-//		term_domain_mapping_[i] = &eog_manager.getEquivalentObject(grounded_atom.getObject(i)).getEquivalentObjectGroup();
-		(*term_domain_mapping_)[i] = &eog_manager.getEquivalentObject(grounded_atom.getObject(i)).getEquivalentObjectGroup();
-		//term_domain_mapping_.push_back(&eog_manager.getEquivalentObject(grounded_atom.getObject(i)).getEquivalentObjectGroup());
+		term_domain_mapping_[i] = &eog_manager.getEquivalentObject(grounded_atom.getObject(i)).getEquivalentObjectGroup();
 	}
 }
 
 ReachableFact::ReachableFact(const ReachableFact& reachable_fact)
-	: predicate_(&reachable_fact.getPredicate()), replaced_by_(NULL)
-{
-//	term_domain_mapping_ = EquivalentObjectGroup::allocateMemory(reachable_fact.atom_->getArity());
-	term_domain_mapping_ = new std::vector<EquivalentObjectGroup*>(reachable_fact.predicate_->getArity());
-	for (unsigned int i = 0; i < reachable_fact.predicate_->getArity(); i++)
-	{
-//		term_domain_mapping_[i] = reachable_fact.term_domain_mapping_[i];
-		(*term_domain_mapping_)[i] = (*reachable_fact.term_domain_mapping_)[i];
-		//term_domain_mapping_.push_back(reachable_fact.term_domain_mapping_[i]);
-	}
-}
-
-ReachableFact::~ReachableFact()
+	: predicate_(&reachable_fact.getPredicate()), term_domain_mapping_(reinterpret_cast<EquivalentObjectGroup**>(this + 1)), replaced_by_(NULL)
 {
-	delete term_domain_mapping_;
+	std::copy(reachable_fact.term_domain_mapping_, reachable_fact.term_domain_mapping_ + reachable_fact.predicate_->getArity(), term_domain_mapping_);
 }
 
-/*void* ReachableFact::operator new (size_t size)
-{
-	return g_reachable_fact_memory_pool->allocate(size);
-}
-	
-void ReachableFact::operator delete (void* p)
-{
-	g_reachable_fact_memory_pool->free(p);
-}*/
-
 bool ReachableFact::updateTermsToRoot()
 {
 	bool updated_domain = false;
 	for (unsigned int i = 0; i < predicate_->getArity(); i++)
 	{
-		EquivalentObjectGroup& root_node = (*term_domain_mapping_)[i]->getRootNode();
-		if (&root_node != (*term_domain_mapping_)[i])
+		EquivalentObjectGroup& root_node = term_domain_mapping_[i]->getRootNode();
+		if (&root_node != term_domain_mapping_[i])
 		{
-			(*term_domain_mapping_)[i] = &root_node;
+			term_domain_mapping_[i] = &root_node;
 			updated_domain = true;
 		}
 	}
@@ -304,18 +438,18 @@ bool ReachableFact::isEquivalentTo(const ReachableFact& other, const EquivalentO
 	
 	for (unsigned int i = 0; i < predicate_->getArity(); i++)
 	{
-//		if (!(*term_domain_mapping_)[i]->isGrounded() && (*term_domain_mapping_)[i]->isPartOfAPropertyState())
-		if ((*term_domain_mapping_)[i] == &variant_eog)
+//		if (!term_domain_mapping_[i]->isGrounded() && term_domain_mapping_[i]->isPartOfAPropertyState())
+		if (term_domain_mapping_[i] == &variant_eog)
 		{
 			// Make sure the types match up.
-			if (!(*term_domain_mapping_)[i]->hasSameFingerPrint(*(*other.term_domain_mapping_)[i]))
+			if (!term_domain_mapping_[i]->hasSameFingerPrint(*other.term_domain_mapping_[i]))
 			{
 //				std::cout << "The " << i << "th term does not have the same fingerprint!" << std::endl;
 				return false;
 			}
 		}
 
-		else if (!(*term_domain_mapping_)[i]->isIdenticalTo(*(*other.term_domain_mapping_)[i]))
+		else if (!term_domain_mapping_[i]->isIdenticalTo(*other.term_domain_mapping_[i]))
 		{
 //			std::cout << "The " << i << "th term is at odds!" << std::endl;
 			return false;
@@ -331,18 +465,18 @@ bool ReachableFact::isIdenticalTo(const ReachableFact& other) const
 		return false;
 	}
 	
-	if (predicate_->getName() != other.predicate_->getName())
+	if (predicate_->getNameId() != other.predicate_->getNameId())
 	{
 		return false;
 	}
 	
 	for (unsigned int i = 0; i < predicate_->getArity(); i++)
 	{
-//		if (&(*term_domain_mapping_)[i]->getRootNode() != &(*other.term_domain_mapping_)[i]->getRootNode())
-		if ((*term_domain_mapping_)[i] != (*other.term_domain_mapping_)[i])
+//		if (&term_domain_mapping_[i]->getRootNode() != &other.term_domain_mapping_[i]->getRootNode())
+		if (term_domain_mapping_[i] != other.term_domain_mapping_[i])
 		{
 #ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_DEBUG
-			if ((*term_domain_mapping_)[i]->isIdenticalTo(*(*other.term_domain_mapping_)[i]))
+			if (term_domain_mapping_[i]->isIdenticalTo(*other.term_domain_mapping_[i]))
 			{
 				std::cerr << "Could not check if " << *this << " is equivalent to " << other << std::endl;
 				std::cerr << "WRONG!" << std::endl;
@@ -353,7 +487,7 @@ bool ReachableFact::isIdenticalTo(const ReachableFact& other) const
 		}
 		
 #ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_DEBUG
-		if (!(*term_domain_mapping_)[i]->isIdenticalTo(*(*other.term_domain_mapping_)[i]))
+		if (!term_domain_mapping_[i]->isIdenticalTo(*other.term_domain_mapping_[i]))
 		{
 			std::cerr << "WRONG!" << std::endl;
 			exit(1);
@@ -366,7 +500,7 @@ bool ReachableFact::isIdenticalTo(const ReachableFact& other) const
 EquivalentObjectGroup& ReachableFact::getTermDomain(unsigned int index) const
 {
 	assert (index < predicate_->getArity());
-	EquivalentObjectGroup* eog = (*term_domain_mapping_)[index];
+	EquivalentObjectGroup* eog = term_domain_mapping_[index];
 	assert (eog != NULL);
 	return *eog;
 }
@@ -422,8 +556,8 @@ void ReachableFact::print(std::ostream& os, unsigned int iteration) const
 	for (unsigned int i = 0; i < predicate_->getArity(); i++)
 	{
 		os << "{";
-		(*term_domain_mapping_)[i]->printObjects(os, iteration);
-//		os << "(" << (*term_domain_mapping_)[i] << ")";
+		term_domain_mapping_[i]->printObjects(os, iteration);
+//		os << "(" << term_domain_mapping_[i] << ")";
 		os << "}";
 		if (i + 1 != predicate_->getArity())
 		{
@@ -437,7 +571,7 @@ std::ostream& operator<<(std::ostream& os, const ReachableFact& reachable_fact)
 	os << "Reachable fact: (" << reachable_fact.getPredicate().getName() << "[" << reachable_fact.getPredicate() << "] ";
 	for (unsigned int i = 0; i < reachable_fact.getPredicate().getArity(); i++)
 	{
-		const std::vector<EquivalentObject*>& objects = (*reachable_fact.term_domain_mapping_)[i]->getEquivalentObjects();
+		const std::vector<EquivalentObject*>& objects = reachable_fact.term_domain_mapping_[i]->getEquivalentObjects();
 		os << "{";
 		for (std::vector<EquivalentObject*>::const_iterator ci = objects.begin(); ci != objects.end(); ci++)
 		{
@@ -554,7 +688,7 @@ bool ResolvedBoundedAtom::canUnifyWith(const ResolvedBoundedAtom& other) const
 //	if (!corrected_atom_->getPredicate().canSubstitute(other.getCorrectedAtom().getPredicate())) return false;
 //	if (!other.atom_->getPredicate().canSubstitute(getAtom().getPredicate())) return false;
 	
-	if (atom_->getPredicate().getName() != other.atom_->getPredicate().getName()) return false;
+	if (atom_->getPredicate().getNameId() != other.atom_->getPredicate().getNameId()) return false;
 	if (atom_->getArity() != other.atom_->getArity()) return false;
 	
 	for (unsigned int i = 0; i < atom_->getArity(); i++)
@@ -1016,6 +1150,7 @@ ReachableSet::ReachableSet(const EquivalentObjectGroupManager& eog_manager, cons
 	for (std::vector<const HEURISTICS::TransitionFact*>::const_iterator ci = fact_set.getFacts().begin(); ci != fact_set.getFacts().end(); ++ci)
 	{
 		reachable_set_.push_back(new std::list<ReachableFact*>());
+		reachable_set_index_.push_back(new boost::unordered_multimap<std::size_t, ReachableFact*>());
 	}
 	
 //	std::cout << *this << std::endl;
@@ -1032,6 +1167,10 @@ void ReachableSet::reset()
 	{
 		(*ci)->clear();
 	}
+	for (std::vector<boost::unordered_multimap<std::size_t, ReachableFact*>* >::const_iterator ci = reachable_set_index_.begin(); ci != reachable_set_index_.end(); ci++)
+	{
+		(*ci)->clear();
+	}
 
 	cache_is_valid_ = false;
 //	std::cout << "Reset cache!" << std::endl;
@@ -1045,6 +1184,10 @@ ReachableSet::~ReachableSet()
 		std::list<ReachableFact*>* reachable_list = *ci;
 		delete reachable_list;
 	}
+	for (std::vector<boost::unordered_multimap<std::size_t, ReachableFact*>* >::const_iterator ci = reachable_set_index_.begin(); ci != reachable_set_index_.end(); ci++)
+	{
+		delete *ci;
+	}
 /*
 	for (std::vector<std::vector<std::pair<unsigned int, unsigned int> >** >::const_iterator ci = constraints_set_.begin(); ci != constraints_set_.end(); ci++)
 	{
@@ -1205,6 +1348,9 @@ void ReachableSet::equivalencesUpdated(unsigned int iteration)
 		reachable_set->remove_if(boost::bind(&ReachableFact::isMarkedForRemoval, _1));
 	}
 	
+	// The terms of the remaining facts have been updated to the new root nodes.
+	rebuildIndex();
+	
 	for (std::vector<ReachableTree*>::reverse_iterator ri = reachability_tree_.rbegin(); ri != reachability_tree_.rend(); ri++)
 	{
 		ReachableTree* reachable_tree = *ri;
@@ -1302,6 +1448,30 @@ bool ReachableSet::canSatisfyConstraints(const ReachableFact& reachable_fact, st
 	return true;
 }
 */
+std::size_t ReachableSet::getKey(const ReachableFact& reachable_fact)
+{
+	// All the facts of a set have the same predicate, so only the term domains have to be considered.
+	std::size_t key = 0;
+	for (unsigned int i = 0; i < reachable_fact.getPredicate().getArity(); ++i)
+	{
+		boost::hash_combine(key, &reachable_fact.getTermDomain(i));
+	}
+	return key;
+}
+
+void ReachableSet::rebuildIndex()
+{
+	for (unsigned int index = 0; index < reachable_set_.size(); ++index)
+	{
+		boost::unordered_multimap<std::size_t, ReachableFact*>* reachable_set_index = reachable_set_index_[index];
+		reachable_set_index->clear();
+		for (std::list<ReachableFact*>::const_iterator ci = reachable_set_[index]->begin(); ci != reachable_set_[index]->end(); ++ci)
+		{
+			reachable_set_index->insert(std::make_pair(getKey(**ci), *ci));
+		}
+	}
+}
+
 bool ReachableSet::processNewReachableFact(ReachableFact& reachable_fact, unsigned int index)
 {
 	const HEURISTICS::TransitionFact* fact = fact_set_->getFacts()[index];
@@ -1315,7 +1485,7 @@ bool ReachableSet::processNewReachableFact(ReachableFact& reachable_fact, unsign
 #endif
 	
 	// Check if it can be added.
-	if (reachable_fact.getPredicate().getName() != fact->getPredicate().getName() ||
+	if (reachable_fact.getPredicate().getNameId() != fact->getPredicate().getNameId() ||
 	    reachable_fact.getPredicate().getArity() != fact->getPredicate().getArity())
 	{
 #ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_COMMENT
@@ -1357,9 +1527,11 @@ bool ReachableSet::processNewReachableFact(ReachableFact& reachable_fact, unsign
 		}
 	}
 	
-	for (std::list<ReachableFact*>::const_iterator ci = reachable_set_[index]->begin(); ci != reachable_set_[index]->end(); ++ci)
+	std::size_t key = getKey(reachable_fact);
+	std::pair<boost::unordered_multimap<std::size_t, ReachableFact*>::const_iterator, boost::unordered_multimap<std::size_t, ReachableFact*>::const_iterator> candidates = reachable_set_index_[index]->equal_range(key);
+	for (boost::unordered_multimap<std::size_t, ReachableFact*>::const_iterator ci = candidates.first; ci != candidates.second; ++ci)
 	{
-		const ReachableFact* existing_fact = *ci;
+		const ReachableFact* existing_fact = (*ci).second;
 		if (reachable_fact.isIdenticalTo(*existing_fact))
 		{
 #ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_COMMENT
@@ -1369,6 +1541,7 @@ bool ReachableSet::processNewReachableFact(ReachableFact& reachable_fact, unsign
 		}
 	}
 	reachable_set_[index]->push_back(&reachable_fact);
+	reachable_set_index_[index]->insert(std::make_pair(key, &reachable_fact));
 	
 #ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_COMMENT
 	std::cout << "[ReachableSet::processNewReachableFact] " << reachable_fact << " ; index = " << index << std::endl;
@@ -1417,7 +1590,10 @@ std::ostream& operator<<(std::ostream& os, const ReachableSet& reachable_set)
 	return os;
 }
 
-std::vector<const AchievingTransition*> AchievingTransition::all_created_achieving_transitions_;
+std::vector<AchievingTransition*>& AchievingTransition::getAllCreatedAchievingTransitions()
+{
+	return getThreadMemory().achieving_transitions_;
+}
 
 /*
 AchievingTransition::AchievingTransition(unsigned int effect_index, unsigned int effect_set_index, const std::vector< const MyPOP::REACHABILITY::ReachableFact* >& preconditions, MyPOP::REACHABILITY::ReachableFact& fact, const MyPOP::REACHABILITY::ReachableTransition& achiever, const std::vector<HEURISTICS::VariableDomain*>& variable_assignments, const ReachableFactLayer& fact_layer)
@@ -1652,7 +1828,7 @@ std::pair<unsigned int, unsigned int> AchievingTransition::getEffectIndexAchievi
 			const HEURISTICS::TransitionFact* effect = *ci;
 
 			if (effect->getPredicate().getArity() != reachable_fact.getReachableFactCopy().getPredicate().getArity() ||
-			    effect->getPredicate().getName() != reachable_fact.getReachableFactCopy().getPredicate().getName())
+			    effect->getPredicate().getNameId() != reachable_fact.getReachableFactCopy().getPredicate().getNameId())
 			{
 				continue;
 			}
@@ -1726,7 +1902,7 @@ std::pair<unsigned int, unsigned int> AchievingTransition::getEffectIndexAchievi
 			const HEURISTICS::TransitionFact* effect = *ci;
 
 			if (effect->getPredicate().getArity() != reachable_fact.getReachableFactCopy().getPredicate().getArity() ||
-			    effect->getPredicate().getName() != reachable_fact.getReachableFactCopy().getPredicate().getName())
+			    effect->getPredicate().getNameId() != reachable_fact.getReachableFactCopy().getPredicate().getNameId())
 			{
 				continue;
 			}
@@ -1903,18 +2079,23 @@ AchievingTransition::~AchievingTransition()
 	delete preconditions_;
 }
 
-void AchievingTransition::removeAllAchievingTransitions()
+AchievingTransition& AchievingTransition::createAchievingTransition(unsigned int fact_layer_index, const ReachableTransition* achiever, const std::vector<const ReachableFactLayerItem*>& preconditions, const std::vector<EquivalentObjectGroup*>& variables)
 {
-	for (std::vector<const AchievingTransition*>::const_iterator ci = all_created_achieving_transitions_.begin(); ci != all_created_achieving_transitions_.end(); ++ci)
-	{
-		delete *ci;
-	}
-	all_created_achieving_transitions_.clear();
+	void* memory = getThreadMemory().achieving_transition_memory_.allocate(sizeof(AchievingTransition));
+	AchievingTransition* achieving_transition = new (memory) AchievingTransition(fact_layer_index, achiever, preconditions, variables);
+	getAllCreatedAchievingTransitions().push_back(achieving_transition);
+	return *achieving_transition;
 }
 
-void AchievingTransition::storeAchievingTransition(const AchievingTransition& achieving_transition)
+void AchievingTransition::removeAllAchievingTransitions()
 {
-	all_created_achieving_transitions_.push_back(&achieving_transition);
+	std::vector<AchievingTransition*>& all_created_achieving_transitions = getAllCreatedAchievingTransitions();
+	for (std::vector<AchievingTransition*>::const_iterator ci = all_created_achieving_transitions.begin(); ci != all_created_achieving_transitions.end(); ++ci)
+	{
+		(*ci)->~AchievingTransition();
+	}
+	all_created_achieving_transitions.clear();
+	getThreadMemory().achieving_transition_memory_.reset();
 }
 
 void AchievingTransition::addEffect(const ReachableFactLayerItem& effect, unsigned int effect_set_index, unsigned int effect_index)
@@ -2122,6 +2303,7 @@ void ReachableTransition::reset()
 		delete *ci;
 	}
 	processed_groups_.clear();
+	processed_groups_index_.clear();
 }
 
 unsigned int ReachableTransition::finalise(const std::vector<ReachableSet*>& all_reachable_sets)
@@ -2170,690 +2352,942 @@ unsigned int ReachableTransition::finalise(const std::vector<ReachableSet*>& all
 	return bindings;
 }
 
-bool ReachableTransition::generateReachableFacts(const EquivalentObjectGroupManager& eog_manager, ReachableFactLayer& fact_layer, const std::vector<const ReachableFact*>& persistent_facts)
+PersistentFactIndex::PersistentFactIndex(const std::vector<const ReachableFact*>& persistent_facts)
 {
-	assert (fact_layer.getPreviousLayer() != NULL);
-//#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
-	//std::cout << "[ReachableTransition::generateReachableFacts] " << *this << std::endl;
-/*
-	std::cout << "Cached tree sizes: " << std::endl;
-	for (std::vector<ReachableSet*>::const_iterator ci = preconditions_reachable_sets_->begin(); ci != preconditions_reachable_sets_->end(); ++ci)
+	for (std::vector<const ReachableFact*>::const_iterator ci = persistent_facts.begin(); ci != persistent_facts.end(); ++ci)
 	{
-		std::cout << " === PRECONDITION === " << std::endl;
-		ReachableSet* reachable_set = *ci;
-		std::cout << *reachable_set << std::endl;
-		std::cout << "Trees(" << reachable_set->getReachableTrees().size() << " - cached" << reachable_set->getCachedReachableTreesSize() << "): " << std::endl;
-		for (std::vector<ReachableTree*>::const_iterator ci = reachable_set->getReachableTrees().begin(); ci != reachable_set->getReachableTrees().end(); ++ci)
+		const ReachableFact* persistent_fact = *ci;
+		std::size_t key = boost::hash<unsigned int>()(persistent_fact->getPredicate().getNameId());
+		for (unsigned int term_index = 0; term_index < persistent_fact->getPredicate().getArity(); ++term_index)
 		{
-			std::cout << **ci << std::endl;
+			boost::hash_combine(key, &persistent_fact->getTermDomain(term_index));
 		}
-		std::cout << " =*= PRECONDITION =*= " << std::endl;
+		persistent_facts_.insert(std::make_pair(key, persistent_fact));
 	}
-*/
-//#endif
-
-	std::vector<EquivalentObjectGroup*> variable_assignments(transition_->getAction().getVariables().size(), NULL);
-	std::vector<const ReachableFact*> preconditions;
-	//std::vector<const AchievingTransition*> newly_created_reachable_facts;
-	//generateReachableFacts(eog_manager, newly_created_reachable_facts, preconditions, variable_assignments, 0, *fact_layer.getPreviousLayer());
-	return generateReachableFacts(eog_manager, preconditions, variable_assignments, 0, fact_layer, persistent_facts);
 }
 
-/*
-bool ReachableTransition::generateReachableFacts(const EquivalentObjectGroupManager& eog_manager, ReachableFactLayer& fact_layer, const std::vector<const ReachableFact*>& persistent_facts)
+bool PersistentFactIndex::isDeletedBy(const Action& action, const std::vector<EquivalentObjectGroup*>& variable_assignments) const
 {
-	assert (fact_layer.getPreviousLayer() != NULL);
-#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
-	std::cout << "[ReachableTransition::generateReachableFacts] " << *this << std::endl << "Cached tree sizes: " << std::endl;
-	for (std::vector<ReachableSet*>::const_iterator ci = preconditions_reachable_sets_->begin(); ci != preconditions_reachable_sets_->end(); ++ci)
+	if (persistent_facts_.empty())
 	{
-		std::cout << " === PRECONDITION === " << std::endl;
-		ReachableSet* reachable_set = *ci;
-		std::cout << *reachable_set << std::endl;
-		std::cout << "Trees(" << reachable_set->getReachableTrees().size() << " - cached" << reachable_set->getCachedReachableTreesSize() << "): " << std::endl;
-		for (std::vector<ReachableTree*>::const_iterator ci = reachable_set->getReachableTrees().begin(); ci != reachable_set->getReachableTrees().end(); ++ci)
-		{
-			std::cout << **ci << std::endl;
-		}
-		std::cout << " =*= PRECONDITION =*= " << std::endl;
+		return false;
 	}
-#endif
-
-	std::vector<EquivalentObjectGroup*> variable_assignments(transition_->getAction().getVariables().size(), NULL);
-	std::vector<const ReachableFact*> preconditions;
-	std::vector<const AchievingTransition*> newly_created_reachable_facts;
-	generateReachableFacts(eog_manager, newly_created_reachable_facts, preconditions, variable_assignments, 0, *fact_layer.getPreviousLayer());
-
-	bool new_facts_reached = false;
-	for (std::vector<const AchievingTransition*>::const_iterator ci = newly_created_reachable_facts.begin(); ci != newly_created_reachable_facts.end(); ++ci)
+	
+	for (std::vector<const Atom*>::const_iterator ci = action.getEffects().begin(); ci != action.getEffects().end(); ++ci)
 	{
-		const AchievingTransition* created_effect = *ci;
-
-		// Check if this action removes a fact we want to preserve.
-		bool deletes_persistent_node = false;
-		for (std::vector<const Atom*>::const_iterator ci = created_effect->getAchiever()->getTransition().getAction().getEffects().begin(); ci != created_effect->getAchiever()->getTransition().getAction().getEffects().end(); ++ci)
+		const Atom* effect = *ci;
+		if (!effect->isNegative())
 		{
-			const Atom* effect = *ci;
-			if (!effect->isNegative())
+			continue;
+		}
+		
+		// A term which is not bound by the preconditions cannot match a term of a persistent fact.
+		bool all_terms_bound = true;
+		std::size_t key = boost::hash<unsigned int>()(effect->getPredicate().getNameId());
+		for (unsigned int term_index = 0; term_index < effect->getArity(); ++term_index)
+		{
+			const EquivalentObjectGroup* effect_term_eog = variable_assignments[action.getActionVariable(*effect->getTerms()[term_index])];
+			if (effect_term_eog == NULL)
+			{
+				all_terms_bound = false;
+				break;
+			}
+			boost::hash_combine(key, effect_term_eog);
+		}
+		
+		if (!all_terms_bound)
+		{
+			continue;
+		}
+		
+		std::pair<boost::unordered_multimap<std::size_t, const ReachableFact*>::const_iterator, boost::unordered_multimap<std::size_t, const ReachableFact*>::const_iterator> candidates = persistent_facts_.equal_range(key);
+		for (boost::unordered_multimap<std::size_t, const ReachableFact*>::const_iterator ci = candidates.first; ci != candidates.second; ++ci)
+		{
+			const ReachableFact* persistent_fact = (*ci).second;
+			if (effect->getArity() != persistent_fact->getPredicate().getArity() ||
+			    effect->getPredicate().getNameId() != persistent_fact->getPredicate().getNameId())
 			{
 				continue;
 			}
 			
-			// Figure out the mapping from the index of the effects to the 
-			unsigned int effect_index = std::distance(created_effect->getAchiever()->getTransition().getAction().getEffects().begin(), ci);
-			
-			for (std::vector<const ReachableFact*>::const_iterator ci = persistent_facts.begin(); ci != persistent_facts.end(); ++ci)
+			bool terms_match = true;
+			for (unsigned int term_index = 0; term_index < effect->getArity(); ++term_index)
 			{
-				const ReachableFact* reachable_fact = *ci;
-				if (effect->getArity() != reachable_fact->getPredicate().getArity() ||
-				    effect->getPredicate().getName() != reachable_fact->getPredicate().getName())
-				{
-					continue;
-				}
-				
-				bool terms_match = true;
-				for (unsigned int term_index = 0; term_index < effect->getArity(); ++term_index)
-				{
-					EquivalentObjectGroup& persistent_eog = reachable_fact->getTermDomain(term_index);
-					const HEURISTICS::VariableDomain* action_variable_domain = created_effect->getVariableAssignments()[created_effect->getAchiever()->getTransition().getAction().getActionVariable(effect_index, term_index)];
-					
-					bool term_matches = false;
-					for (std::vector<const Object*>::const_iterator ci = action_variable_domain->getVariableDomain().begin(); ci != action_variable_domain->getVariableDomain().end(); ++ci)
-					{
-						if (persistent_eog.contains(**ci))
-						{
-							term_matches = true;
-							break;
-						}
-					}
-					
-					if (!term_matches)
-					{
-						terms_match = false;
-						break;
-					}
-				}
-				
-				if (terms_match)
+				if (&persistent_fact->getTermDomain(term_index) != variable_assignments[action.getActionVariable(*effect->getTerms()[term_index])])
 				{
-					deletes_persistent_node = true;
+					terms_match = false;
 					break;
 				}
 			}
 			
-			if (deletes_persistent_node)
+			if (terms_match)
 			{
-				break;
+				return true;
 			}
 		}
-		
-		if (deletes_persistent_node)
+	}
+	return false;
+}
+
+GoalIndex::GoalIndex(const EquivalentObjectGroupManager& eog_manager, const std::vector<const GroundedAtom*>& goals)
+	: eog_manager_(&eog_manager), uncovered_goals_(goals)
+{
+	
+}
+
+bool GoalIndex::update()
+{
+	for (std::vector<const GroundedAtom*>::reverse_iterator ri = uncovered_goals_.rbegin(); ri != uncovered_goals_.rend(); ++ri)
+	{
+		if (isCovered(**ri))
 		{
-//			delete created_effect;
-			continue;
+			uncovered_goals_.erase(ri.base() - 1);
 		}
+	}
+	return uncovered_goals_.empty();
+}
 
-		// Make sure the fact hasn't been reached before!
-		const EquivalentObjectGroup* best_eog = NULL;
-		bool zero_arity_reached_fact = created_effect->getReachableFact().getPredicate().getArity() == 0;
-		if (!zero_arity_reached_fact)
+bool GoalIndex::isCovered(const GroundedAtom& goal) const
+{
+	// Every reachable fact is stored by the root EOGs of its terms, so the EOG with the fewest facts is searched.
+	const EquivalentObjectGroup* smallest_eog = &eog_manager_->getZeroArityEOG();
+	for (unsigned int i = 0; i < goal.getPredicate().getArity(); ++i)
+	{
+		const EquivalentObject* equivalent_object = eog_manager_->findEquivalentObject(goal.getObject(i));
+		if (equivalent_object == NULL)
 		{
-			for (unsigned int i = 0; i < created_effect->getReachableFact().getPredicate().getArity(); i++)
-			{
-				const EquivalentObjectGroup& eog = created_effect->getReachableFact().getTermDomain(i);
-				if (best_eog == NULL)
-				{
-					best_eog = &eog;
-				}
-				
-				else if (best_eog->getReachableFacts().size() > eog.getReachableFacts().size())
-				{
-					best_eog = &eog;
-				}
-			}
+			return false;
 		}
-		else
+		
+		const EquivalentObjectGroup& eog = equivalent_object->getEquivalentObjectGroup().getRootNode();
+		if (i == 0 || eog.getReachableFacts().size() < smallest_eog->getReachableFacts().size())
 		{
-			best_eog = &eog_manager.getZeroArityEOG();
+			smallest_eog = &eog;
 		}
-		
-#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
-		if (!created_effect->getReachableFact().getPredicate().isStatic())
+	}
+	
+	for (std::vector<ReachableFact*>::const_iterator ci = smallest_eog->getReachableFacts().begin(); ci != smallest_eog->getReachableFacts().end(); ++ci)
+	{
+		const ReachableFact* reachable_fact = *ci;
+		if (goal.getPredicate().getArity() != reachable_fact->getPredicate().getArity() ||
+		    goal.getPredicate().getNameId() != reachable_fact->getPredicate().getNameId())
 		{
-			std::cout << "New reachable effect: " << created_effect->getReachableFact() << "." << std::endl;
+			continue;
 		}
-#endif
 		
-		bool already_reached = false;
-		for (std::vector<ReachableFact*>::const_iterator ci = best_eog->getReachableFacts().begin(); ci != best_eog->getReachableFacts().end(); ci++)
+		bool terms_match = true;
+		for (unsigned int i = 0; i < goal.getPredicate().getArity(); ++i)
 		{
-			if ((*ci)->isIdenticalTo(created_effect->getReachableFact()))
+			if (!reachable_fact->getTermDomain(i).contains(goal.getObject(i)))
 			{
-#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_COMMENT
-				std::cout << "New reachable effect: " << created_effect->getReachableFact() << " already achieved by " << **ci << "." << std::endl;
-#endif
-				already_reached = true;
+				terms_match = false;
 				break;
 			}
 		}
-		if (already_reached)
+		
+		if (terms_match)
 		{
-			fact_layer.addFact(*created_effect, true);
-//			delete &new_reachable_fact;
-			continue;
+			return true;
 		}
-#ifdef DTG_REACHABILITY_KEEP_TIME
-		++ReachableTransition::accepted_new_reachable_facts;
-#endif
-		std::vector<std::pair<ReachableSet*, unsigned int> >* listeners = (*effect_propagation_listeners_[created_effect->getEffectSetIndex()])[created_effect->getEffectIndex()];
+	}
+	return false;
+}
 
-		for (std::vector<std::pair<ReachableSet*, unsigned int> >::const_iterator ci = listeners->begin(); ci != listeners->end(); ci++)
+bool ReachableTransition::generateReachableFacts(const EquivalentObjectGroupManager& eog_manager, ReachableFactLayer& fact_layer, const PersistentFactIndex& persistent_facts, const boost::unordered_set<const EquivalentObjectGroup*>& updated_eogs)
+{
+	assert (fact_layer.getPreviousLayer() != NULL);
+	
+	unsigned int nr_preconditions = preconditions_reachable_sets_->size();
+	std::vector<JoinRelation> relations(nr_preconditions);
+	std::vector<std::pair<unsigned int, unsigned int> > cardinalities;
+	bool has_delta = false;
+	for (unsigned int precondition_index = 0; precondition_index < nr_preconditions; ++precondition_index)
+	{
+		ReachableSet* precondition_reachable_set = (*preconditions_reachable_sets_)[precondition_index];
+		JoinRelation& relation = relations[precondition_index];
+		relation.precondition_mappings_ = (*transition_->getPreconditionMappings().find(&precondition_reachable_set->getFactSet())).second;
+		
+		for (unsigned int tree_index = 0; tree_index < precondition_reachable_set->getCachedReachableTreesSize(); ++tree_index)
 		{
-			(*ci).first->processNewReachableFact(created_effect->getReachableFact(), (*ci).second);
+			ReachableTree* current_tree = precondition_reachable_set->getReachableTrees()[tree_index];
+			for (unsigned int leaf_index = 0; leaf_index < current_tree->getCachedNumberOfLeafs(); ++leaf_index)
+			{
+				const ReachableTreeNode* leaf = current_tree->getLeaves()[leaf_index];
+				relation.leaves_.push_back(leaf);
+				relation.delta_.push_back(isDelta(*leaf, relation.precondition_mappings_->size(), updated_eogs));
+				has_delta |= relation.delta_.back();
+			}
 		}
-
-#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
-		if (!created_effect->getReachableFact().getPredicate().isStatic())
+		
+		// If a precondition cannot be satisfied, neither can the transition.
+		if (relation.leaves_.empty())
 		{
-			std::cout << "New reachable effect: " << created_effect->getReachableFact() << "." << std::endl;
+			return false;
 		}
+		cardinalities.push_back(std::make_pair(relation.leaves_.size(), precondition_index));
+	}
+	
+#ifdef DTG_REACHABILITY_KEEP_TIME
+	ThreadMemory& thread_memory = getThreadMemory();
+	for (std::vector<JoinRelation>::const_iterator ci = relations.begin(); ci != relations.end(); ++ci)
+	{
+		thread_memory.total_leaves_ += (*ci).leaves_.size();
+		thread_memory.delta_leaves_ += std::count((*ci).delta_.begin(), (*ci).delta_.end(), true);
+	}
 #endif
-
-		new_facts_reached = true;
+	
+	std::vector<EquivalentObjectGroup*> variable_assignments(transition_->getAction().getVariables().size(), NULL);
+	std::vector<const ReachableTreeNode*> selected_leaves(nr_preconditions, NULL);
+	
+	// A transition without preconditions is only ever created once, the processed groups take care of that.
+	if (nr_preconditions == 0)
+	{
+		return join(eog_manager, relations, std::vector<unsigned int>(), 0, 0, variable_assignments, selected_leaves, fact_layer, persistent_facts);
+	}
+	
+	// All combinations of these leaves have been tried before.
+	if (!has_delta)
+	{
+		return false;
+	}
+	
+	// Join the precondition sets with the fewest leaves first, so the larger sets are only probed through their index.
+	std::sort(cardinalities.begin(), cardinalities.end());
+	std::vector<unsigned int> join_order;
+	std::vector<bool> bound_variables(transition_->getAction().getVariables().size(), false);
+	for (std::vector<std::pair<unsigned int, unsigned int> >::const_iterator ci = cardinalities.begin(); ci != cardinalities.end(); ++ci)
+	{
+		join_order.push_back((*ci).second);
+		JoinRelation& relation = relations[(*ci).second];
 		
-		// Update the relevant equivalent object groups.
-		if (!zero_arity_reached_fact)
+		std::vector<unsigned int> relation_variables;
+		for (std::vector<std::vector<unsigned int>* >::const_iterator ci = relation.precondition_mappings_->begin(); ci != relation.precondition_mappings_->end(); ++ci)
 		{
-			for (unsigned int i = 0; i < created_effect->getReachableFact().getPredicate().getArity(); i++)
+			relation_variables.insert(relation_variables.end(), (*ci)->begin(), (*ci)->end());
+		}
+		std::sort(relation_variables.begin(), relation_variables.end());
+		relation_variables.erase(std::unique(relation_variables.begin(), relation_variables.end()), relation_variables.end());
+		
+		for (std::vector<unsigned int>::const_iterator ci = relation_variables.begin(); ci != relation_variables.end(); ++ci)
+		{
+			if (bound_variables[*ci])
 			{
-				// Make sure not to add the fact to the same EOG!
-				EquivalentObjectGroup& to_add_to = created_effect->getReachableFact().getTermDomain(i);
-				
-				bool already_added = false;
-				for (unsigned int j = 0; j < i; j++)
-				{
-					EquivalentObjectGroup& previously_added_to = created_effect->getReachableFact().getTermDomain(j);
-					if (&to_add_to == &previously_added_to)
-					{
-						already_added = true;
-						break;
-					}
-				}
-				
-				if (!already_added)
-				{
-					created_effect->getReachableFact().getTermDomain(i).addReachableFact(created_effect->getReachableFact());
-				}
-//				else
-//				{
-//					std::cout << created_effect->getReachableFact() << " was already added: " << std::endl;
-//					std::cout << created_effect->getReachableFact().getTermDomain(i) << std::endl;
-//				}
+				relation.join_variables_.push_back(*ci);
 			}
+			bound_variables[*ci] = true;
 		}
-		else
+		
+		if (relation.join_variables_.empty())
 		{
-			eog_manager.getZeroArityEOG().addReachableFact(created_effect->getReachableFact());
+			continue;
 		}
 		
-		// Add the fact to the current fact layer.
-		fact_layer.addFact(*created_effect, false);
+		std::vector<EquivalentObjectGroup*> leaf_assignments(bound_variables.size(), NULL);
+		for (unsigned int leaf_index = 0; leaf_index < relation.leaves_.size(); ++leaf_index)
+		{
+			bindLeaf(*relation.leaves_[leaf_index], *relation.precondition_mappings_, leaf_assignments);
+			relation.index_[getJoinKey(relation.join_variables_, leaf_assignments)].push_back(leaf_index);
+			leaf_assignments.assign(leaf_assignments.size(), NULL);
+		}
 	}
 	
-#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
-	std::cout << "[ReachableTransition::generateReachableFacts] Done generating facts. Did we make some new facts? " << new_facts_reached << std::endl;
-#endif
-	
-	return new_facts_reached;
+	bool created_new_effect = false;
+	for (unsigned int delta_step = 0; delta_step < join_order.size(); ++delta_step)
+	{
+		const std::vector<bool>& delta = relations[join_order[delta_step]].delta_;
+		if (std::find(delta.begin(), delta.end(), true) == delta.end())
+		{
+			continue;
+		}
+		
+		if (join(eog_manager, relations, join_order, 0, delta_step, variable_assignments, selected_leaves, fact_layer, persistent_facts))
+		{
+			created_new_effect = true;
+		}
+	}
+	return created_new_effect;
 }
-*/
 
-bool ReachableTransition::generateReachableFacts(const EquivalentObjectGroupManager& eog_manager, std::vector<const ReachableFact*>& preconditions, std::vector<EquivalentObjectGroup*>& current_variable_assignments, unsigned int precondition_index, MyPOP::REACHABILITY::ReachableFactLayer& new_fact_layer, const std::vector<const ReachableFact*>& persistent_facts)
+bool ReachableTransition::isDelta(const ReachableTreeNode& leaf, unsigned int depth, const boost::unordered_set<const EquivalentObjectGroup*>& updated_eogs)
 {
-#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
-	std::cout << "[ReachableTransition::generateReachableFacts] (" << transition_->getAction().getPredicate();
-	for (std::vector<EquivalentObjectGroup*>::const_iterator ci = current_variable_assignments.begin(); ci != current_variable_assignments.end(); ++ci)
+	if (!leaf.hasBeenProcessed())
 	{
-		if (*ci != NULL)
-			(*ci)->printObjects(std::cout);
+		return true;
 	}
-	std::cout << ")" << std::endl;
 	
-	std::cout << "Preconditions: " << std::endl;
-	for (std::vector<const ReachableFact*>::const_iterator ci = preconditions.begin(); ci != preconditions.end(); ++ci)
+	if (updated_eogs.empty())
 	{
-		std::cout << **ci << std::endl;
+		return false;
 	}
-#endif
-
-	bool created_new_effect = false;
 	
-	//const ReachableFactLayer* prev_fact_layer = new_fact_layer.getPreviousLayer();
-
-	// Found a full set of preconditions!
-	if (precondition_index == preconditions_reachable_sets_->size())
+	const ReachableTreeNode* leaf_node = &leaf;
+	for (unsigned int fact_index = 0; fact_index < depth; ++fact_index)
 	{
-		// Check if this has been created before.
-		for (std::vector<const std::vector<EquivalentObjectGroup*>*>::const_iterator ci = processed_groups_.begin(); ci != processed_groups_.end(); ++ci)
+		const ReachableFact& reachable_fact = leaf_node->getReachableFact();
+		for (unsigned int term_index = 0; term_index < reachable_fact.getPredicate().getArity(); ++term_index)
 		{
-			const std::vector<EquivalentObjectGroup*>* previous_created_set = *ci;
-			bool matches = true;
-			for (unsigned int i = 0; i < previous_created_set->size(); ++i)
+			if (updated_eogs.count(&reachable_fact.getTermDomain(term_index)) != 0)
 			{
-				EquivalentObjectGroup* previous_eog = (*previous_created_set)[i];
-				EquivalentObjectGroup* current_eog = current_variable_assignments[i];
-				if (previous_eog != NULL)
-				{
-					previous_eog = &previous_eog->getRootNode();
-				}
-				if (current_eog != NULL)
-				{
-					current_eog = &current_eog->getRootNode();
-				}
-
-				if (previous_eog != current_eog)
-				{
-					matches = false;
-					break;
-				}
+				return true;
 			}
-			
-			if (matches)
+		}
+		leaf_node = leaf_node->getParent();
+	}
+	return false;
+}
+
+bool ReachableTransition::bindLeaf(const ReachableTreeNode& leaf, const std::vector<std::vector<unsigned int>* >& precondition_mappings, std::vector<EquivalentObjectGroup*>& variable_assignments)
+{
+	const ReachableTreeNode* leaf_node = &leaf;
+	for (unsigned int fact_index = 0; fact_index < precondition_mappings.size(); ++fact_index)
+	{
+		const ReachableFact& reachable_fact = leaf_node->getReachableFact();
+		const std::vector<unsigned int>* variable_mappings = precondition_mappings[precondition_mappings.size() - 1 - fact_index];
+		for (unsigned int term_index = 0; term_index < reachable_fact.getPredicate().getArity(); ++term_index)
+		{
+			EquivalentObjectGroup*& assigned_eog = variable_assignments[(*variable_mappings)[term_index]];
+			if (assigned_eog != NULL && assigned_eog != &reachable_fact.getTermDomain(term_index))
 			{
 				return false;
 			}
+			assigned_eog = &reachable_fact.getTermDomain(term_index);
 		}
+		leaf_node = leaf_node->getParent();
+	}
+	return true;
+}
 
-		// Store cache!
-		processed_groups_.push_back(new std::vector<EquivalentObjectGroup*>(current_variable_assignments));
-		
-#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
-		std::cout << "Possible transition: (" << transition_->getAction().getPredicate();
-		for (unsigned int i = 0; i < transition_->getAction().getVariables().size(); ++i)
+std::size_t ReachableTransition::getJoinKey(const std::vector<unsigned int>& variables, const std::vector<EquivalentObjectGroup*>& variable_assignments)
+{
+	std::size_t key = 0;
+	for (std::vector<unsigned int>::const_iterator ci = variables.begin(); ci != variables.end(); ++ci)
+	{
+		boost::hash_combine(key, variable_assignments[*ci]);
+	}
+	return key;
+}
+
+bool ReachableTransition::join(const EquivalentObjectGroupManager& eog_manager, const std::vector<JoinRelation>& relations, const std::vector<unsigned int>& join_order, unsigned int step, unsigned int delta_step, const std::vector<EquivalentObjectGroup*>& variable_assignments, std::vector<const ReachableTreeNode*>& selected_leaves, ReachableFactLayer& new_fact_layer, const PersistentFactIndex& persistent_facts)
+{
+	// Found a full set of preconditions!
+	if (step == join_order.size())
+	{
+		std::vector<const ReachableFact*> preconditions;
+		for (unsigned int precondition_index = 0; precondition_index < relations.size(); ++precondition_index)
 		{
-			if (current_variable_assignments[i] == NULL)
-			{
-				std::cout << "NULL";
-			}
-			else
+			const ReachableTreeNode* leaf_node = selected_leaves[precondition_index];
+			for (unsigned int fact_index = 0; fact_index < relations[precondition_index].precondition_mappings_->size(); ++fact_index)
 			{
-				current_variable_assignments[i]->printObjects(std::cout, new_fact_layer.getLayerNumber() - 1);
+				preconditions.push_back(&leaf_node->getReachableFact());
+				leaf_node = leaf_node->getParent();
 			}
-			std::cout << " ";
 		}
-		std::cout << ")" << std::endl;
-		std::cout << "Based on the preconditions: " << std::endl;
-		for (std::vector<const ReachableFact*>::const_iterator ci = preconditions.begin(); ci != preconditions.end(); ++ci)
+		return createReachableFacts(eog_manager, preconditions, variable_assignments, new_fact_layer, persistent_facts);
+	}
+	
+	unsigned int precondition_index = join_order[step];
+	const JoinRelation& relation = relations[precondition_index];
+	
+	// Only the leaves which agree with the EOGs already assigned to the join variables are candidates.
+	const std::vector<unsigned int>* candidates = NULL;
+	if (!relation.join_variables_.empty())
+	{
+		boost::unordered_map<std::size_t, std::vector<unsigned int> >::const_iterator index_ci = relation.index_.find(getJoinKey(relation.join_variables_, variable_assignments));
+		if (index_ci == relation.index_.end())
 		{
-			std::cout << **ci << std::endl;
+			return false;
 		}
-		std::cout << "Created effects: " << std::endl;
-#endif
+		candidates = &(*index_ci).second;
+	}
+	
+	bool created_new_effect = false;
+	unsigned int nr_candidates = candidates == NULL ? relation.leaves_.size() : candidates->size();
+	for (unsigned int i = 0; i < nr_candidates; ++i)
+	{
+		unsigned int leaf_index = candidates == NULL ? i : (*candidates)[i];
 		
-		/**
-		 * Create an action to add to the 'action layer'.
-		 */
-		//std::vector<const ReachableFact*>* new_preconditions = new std::vector<const ReachableFact*>(preconditions);
-		std::vector<EquivalentObjectGroup*>* new_current_variable_assignments = new std::vector<EquivalentObjectGroup*>(current_variable_assignments);
-		std::vector<const ReachableFactLayerItem*>* preconditions_fact_layer_items = new std::vector<const ReachableFactLayerItem*>();
-		for (std::vector< const MyPOP::REACHABILITY::ReachableFact* >::const_iterator ci = preconditions.begin(); ci != preconditions.end(); ++ci)
+		// The combinations where an earlier precondition set contributes a leaf from the delta are joined in another pass.
+		if (step < delta_step ? relation.delta_[leaf_index] : (step == delta_step && !relation.delta_[leaf_index]))
 		{
-			const ReachableFactLayerItem* reachable_fact_layer_item = new_fact_layer.getPreviousLayer()->findPrecondition(**ci);
-			
-			if (reachable_fact_layer_item == NULL)
+			continue;
+		}
+		
+		const ReachableTreeNode* leaf_node = relation.leaves_[leaf_index];
+		
+		// Leaves with colliding keys are filtered out here.
+		std::vector<EquivalentObjectGroup*> new_variable_assignments(variable_assignments);
+		if (!bindLeaf(*leaf_node, *relation.precondition_mappings_, new_variable_assignments))
+		{
+			continue;
+		}
+		
+		selected_leaves[precondition_index] = leaf_node;
+		if (join(eog_manager, relations, join_order, step + 1, delta_step, new_variable_assignments, selected_leaves, new_fact_layer, persistent_facts))
+		{
+			created_new_effect = true;
+		}
+	}
+	return created_new_effect;
+}
+
+std::size_t ReachableTransition::getProcessedGroupKey(const std::vector<EquivalentObjectGroup*>& variable_assignments)
+{
+	std::size_t key = 0;
+	for (std::vector<EquivalentObjectGroup*>::const_iterator ci = variable_assignments.begin(); ci != variable_assignments.end(); ++ci)
+	{
+		EquivalentObjectGroup* eog = *ci;
+		boost::hash_combine(key, eog == NULL ? NULL : &eog->getRootNode());
+	}
+	return key;
+}
+
+bool ReachableTransition::createReachableFacts(const EquivalentObjectGroupManager& eog_manager, const std::vector<const ReachableFact*>& preconditions, const std::vector<EquivalentObjectGroup*>& current_variable_assignments, ReachableFactLayer& new_fact_layer, const PersistentFactIndex& persistent_facts)
+{
+	bool created_new_effect = false;
+	
+	// Check if this has been created before.
+	std::size_t processed_group_key = getProcessedGroupKey(current_variable_assignments);
+	std::pair<boost::unordered_multimap<std::size_t, const std::vector<EquivalentObjectGroup*>*>::const_iterator, boost::unordered_multimap<std::size_t, const std::vector<EquivalentObjectGroup*>*>::const_iterator> candidates = processed_groups_index_.equal_range(processed_group_key);
+	for (boost::unordered_multimap<std::size_t, const std::vector<EquivalentObjectGroup*>*>::const_iterator ci = candidates.first; ci != candidates.second; ++ci)
+	{
+		const std::vector<EquivalentObjectGroup*>* previous_created_set = (*ci).second;
+		bool matches = true;
+		for (unsigned int i = 0; i < previous_created_set->size(); ++i)
+		{
+			EquivalentObjectGroup* previous_eog = (*previous_created_set)[i];
+			EquivalentObjectGroup* current_eog = current_variable_assignments[i];
+			if (previous_eog != NULL)
 			{
-				std::cerr << "Could not find a precondition for the fact: " << **ci << std::endl;
-				const ReachableFactLayer* rfl = new_fact_layer.getPreviousLayer();
-				while (rfl != NULL)
-				{
-					std::cerr << *rfl << std::endl;
-					rfl = rfl->getPreviousLayer();
-				}
-				
+				previous_eog = &previous_eog->getRootNode();
+			}
+			if (current_eog != NULL)
+			{
+				current_eog = &current_eog->getRootNode();
+			}
+
+			if (previous_eog != current_eog)
+			{
+				matches = false;
+				break;
 			}
-			
-			preconditions_fact_layer_items->push_back(reachable_fact_layer_item);
 		}
-		AchievingTransition* at = new AchievingTransition(new_fact_layer.getLayerNumber() - 1, this, *preconditions_fact_layer_items, *new_current_variable_assignments);
 		
-		/**
-		 * Check if this action destroys any persistent facts.
-		 */
-		bool deletes_persistent_node = false;
-		for (std::vector<const ReachableFact*>::const_iterator ci = persistent_facts.begin(); ci != persistent_facts.end(); ++ci)
+		if (matches)
 		{
-			const ReachableFact* persistent_fact = *ci;
-			
-			for (std::vector<const Atom*>::const_iterator ci = at->getAchiever()->getTransition().getAction().getEffects().begin(); ci != at->getAchiever()->getTransition().getAction().getEffects().end(); ++ci) 
-			{
-				const Atom* effect = *ci;
-				if (!effect->isNegative())
-				{
-					continue;
-				}
-				
-				if (effect->getArity() != persistent_fact->getPredicate().getArity() ||
-				    effect->getPredicate().getName() != persistent_fact->getPredicate().getName())
-				{
-					continue;
-				}
-				
-				bool terms_match = true;
-				for (unsigned int term_index = 0; term_index < effect->getArity(); ++term_index)
-				{
-					const EquivalentObjectGroup& persistent_term_eog = persistent_fact->getTermDomain(term_index);
-					const EquivalentObjectGroup* effect_term_eog = current_variable_assignments[at->getAchiever()->getTransition().getAction().getActionVariable(*effect->getTerms()[term_index])];
-					
-					if (&persistent_term_eog != effect_term_eog)
-					{
-						terms_match = false;
-						break;
-					}
-				}
-				
-				if (terms_match)
-				{
-					deletes_persistent_node = true;
-					break;
-				}
-			}
-			if (deletes_persistent_node)
-			{
-				break;
-			}
+			return false;
+		}
+	}
+
+	// Store cache!
+	const std::vector<EquivalentObjectGroup*>* processed_group = new std::vector<EquivalentObjectGroup*>(current_variable_assignments);
+	processed_groups_.push_back(processed_group);
+	processed_groups_index_.insert(std::make_pair(processed_group_key, processed_group));
+	
+#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
+	std::cout << "Possible transition: (" << transition_->getAction().getPredicate();
+	for (unsigned int i = 0; i < transition_->getAction().getVariables().size(); ++i)
+	{
+		if (current_variable_assignments[i] == NULL)
+		{
+			std::cout << "NULL";
 		}
+		else
+		{
+			current_variable_assignments[i]->printObjects(std::cout, new_fact_layer.getLayerNumber() - 1);
+		}
+		std::cout << " ";
+	}
+	std::cout << ")" << std::endl;
+	std::cout << "Based on the preconditions: " << std::endl;
+	for (std::vector<const ReachableFact*>::const_iterator ci = preconditions.begin(); ci != preconditions.end(); ++ci)
+	{
+		std::cout << **ci << std::endl;
+	}
+	std::cout << "Created effects: " << std::endl;
+#endif
+	
+	/**
+	 * Check if this action destroys any persistent facts.
+	 */
+	if (persistent_facts.isDeletedBy(transition_->getAction(), current_variable_assignments))
+	{
+		return false;
+	}
+	
+	/**
+	 * Create an action to add to the 'action layer'.
+	 */
+	//std::vector<const ReachableFact*>* new_preconditions = new std::vector<const ReachableFact*>(preconditions);
+	std::vector<EquivalentObjectGroup*>* new_current_variable_assignments = new std::vector<EquivalentObjectGroup*>(current_variable_assignments);
+	std::vector<const ReachableFactLayerItem*>* preconditions_fact_layer_items = new std::vector<const ReachableFactLayerItem*>();
+	for (std::vector< const MyPOP::REACHABILITY::ReachableFact* >::const_iterator ci = preconditions.begin(); ci != preconditions.end(); ++ci)
+	{
+		const ReachableFactLayerItem* reachable_fact_layer_item = new_fact_layer.getPreviousLayer()->findPrecondition(**ci);
 		
-		if (deletes_persistent_node)
+		if (reachable_fact_layer_item == NULL)
 		{
-			delete at;
-			return false;
+			std::cerr << "Could not find a precondition for the fact: " << **ci << std::endl;
+			const ReachableFactLayer* rfl = new_fact_layer.getPreviousLayer();
+			while (rfl != NULL)
+			{
+				std::cerr << *rfl << std::endl;
+				rfl = rfl->getPreviousLayer();
+			}
+			
 		}
 		
-		AchievingTransition::storeAchievingTransition(*at);
+		preconditions_fact_layer_items->push_back(reachable_fact_layer_item);
+	}
+	AchievingTransition* at = &AchievingTransition::createAchievingTransition(new_fact_layer.getLayerNumber() - 1, this, *preconditions_fact_layer_items, *new_current_variable_assignments);
+	
+	//for (std::vector<ReachableSet*>::const_iterator ci = effect_reachable_sets_->begin(); ci != effect_reachable_sets_->end(); ++ci)
+	for (unsigned int fact_set_index = 0; fact_set_index < effect_reachable_sets_->size(); ++fact_set_index)
+	{
+		//ReachableSet* effect = *ci;
+		ReachableSet* effect = (*effect_reachable_sets_)[fact_set_index];
+		const HEURISTICS::FactSet& effect_fact_set = effect->getFactSet();
+		std::vector<std::vector<unsigned int>* >* effects_mappings = (*transition_->getEffectMappings().find(&effect_fact_set)).second;
 		
-		//for (std::vector<ReachableSet*>::const_iterator ci = effect_reachable_sets_->begin(); ci != effect_reachable_sets_->end(); ++ci)
-		for (unsigned int fact_set_index = 0; fact_set_index < effect_reachable_sets_->size(); ++fact_set_index)
+		for (unsigned int fact_index = 0; fact_index < effect_fact_set.getFacts().size(); ++fact_index)
 		{
-			//ReachableSet* effect = *ci;
-			ReachableSet* effect = (*effect_reachable_sets_)[fact_set_index];
-			const HEURISTICS::FactSet& effect_fact_set = effect->getFactSet();
-			std::vector<std::vector<unsigned int>* >* effects_mappings = (*transition_->getEffectMappings().find(&effect_fact_set)).second;
+			const HEURISTICS::TransitionFact* fact = effect_fact_set.getFacts()[fact_index];
+			std::vector<unsigned int>* effect_mappings = (*effects_mappings)[fact_index];
 			
-			for (unsigned int fact_index = 0; fact_index < effect_fact_set.getFacts().size(); ++fact_index)
+			std::vector<std::vector<EquivalentObjectGroup*>*> possible_domains_per_term;
+			
+			for (unsigned int term_index = 0; term_index < fact->getVariableDomains().size(); ++term_index)
 			{
-				const HEURISTICS::TransitionFact* fact = effect_fact_set.getFacts()[fact_index];
-				std::vector<unsigned int>* effect_mappings = (*effects_mappings)[fact_index];
-				
-				std::vector<std::vector<EquivalentObjectGroup*>*> possible_domains_per_term;
+				std::vector<EquivalentObjectGroup*>* possible_domains = new std::vector<EquivalentObjectGroup*>();
+				possible_domains_per_term.push_back(possible_domains);
+				EquivalentObjectGroup* eog = current_variable_assignments[(*effect_mappings)[term_index]];
 				
-				for (unsigned int term_index = 0; term_index < fact->getVariableDomains().size(); ++term_index)
+				if (eog == NULL)
 				{
-					std::vector<EquivalentObjectGroup*>* possible_domains = new std::vector<EquivalentObjectGroup*>();
-					possible_domains_per_term.push_back(possible_domains);
-					EquivalentObjectGroup* eog = current_variable_assignments[(*effect_mappings)[term_index]];
-					
-					if (eog == NULL)
+					for (std::vector<const Object*>::const_iterator ci = fact->getVariableDomains()[term_index]->getVariableDomain().begin(); ci != fact->getVariableDomains()[term_index]->getVariableDomain().end(); ++ci)
 					{
-						for (std::vector<const Object*>::const_iterator ci = fact->getVariableDomains()[term_index]->getVariableDomain().begin(); ci != fact->getVariableDomains()[term_index]->getVariableDomain().end(); ++ci)
+						EquivalentObjectGroup& eog = eog_manager.getEquivalentObject(**ci).getEquivalentObjectGroup();
+						if (std::find(possible_domains->begin(), possible_domains->end(), &eog) == possible_domains->end())
 						{
-							EquivalentObjectGroup& eog = eog_manager.getEquivalentObject(**ci).getEquivalentObjectGroup();
-							if (std::find(possible_domains->begin(), possible_domains->end(), &eog) == possible_domains->end())
-							{
-								possible_domains->push_back(&eog);
-							}
+							possible_domains->push_back(&eog);
 						}
 					}
-					else
-					{
-						possible_domains->push_back(eog);
-					}
+				}
+				else
+				{
+					possible_domains->push_back(eog);
+				}
 /*
-					std::cout << "Possible domains for term index: " << term_index << ": ";
-					for (std::vector<EquivalentObjectGroup*>::const_iterator ci = possible_domains->begin(); ci != possible_domains->end(); ++ci)
-					{
-						(*ci)->printObjects(std::cout);
-					}
+				std::cout << "Possible domains for term index: " << term_index << ": ";
+				for (std::vector<EquivalentObjectGroup*>::const_iterator ci = possible_domains->begin(); ci != possible_domains->end(); ++ci)
+				{
+					(*ci)->printObjects(std::cout);
+				}
+				std::cout << "." << std::endl;
+*/
+			}
+			
+			// Create all possible effects, if a variable is equal to NULL it is not bounded by its preconditions.
+			unsigned int counter[fact->getVariableDomains().size()];
+			memset(&counter, 0, sizeof(unsigned int) * fact->getVariableDomains().size());
+			
+			bool created_all_possible_facts = false;
+			std::vector<EquivalentObjectGroup*> variable_domains;
+			while (!created_all_possible_facts)
+			{
+				created_all_possible_facts = true;
+				
+				variable_domains.clear();
+				for (unsigned int i = 0; i < fact->getVariableDomains().size(); ++i)
+				{
+					variable_domains.push_back((*possible_domains_per_term[i])[counter[i]]);
+/*
+					std::cout << "Possible domains for term index: " << i << ": ";
+					(*possible_domains_per_term[i])[counter[i]]->printObjects(std::cout);
 					std::cout << "." << std::endl;
 */
 				}
 				
-				// Create all possible effects, if a variable is equal to NULL it is not bounded by its preconditions.
-				unsigned int counter[fact->getVariableDomains().size()];
-				memset(&counter, 0, sizeof(unsigned int) * fact->getVariableDomains().size());
-				
-				bool created_all_possible_facts = false;
-				while (!created_all_possible_facts)
+				// Check if this effect already exists.
+				ReachableFactLayerItem* new_effect_layer_item = NULL;
+				for (std::vector<ReachableFactLayerItem*>::const_iterator ci = new_fact_layer.getReachableFacts().begin(); ci != new_fact_layer.getReachableFacts().end(); ++ci)
 				{
-					created_all_possible_facts = true;
-					
-					std::vector<EquivalentObjectGroup*>* variable_domains = new std::vector<EquivalentObjectGroup*>();
-					for (unsigned int i = 0; i < fact->getVariableDomains().size(); ++i)
+					ReachableFactLayerItem* existing_effect_item = *ci;
+					if (existing_effect_item->getReachableFactCopy().getPredicate().getArity() != fact->getPredicate().getArity() ||
+					    existing_effect_item->getReachableFactCopy().getPredicate().getNameId() != fact->getPredicate().getNameId())
 					{
-						variable_domains->push_back((*possible_domains_per_term[i])[counter[i]]);
-/*
-						std::cout << "Possible domains for term index: " << i << ": ";
-						(*possible_domains_per_term[i])[counter[i]]->printObjects(std::cout);
-						std::cout << "." << std::endl;
-*/
+						continue;
 					}
 					
-					// Check if this effect already exists.
-					ReachableFactLayerItem* new_effect_layer_item = NULL;
-					for (std::vector<ReachableFactLayerItem*>::const_iterator ci = new_fact_layer.getReachableFacts().begin(); ci != new_fact_layer.getReachableFacts().end(); ++ci)
+					// Check if the variables match up.
+					bool terms_match = true;
+					for (unsigned int term_index = 0; term_index < fact->getPredicate().getArity(); ++term_index)
 					{
-						ReachableFactLayerItem* existing_effect_item = *ci;
-						if (existing_effect_item->getReachableFactCopy().getPredicate().getArity() != fact->getPredicate().getArity() ||
-						    existing_effect_item->getReachableFactCopy().getPredicate().getName() != fact->getPredicate().getName())
-						{
-							continue;
-						}
-						
-						// Check if the variables match up.
-						bool terms_match = true;
-						for (unsigned int term_index = 0; term_index < fact->getPredicate().getArity(); ++term_index)
+						if (variable_domains[term_index] != &existing_effect_item->getReachableFactCopy().getTermDomain(term_index))
 						{
-							if ((*variable_domains)[term_index] != &existing_effect_item->getReachableFactCopy().getTermDomain(term_index))
-							{
-								terms_match = false;
-							}
-						}
-						
-						if (terms_match)
-						{
-							new_effect_layer_item = existing_effect_item;
-							break;
+							terms_match = false;
 						}
 					}
 					
-					if (new_effect_layer_item == NULL)
+					if (terms_match)
+					{
+						new_effect_layer_item = existing_effect_item;
+						break;
+					}
+				}
+				
+				if (new_effect_layer_item == NULL)
+				{
+					ReachableFact& new_effect = ReachableFact::createReachableFact(fact->getPredicate(), variable_domains);
+					new_effect_layer_item = new ReachableFactLayerItem(new_fact_layer, new_effect);
+					created_new_effect = true;
+					if (new_effect.getPredicate().getArity() != 0)
 					{
-						ReachableFact& new_effect = ReachableFact::createReachableFact(fact->getPredicate(), *variable_domains);
-						new_effect_layer_item = new ReachableFactLayerItem(new_fact_layer, new_effect);
-						created_new_effect = true;
-						if (new_effect.getPredicate().getArity() != 0)
+						for (unsigned int i = 0; i < new_effect.getPredicate().getArity(); i++)
 						{
-							for (unsigned int i = 0; i < new_effect.getPredicate().getArity(); i++)
+							// Make sure not to add the fact to the same EOG!
+							EquivalentObjectGroup& to_add_to = new_effect.getTermDomain(i);
+							
+							bool already_added = false;
+							for (unsigned int j = 0; j < i; j++)
 							{
-								// Make sure not to add the fact to the same EOG!
-								EquivalentObjectGroup& to_add_to = new_effect.getTermDomain(i);
-								
-								bool already_added = false;
-								for (unsigned int j = 0; j < i; j++)
-								{
-									EquivalentObjectGroup& previously_added_to = new_effect.getTermDomain(j);
-									if (&to_add_to == &previously_added_to)
-									{
-										already_added = true;
-										break;
-									}
-								}
-								
-								if (!already_added)
+								EquivalentObjectGroup& previously_added_to = new_effect.getTermDomain(j);
+								if (&to_add_to == &previously_added_to)
 								{
-									new_effect.getTermDomain(i).addReachableFact(new_effect);
+									already_added = true;
+									break;
 								}
 							}
+							
+							if (!already_added)
+							{
+								new_effect.getTermDomain(i).addReachableFact(new_effect);
+							}
 						}
-						else
-						{
-							eog_manager.getZeroArityEOG().addReachableFact(new_effect);
-						}
-						new_fact_layer.addFact(*new_effect_layer_item);
+					}
+					else
+					{
+						eog_manager.getZeroArityEOG().addReachableFact(new_effect);
+					}
+					new_fact_layer.addFact(*new_effect_layer_item);
 //						std::cerr << "NEW EFFECT: " << new_effect << "." << std::endl;
-						
-						/*
-						std::pair<std::multimap<std::pair<unsigned int, unsigned int>, std::pair<ReachableSet*, unsigned int> >::const_iterator, std::multimap<std::pair<unsigned int, unsigned int>, std::pair<ReachableSet*, unsigned int> >::const_iterator> propagation_ret;
-						propagation_ret = effect_propagation_listeners_.equal_range(std::make_pair(fact_set_index, fact_index));
-						
-						for (std::multimap<std::pair<unsigned int, unsigned int>, std::pair<ReachableSet*, unsigned int> >::const_iterator ci = propagation_ret.first; ci != propagation_ret.second; ++ci)
-						{
-							(*ci).second.first->processNewReachableFact(new_effect, (*ci).second.second);
-						}
-						*/
-						
-						std::vector<std::pair<ReachableSet*, unsigned int> >* listeners = (*effect_propagation_listeners_[fact_set_index])[fact_index];
-						for (std::vector<std::pair<ReachableSet*, unsigned int> >::const_iterator ci = listeners->begin(); ci != listeners->end(); ci++)
-						{
-							(*ci).first->processNewReachableFact(new_effect, (*ci).second);
-						}
-						
+					
+					/*
+					std::pair<std::multimap<std::pair<unsigned int, unsigned int>, std::pair<ReachableSet*, unsigned int> >::const_iterator, std::multimap<std::pair<unsigned int, unsigned int>, std::pair<ReachableSet*, unsigned int> >::const_iterator> propagation_ret;
+					propagation_ret = effect_propagation_listeners_.equal_range(std::make_pair(fact_set_index, fact_index));
+					
+					for (std::multimap<std::pair<unsigned int, unsigned int>, std::pair<ReachableSet*, unsigned int> >::const_iterator ci = propagation_ret.first; ci != propagation_ret.second; ++ci)
+					{
+						(*ci).second.first->processNewReachableFact(new_effect, (*ci).second.second);
+					}
+					*/
+					
+					std::vector<std::pair<ReachableSet*, unsigned int> >* listeners = (*effect_propagation_listeners_[fact_set_index])[fact_index];
+					for (std::vector<std::pair<ReachableSet*, unsigned int> >::const_iterator ci = listeners->begin(); ci != listeners->end(); ci++)
+					{
+						(*ci).first->processNewReachableFact(new_effect, (*ci).second);
+					}
+					
 /*
-						// Update the relevant equivalent object groups.
-						if (new_effect.getPredicate().getArity() != 0)
+					// Update the relevant equivalent object groups.
+					if (new_effect.getPredicate().getArity() != 0)
+					{
+						for (unsigned int i = 0; i < new_effect.getPredicate().getArity(); i++)
 						{
-							for (unsigned int i = 0; i < new_effect.getPredicate().getArity(); i++)
+							// Make sure not to add the fact to the same EOG!
+							EquivalentObjectGroup& to_add_to = new_effect.getTermDomain(i);
+							
+							bool already_added = false;
+							for (unsigned int j = 0; j < i; j++)
 							{
-								// Make sure not to add the fact to the same EOG!
-								EquivalentObjectGroup& to_add_to = new_effect.getTermDomain(i);
-								
-								bool already_added = false;
-								for (unsigned int j = 0; j < i; j++)
+								EquivalentObjectGroup& previously_added_to = new_effect.getTermDomain(j);
+								if (&to_add_to == &previously_added_to)
 								{
-									EquivalentObjectGroup& previously_added_to = new_effect.getTermDomain(j);
-									if (&to_add_to == &previously_added_to)
-									{
-										already_added = true;
-										break;
-									}
-								}
-								
-								if (!already_added)
-								{
-									new_effect.getTermDomain(i).addReachableFact(new_effect);
+									already_added = true;
+									break;
 								}
 							}
+							
+							if (!already_added)
+							{
+								new_effect.getTermDomain(i).addReachableFact(new_effect);
+							}
 						}
-						else
-						{
-							eog_manager.getZeroArityEOG().addReachableFact(new_effect);
-						}
-*/
 					}
 					else
 					{
-						delete variable_domains;
+						eog_manager.getZeroArityEOG().addReachableFact(new_effect);
 					}
-					
-					new_effect_layer_item->addAchiever(*at, fact_set_index, fact_index);
-					at->addEffect(*new_effect_layer_item, fact_set_index, fact_index);
-					
+*/
+				}
+				
+				new_effect_layer_item->addAchiever(*at, fact_set_index, fact_index);
+				at->addEffect(*new_effect_layer_item, fact_set_index, fact_index);
+				
 //					if (effect->processNewReachableFact(new_effect, fact_index))
 //					{
 //						added_new_fact = true;
 //					}
-					
+				
 /*
-					std::vector<HEURISTICS::VariableDomain*> variable_assignments;
-					for (unsigned int variable_index = 0; variable_index < current_variable_assignments.size(); ++variable_index)
+				std::vector<HEURISTICS::VariableDomain*> variable_assignments;
+				for (unsigned int variable_index = 0; variable_index < current_variable_assignments.size(); ++variable_index)
+				{
+					HEURISTICS::VariableDomain* variable_domain = new HEURISTICS::VariableDomain();
+					EquivalentObjectGroup* eog = current_variable_assignments[variable_index];
+					
+					if (eog == NULL)
 					{
-						HEURISTICS::VariableDomain* variable_domain = new HEURISTICS::VariableDomain();
-						EquivalentObjectGroup* eog = current_variable_assignments[variable_index];
-						
-						if (eog == NULL)
+						for (std::vector<const Object*>::const_iterator ci = transition_->getActionVariables()[variable_index]->getVariableDomain().begin(); ci != transition_->getActionVariables()[variable_index]->getVariableDomain().end(); ++ci)
 						{
-							for (std::vector<const Object*>::const_iterator ci = transition_->getActionVariables()[variable_index]->getVariableDomain().begin(); ci != transition_->getActionVariables()[variable_index]->getVariableDomain().end(); ++ci)
-							{
-								variable_domain->addObject(**ci);
-							}
+							variable_domain->addObject(**ci);
 						}
-						else
+					}
+					else
+					{
+						for (std::vector<EquivalentObject*>::const_iterator ci = eog->getEquivalentObjects().begin(); ci != eog->getEquivalentObjects().end(); ++ci)
 						{
-							for (std::vector<EquivalentObject*>::const_iterator ci = eog->getEquivalentObjects().begin(); ci != eog->getEquivalentObjects().end(); ++ci)
-							{
-								variable_domain->addObject((*ci)->getObject());
-							}
+							variable_domain->addObject((*ci)->getObject());
 						}
-						
-						variable_assignments.push_back(variable_domain);
 					}
 					
-					AchievingTransition* created_effect = new AchievingTransition(fact_index, fact_set_index, preconditions, new_effect, *this, variable_assignments, fact_layer);
-					newly_created_reachable_facts.push_back(created_effect);
+					variable_assignments.push_back(variable_domain);
+				}
+				
+				AchievingTransition* created_effect = new AchievingTransition(fact_index, fact_set_index, preconditions, new_effect, *this, variable_assignments, fact_layer);
+				newly_created_reachable_facts.push_back(created_effect);
 */
-					for (unsigned int i = 0; i < fact->getVariableDomains().size(); ++i)
+				for (unsigned int i = 0; i < fact->getVariableDomains().size(); ++i)
+				{
+					if (counter[i] + 1 == (*possible_domains_per_term[i]).size())
 					{
-						if (counter[i] + 1 == (*possible_domains_per_term[i]).size())
-						{
-							counter[i] = 0;
-						}
-						else
+						counter[i] = 0;
+					}
+					else
+					{
+						counter[i] = counter[i] + 1;
+						created_all_possible_facts = false;
+						break;
+					}
+				}
+			}
+			
+			for (std::vector<std::vector<EquivalentObjectGroup*>*>::const_iterator ci = possible_domains_per_term.begin(); ci != possible_domains_per_term.end(); ++ci)
+			{
+				delete *ci;
+			}
+		}
+	}
+	return created_new_effect;
+}
+
+/*
+bool ReachableTransition::generateReachableFacts(const EquivalentObjectGroupManager& eog_manager, ReachableFactLayer& fact_layer, const std::vector<const ReachableFact*>& persistent_facts)
+{
+	assert (fact_layer.getPreviousLayer() != NULL);
+#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
+	std::cout << "[ReachableTransition::generateReachableFacts] " << *this << std::endl << "Cached tree sizes: " << std::endl;
+	for (std::vector<ReachableSet*>::const_iterator ci = preconditions_reachable_sets_->begin(); ci != preconditions_reachable_sets_->end(); ++ci)
+	{
+		std::cout << " === PRECONDITION === " << std::endl;
+		ReachableSet* reachable_set = *ci;
+		std::cout << *reachable_set << std::endl;
+		std::cout << "Trees(" << reachable_set->getReachableTrees().size() << " - cached" << reachable_set->getCachedReachableTreesSize() << "): " << std::endl;
+		for (std::vector<ReachableTree*>::const_iterator ci = reachable_set->getReachableTrees().begin(); ci != reachable_set->getReachableTrees().end(); ++ci)
+		{
+			std::cout << **ci << std::endl;
+		}
+		std::cout << " =*= PRECONDITION =*= " << std::endl;
+	}
+#endif
+
+	std::vector<EquivalentObjectGroup*> variable_assignments(transition_->getAction().getVariables().size(), NULL);
+	std::vector<const ReachableFact*> preconditions;
+	std::vector<const AchievingTransition*> newly_created_reachable_facts;
+	generateReachableFacts(eog_manager, newly_created_reachable_facts, preconditions, variable_assignments, 0, *fact_layer.getPreviousLayer());
+
+	bool new_facts_reached = false;
+	for (std::vector<const AchievingTransition*>::const_iterator ci = newly_created_reachable_facts.begin(); ci != newly_created_reachable_facts.end(); ++ci)
+	{
+		const AchievingTransition* created_effect = *ci;
+
+		// Check if this action removes a fact we want to preserve.
+		bool deletes_persistent_node = false;
+		for (std::vector<const Atom*>::const_iterator ci = created_effect->getAchiever()->getTransition().getAction().getEffects().begin(); ci != created_effect->getAchiever()->getTransition().getAction().getEffects().end(); ++ci)
+		{
+			const Atom* effect = *ci;
+			if (!effect->isNegative())
+			{
+				continue;
+			}
+			
+			// Figure out the mapping from the index of the effects to the 
+			unsigned int effect_index = std::distance(created_effect->getAchiever()->getTransition().getAction().getEffects().begin(), ci);
+			
+			for (std::vector<const ReachableFact*>::const_iterator ci = persistent_facts.begin(); ci != persistent_facts.end(); ++ci)
+			{
+				const ReachableFact* reachable_fact = *ci;
+				if (effect->getArity() != reachable_fact->getPredicate().getArity() ||
+				    effect->getPredicate().getNameId() != reachable_fact->getPredicate().getNameId())
+				{
+					continue;
+				}
+				
+				bool terms_match = true;
+				for (unsigned int term_index = 0; term_index < effect->getArity(); ++term_index)
+				{
+					EquivalentObjectGroup& persistent_eog = reachable_fact->getTermDomain(term_index);
+					const HEURISTICS::VariableDomain* action_variable_domain = created_effect->getVariableAssignments()[created_effect->getAchiever()->getTransition().getAction().getActionVariable(effect_index, term_index)];
+					
+					bool term_matches = false;
+					for (std::vector<const Object*>::const_iterator ci = action_variable_domain->getVariableDomain().begin(); ci != action_variable_domain->getVariableDomain().end(); ++ci)
+					{
+						if (persistent_eog.contains(**ci))
 						{
-							counter[i] = counter[i] + 1;
-							created_all_possible_facts = false;
+							term_matches = true;
 							break;
 						}
 					}
+					
+					if (!term_matches)
+					{
+						terms_match = false;
+						break;
+					}
 				}
 				
-				for (std::vector<std::vector<EquivalentObjectGroup*>*>::const_iterator ci = possible_domains_per_term.begin(); ci != possible_domains_per_term.end(); ++ci)
+				if (terms_match)
 				{
-					delete *ci;
+					deletes_persistent_node = true;
+					break;
+				}
+			}
+			
+			if (deletes_persistent_node)
+			{
+				break;
+			}
+		}
+		
+		if (deletes_persistent_node)
+		{
+//			delete created_effect;
+			continue;
+		}
+
+		// Make sure the fact hasn't been reached before!
+		const EquivalentObjectGroup* best_eog = NULL;
+		bool zero_arity_reached_fact = created_effect->getReachableFact().getPredicate().getArity() == 0;
+		if (!zero_arity_reached_fact)
+		{
+			for (unsigned int i = 0; i < created_effect->getReachableFact().getPredicate().getArity(); i++)
+			{
+				const EquivalentObjectGroup& eog = created_effect->getReachableFact().getTermDomain(i);
+				if (best_eog == NULL)
+				{
+					best_eog = &eog;
+				}
+				
+				else if (best_eog->getReachableFacts().size() > eog.getReachableFacts().size())
+				{
+					best_eog = &eog;
 				}
 			}
 		}
-		return created_new_effect;
-	}
-	
-	ReachableSet* precondition_reachable_set = (*preconditions_reachable_sets_)[precondition_index];
-	std::vector<std::vector<unsigned int>* >* precondition_mappings = (*transition_->getPreconditionMappings().find(&precondition_reachable_set->getFactSet())).second;
-	
-	for (unsigned int tree_index = 0; tree_index < precondition_reachable_set->getCachedReachableTreesSize(); ++tree_index)
-	{
-		ReachableTree* current_tree = precondition_reachable_set->getReachableTrees()[tree_index];
-		
+		else
+		{
+			best_eog = &eog_manager.getZeroArityEOG();
+		}
+		
+#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
+		if (!created_effect->getReachableFact().getPredicate().isStatic())
+		{
+			std::cout << "New reachable effect: " << created_effect->getReachableFact() << "." << std::endl;
+		}
+#endif
+		
+		bool already_reached = false;
+		for (std::vector<ReachableFact*>::const_iterator ci = best_eog->getReachableFacts().begin(); ci != best_eog->getReachableFacts().end(); ci++)
+		{
+			if ((*ci)->isIdenticalTo(created_effect->getReachableFact()))
+			{
+#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_COMMENT
+				std::cout << "New reachable effect: " << created_effect->getReachableFact() << " already achieved by " << **ci << "." << std::endl;
+#endif
+				already_reached = true;
+				break;
+			}
+		}
+		if (already_reached)
+		{
+			fact_layer.addFact(*created_effect, true);
+//			delete &new_reachable_fact;
+			continue;
+		}
+#ifdef DTG_REACHABILITY_KEEP_TIME
+		++ReachableTransition::accepted_new_reachable_facts;
+#endif
+		std::vector<std::pair<ReachableSet*, unsigned int> >* listeners = (*effect_propagation_listeners_[created_effect->getEffectSetIndex()])[created_effect->getEffectIndex()];
+
+		for (std::vector<std::pair<ReachableSet*, unsigned int> >::const_iterator ci = listeners->begin(); ci != listeners->end(); ci++)
+		{
+			(*ci).first->processNewReachableFact(created_effect->getReachableFact(), (*ci).second);
+		}
+
 #ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
-		std::cout << *current_tree << " - Cached leafs: " << current_tree->getCachedNumberOfLeafs() << std::endl;
+		if (!created_effect->getReachableFact().getPredicate().isStatic())
+		{
+			std::cout << "New reachable effect: " << created_effect->getReachableFact() << "." << std::endl;
+		}
 #endif
+
+		new_facts_reached = true;
 		
-		for (unsigned int leaf_index = 0; leaf_index < current_tree->getCachedNumberOfLeafs(); ++leaf_index)
+		// Update the relevant equivalent object groups.
+		if (!zero_arity_reached_fact)
 		{
-			std::vector<EquivalentObjectGroup*> tmp_current_variable_assignments(current_variable_assignments);
-			std::vector<const ReachableFact*> new_preconditions(preconditions);
-			const ReachableTreeNode* leaf_node = current_tree->getLeaves()[leaf_index];
-			for (unsigned int fact_index = 0; fact_index < (*precondition_mappings).size(); ++fact_index)
+			for (unsigned int i = 0; i < created_effect->getReachableFact().getPredicate().getArity(); i++)
 			{
-				int current_index = (*precondition_mappings).size() - 1 - fact_index;
+				// Make sure not to add the fact to the same EOG!
+				EquivalentObjectGroup& to_add_to = created_effect->getReachableFact().getTermDomain(i);
 				
-				const ReachableFact& reachable_fact = leaf_node->getReachableFact();
-				std::vector<unsigned int>* variable_mappings = (*precondition_mappings)[current_index];
-				new_preconditions.push_back(&reachable_fact);
-				for (unsigned int term_index = 0; term_index < reachable_fact.getPredicate().getArity(); ++term_index)
+				bool already_added = false;
+				for (unsigned int j = 0; j < i; j++)
 				{
-					tmp_current_variable_assignments[(*variable_mappings)[term_index]] = &reachable_fact.getTermDomain(term_index);
+					EquivalentObjectGroup& previously_added_to = created_effect->getReachableFact().getTermDomain(j);
+					if (&to_add_to == &previously_added_to)
+					{
+						already_added = true;
+						break;
+					}
 				}
 				
-				leaf_node = leaf_node->getParent();
-			}
-			
-			if (generateReachableFacts(eog_manager, new_preconditions, tmp_current_variable_assignments, precondition_index + 1, new_fact_layer, persistent_facts))
-			{
-				created_new_effect = true;
+				if (!already_added)
+				{
+					created_effect->getReachableFact().getTermDomain(i).addReachableFact(created_effect->getReachableFact());
+				}
+//				else
+//				{
+//					std::cout << created_effect->getReachableFact() << " was already added: " << std::endl;
+//					std::cout << created_effect->getReachableFact().getTermDomain(i) << std::endl;
+//				}
 			}
 		}
+		else
+		{
+			eog_manager.getZeroArityEOG().addReachableFact(created_effect->getReachableFact());
+		}
+		
+		// Add the fact to the current fact layer.
+		fact_layer.addFact(*created_effect, false);
 	}
 	
-	return created_new_effect;
+#ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
+	std::cout << "[ReachableTransition::generateReachableFacts] Done generating facts. Did we make some new facts? " << new_facts_reached << std::endl;
+#endif
+	
+	return new_facts_reached;
 }
+*/
 
 /*
 bool ReachableTransition::generateReachableFacts(const EquivalentObjectGroupManager& eog_manager, ReachableFactLayer& new_fact_layer, const std::vector<const ReachableFact*>& persistent_facts)
@@ -2957,7 +3391,7 @@ bool ReachableTransition::generateReachableFacts(const MyPOP::REACHABILITY::Equi
 				const ReachableFact* reachable_fact = *ci;
 
 				if (effect->getPredicate().getArity() != reachable_fact->getPredicate().getArity() ||
-						effect->getPredicate().getName() != reachable_fact->getPredicate().getName())
+						effect->getPredicate().getNameId() != reachable_fact->getPredicate().getNameId())
 				{
 					continue;
 				}
@@ -3272,16 +3706,11 @@ bool ReachableTransition::generateReachableFacts(const MyPOP::REACHABILITY::Equi
 
 void ReachableTransition::equivalencesUpdated(unsigned int iteration)
 {
+	// The processed groups are indexed on the root nodes of their EOGs, which might have changed after merging.
+	processed_groups_index_.clear();
 	for (std::vector<const std::vector<EquivalentObjectGroup*>*>::const_iterator ci = processed_groups_.begin(); ci != processed_groups_.end(); ci++)
 	{
-		const std::vector<EquivalentObjectGroup*>* processed_group = *ci;
-		//for (unsigned int i = 0; i < transition_->getAction().getVariables().size(); i++)
-		for (std::vector<EquivalentObjectGroup*>::const_iterator ci = processed_group->begin(); ci != processed_group->end(); ++ci)
-		{
-			EquivalentObjectGroup* eog = *ci;
-			if (eog == NULL) continue;
-			eog = &eog->getRootNode();
-		}
+		processed_groups_index_.insert(std::make_pair(getProcessedGroupKey(**ci), *ci));
 	}
 }
 
@@ -3317,6 +3746,16 @@ ReachableFactLayerItem::~ReachableFactLayerItem()
 //	}
 }
 
+void* ReachableFactLayerItem::operator new (size_t size)
+{
+	return getThreadMemory().fact_layer_memory_.allocate(size);
+}
+
+void ReachableFactLayerItem::operator delete (void* p, size_t size)
+{
+	getThreadMemory().fact_layer_memory_.free(p, size);
+}
+
 bool ReachableFactLayerItem::canBeAchievedBy(const ResolvedBoundedAtom& precondition, StepID id, const Bindings& bindings, bool debug) const
 {
 	if (debug)
@@ -3324,7 +3763,7 @@ bool ReachableFactLayerItem::canBeAchievedBy(const ResolvedBoundedAtom& precondi
 		std::cout << "Can " << *reachable_fact_copy_ << " be achieved by: " << precondition << "?" << std::endl;
 	}
 	
-	if (precondition.getCorrectedAtom().getPredicate().getName() != reachable_fact_copy_->getPredicate().getName()) return false;
+	if (precondition.getCorrectedAtom().getPredicate().getNameId() != reachable_fact_copy_->getPredicate().getNameId()) return false;
 	if (precondition.getCorrectedAtom().getArity() != reachable_fact_copy_->getPredicate().getArity()) return false;
 	
 	for (unsigned int i = 0; i < precondition.getCorrectedAtom().getArity(); i++)
@@ -3408,10 +3847,26 @@ void ReachableFactLayerItem::addNoop(const ReachableFactLayerItem& noop)
 */
 	
 	preconditions->push_back(&noop);
-	AchievingTransition* at = new AchievingTransition(noop.getReachableFactLayer().getLayerNumber(), NULL, *preconditions, *eogs);
-	at->addEffect(noop, std::numeric_limits<unsigned int>::max(), std::numeric_limits<unsigned int>::max());
-	addAchiever(*at, std::numeric_limits<unsigned int>::max(), std::numeric_limits<unsigned int>::max());
-	AchievingTransition::storeAchievingTransition(*at);
+	AchievingTransition& at = AchievingTransition::createAchievingTransition(noop.getReachableFactLayer().getLayerNumber(), NULL, *preconditions, *eogs);
+	at.addEffect(noop, std::numeric_limits<unsigned int>::max(), std::numeric_limits<unsigned int>::max());
+	addAchiever(at, std::numeric_limits<unsigned int>::max(), std::numeric_limits<unsigned int>::max());
+}
+
+bool ReachableFactLayerItem::achieves(const GroundedAtom& atom) const
+{
+	if (atom.getPredicate().getArity() != reachable_fact_copy_->getPredicate().getArity())
+	{
+		return false;
+	}
+	
+	for (unsigned int i = 0; i < reachable_fact_copy_->getPredicate().getArity(); i++)
+	{
+		if (!reachable_fact_copy_->getTermDomain(i).contains(atom.getObject(i), reachable_fact_layer_->getLayerNumber()))
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
 /*
@@ -3493,7 +3948,7 @@ std::ostream& operator<<(std::ostream& os, const ReachableFactLayerItem& reachab
 }
 
 ReachableFactLayer::ReachableFactLayer(unsigned int nr, const ReachableFactLayer* previous_layer)
-	: nr_(nr), previous_layer_(previous_layer)
+	: nr_(nr), previous_layer_(previous_layer), is_indexed_(false)
 {
 	if (previous_layer_ != NULL)
 	{
@@ -3523,6 +3978,16 @@ ReachableFactLayer::ReachableFactLayer(unsigned int nr, const ReachableFactLayer
 	}
 }
 
+void* ReachableFactLayer::operator new (size_t size)
+{
+	return getThreadMemory().fact_layer_memory_.allocate(size);
+}
+
+void ReachableFactLayer::operator delete (void* p, size_t size)
+{
+	getThreadMemory().fact_layer_memory_.free(p, size);
+}
+
 ReachableFactLayer::~ReachableFactLayer()
 {
 	for (std::vector<ReachableFactLayerItem*>::const_iterator ci = reachable_facts_.begin(); ci != reachable_facts_.end(); ci++)
@@ -3554,17 +4019,20 @@ void ReachableFactLayer::removeAllFacts()
 		delete *ci;
 	}
 	reachable_facts_.clear();
+	is_indexed_ = false;
 }
 
 void ReachableFactLayer::addFact(ReachableFactLayerItem& reachable_fact)
 {
 	reachable_facts_.push_back(&reachable_fact);
+	is_indexed_ = false;
 }
 
 void ReachableFactLayer::addFact(const ReachableFact& reachable_fact)
 {
 	ReachableFactLayerItem* reachable_item = new ReachableFactLayerItem(*this, reachable_fact);
 	reachable_facts_.push_back(reachable_item);
+	is_indexed_ = false;
 }
 
 /*
@@ -3623,10 +4091,10 @@ const ReachableFactLayerItem* ReachableFactLayer::findPrecondition(const Reachab
 		}
 	}
 	
-	for (std::vector<ReachableFactLayerItem*>::const_iterator ci = reachable_facts_.begin(); ci != reachable_facts_.end(); ci++)
+	const std::vector<const ReachableFactLayerItem*>& candidates = getReachableFacts(reachable_fact.getPredicate());
+	for (std::vector<const ReachableFactLayerItem*>::const_iterator ci = candidates.begin(); ci != candidates.end(); ci++)
 	{
 		//if (&reachable_fact == &(*ci)->getActualReachableFact())
-		// TODO: Inefficient way of doing it...
 		if (reachable_fact.isIdenticalTo((*ci)->getActualReachableFact()))
 		{
 //			std::cout << "Found " << reachable_fact << "(" << &reachable_fact << " v.s. " << (*ci)->getActualReachableFact() << "(" << &(*ci)->getActualReachableFact() << ")" << std::endl;
@@ -3698,6 +4166,7 @@ void ReachableFactLayer::equivalencesUpdated(unsigned int layer_nr)
 			
 			delete lhs_item;
 			reachable_facts_.erase(ri.base() - 1);
+			is_indexed_ = false;
 		}
 	}
 }
@@ -3707,27 +4176,40 @@ const std::vector<ReachableFactLayerItem*>& ReachableFactLayer::getReachableFact
 	return reachable_facts_;
 }
 
-const ReachableFactLayerItem* ReachableFactLayer::contains(const GroundedAtom& atom) const
+const std::vector<const ReachableFactLayerItem*>& ReachableFactLayer::getReachableFacts(const Predicate& predicate) const
 {
-	for (std::vector<ReachableFactLayerItem*>::const_iterator ci = reachable_facts_.begin(); ci != reachable_facts_.end(); ci++)
+	if (!is_indexed_)
 	{
-		const ReachableFactLayerItem* reachable_item = *ci;
-		if (atom.getPredicate().getName() != reachable_item->getReachableFactCopy().getPredicate().getName()) continue;
-		if (atom.getPredicate().getArity() != reachable_item->getReachableFactCopy().getPredicate().getArity()) continue;
+		for (std::vector<std::vector<const ReachableFactLayerItem*> >::iterator i = reachable_facts_by_name_.begin(); i != reachable_facts_by_name_.end(); ++i)
+		{
+			(*i).clear();
+		}
 		
-		bool domain_match = true;
-		for (unsigned int i = 0; i < reachable_item->getReachableFactCopy().getPredicate().getArity(); i++)
+		for (std::vector<ReachableFactLayerItem*>::const_iterator ci = reachable_facts_.begin(); ci != reachable_facts_.end(); ++ci)
 		{
-			//if (!reachable_item->getReachableFactCopy().getTermDomain(i).contains(*static_cast<const Object*>(atom.getTerms()[i]), nr_))
-			if (!reachable_item->getReachableFactCopy().getTermDomain(i).contains(atom.getObject(i), nr_))
+			unsigned int name_id = (*ci)->getActualReachableFact().getPredicate().getNameId();
+			if (name_id >= reachable_facts_by_name_.size())
 			{
-				domain_match = false;
-				break;
+				reachable_facts_by_name_.resize(name_id + 1);
 			}
+			reachable_facts_by_name_[name_id].push_back(*ci);
+		}
+		is_indexed_ = true;
+	}
+	
+	static const std::vector<const ReachableFactLayerItem*> no_facts;
+	return predicate.getNameId() < reachable_facts_by_name_.size() ? reachable_facts_by_name_[predicate.getNameId()] : no_facts;
+}
+
+const ReachableFactLayerItem* ReachableFactLayer::contains(const GroundedAtom& atom) const
+{
+	const std::vector<const ReachableFactLayerItem*>& candidates = getReachableFacts(atom.getPredicate());
+	for (std::vector<const ReachableFactLayerItem*>::const_iterator ci = candidates.begin(); ci != candidates.end(); ci++)
+	{
+		if ((*ci)->achieves(atom))
+		{
+			return *ci;
 		}
-		if (!domain_match) continue;
-		
-		return reachable_item;
 	}
 	return NULL;
 }
@@ -3771,8 +4253,8 @@ std::ostream& operator<<(std::ostream& os, const ReachableFactLayer& reachable_f
 	return os;
 }
 
-DTGReachability::DTGReachability(const std::vector< MyPOP::HEURISTICS::LiftedTransition* >& lifted_transitions, const MyPOP::TermManager& term_manager, MyPOP::PredicateManager& predicate_manager, bool fully_grounded)
-	: term_manager_(&term_manager), current_fact_layer_(NULL), predicate_manager_(&predicate_manager), fully_grounded_(fully_grounded)
+DTGReachability::DTGReachability(const std::vector< MyPOP::HEURISTICS::LiftedTransition* >& lifted_transitions, const MyPOP::TermManager& term_manager, const MyPOP::PredicateManager& predicate_manager, bool fully_grounded)
+	: term_manager_(&term_manager), current_fact_layer_(NULL), predicate_manager_(&predicate_manager), lifted_transitions_(lifted_transitions), fully_grounded_(fully_grounded)
 {
 	std::vector<const HEURISTICS::FactSet*> fact_sets;
 	std::set<const HEURISTICS::FactSet*> processed_fact_sets;
@@ -3847,7 +4329,7 @@ DTGReachability::DTGReachability(const std::vector< MyPOP::HEURISTICS::LiftedTra
 				unsigned int index = std::distance(reachable_set->getFactSet().getFacts().begin(), ci);
 				const HEURISTICS::TransitionFact* fact = *ci;
 				
-				if (fact->getPredicate().getName() == corresponding_predicate->getName() &&
+				if (fact->getPredicate().getNameId() == corresponding_predicate->getNameId() &&
 				    fact->getPredicate().getArity() == corresponding_predicate->getArity())
 				{
 					(*predicate_id_to_reachable_sets_mapping_)[i]->push_back(std::make_pair(reachable_set, index));
@@ -3886,7 +4368,12 @@ DTGReachability::~DTGReachability()
 	AchievingTransition::removeAllAchievingTransitions();
 }
 
-void DTGReachability::performReachabilityAnalysis(std::vector<const ReachableFact*>& result, const std::vector<REACHABILITY::ReachableFact*>& initial_facts, const std::vector<const GroundedAtom*>& persistent_facts)
+HEURISTICS::HeuristicInterface* DTGReachability::clone() const
+{
+	return new DTGReachability(lifted_transitions_, *term_manager_, *predicate_manager_, fully_grounded_);
+}
+
+void DTGReachability::performReachabilityAnalysis(std::vector<const ReachableFact*>& result, const std::vector<REACHABILITY::ReachableFact*>& initial_facts, const std::vector<const GroundedAtom*>& persistent_facts, GoalIndex* goals_to_cover)
 {
 #ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
 	std::cout << "Start performing reachability analysis." << std::endl;
@@ -3967,6 +4454,10 @@ void DTGReachability::performReachabilityAnalysis(std::vector<const ReachableFac
 	
 	delete current_fact_layer_;
 	current_fact_layer_ = new ReachableFactLayer(0, NULL);
+	for (std::vector<std::vector<const ReachableFactLayerItem*> >::iterator i = achievers_by_name_.begin(); i != achievers_by_name_.end(); ++i)
+	{
+		(*i).clear();
+	}
 	
 	// Map the initial facts to this fact layer.
 	for (std::vector<ReachableFact*>::const_iterator ci = established_reachable_facts.begin(); ci != established_reachable_facts.end(); ci++)
@@ -4009,8 +4500,13 @@ void DTGReachability::performReachabilityAnalysis(std::vector<const ReachableFac
 
 	// Now for every LTG node for which we have found a full set we check if their reachable transitions have the same property and we
 	// can generate new reachable facts from these.
-	bool done = false;
+	bool goals_covered = goals_to_cover != NULL && goals_to_cover->update();
+	bool done = goals_covered;
 	unsigned int iteration = 1;
+	
+	// The EOGs which absorbed another EOG in the last iteration, combinations of leaves which contain these EOGs might
+	// have become possible.
+	boost::unordered_set<const EquivalentObjectGroup*> updated_eogs;
 	while (!done)
 	{
 #ifdef DTG_REACHABILITY_KEEP_TIME
@@ -4022,6 +4518,7 @@ void DTGReachability::performReachabilityAnalysis(std::vector<const ReachableFac
 		std::cout << *current_fact_layer_ << std::endl;
 #endif
 
+		addAchievers(*current_fact_layer_);
 		ReachableFactLayer* next_fact_layer = new ReachableFactLayer(iteration, current_fact_layer_);
 		current_fact_layer_ = next_fact_layer;
 
@@ -4062,9 +4559,12 @@ void DTGReachability::performReachabilityAnalysis(std::vector<const ReachableFac
 #endif
 
 		done = true;
+		
+		// The terms of the persistent facts are updated when EOGs are merged, so the index is rebuilt every iteration.
+		REACHABILITY::PersistentFactIndex persistent_fact_index(reachable_persistent_facts);
 		for (std::vector<ReachableTransition*>::const_iterator ci = reachable_transition_.begin(); ci != reachable_transition_.end(); ++ci)
 		{
-			if ((*ci)->generateReachableFacts(*equivalent_object_manager_, *current_fact_layer_, reachable_persistent_facts))
+			if ((*ci)->generateReachableFacts(*equivalent_object_manager_, *current_fact_layer_, persistent_fact_index, updated_eogs))
 			{
 				done = false;
 			}
@@ -4083,6 +4583,21 @@ void DTGReachability::performReachabilityAnalysis(std::vector<const ReachableFac
 			}
 			current_fact_layer_->equivalencesUpdated(iteration);
 			
+			updated_eogs.clear();
+			for (std::vector<EquivalentObjectGroup*>::const_iterator ci = equivalent_object_manager_->getEquivalentObjectGroups().begin(); ci != equivalent_object_manager_->getEquivalentObjectGroups().end(); ++ci)
+			{
+				if ((*ci)->isMergedAt(iteration))
+				{
+					updated_eogs.insert(&(*ci)->getRootNode());
+				}
+			}
+			
+			if (goals_to_cover != NULL && goals_to_cover->update())
+			{
+				goals_covered = true;
+				done = true;
+			}
+			
 			// Finally add all the noops.
 //			current_fact_layer_->finalise();
 		
@@ -4113,23 +4628,17 @@ void DTGReachability::performReachabilityAnalysis(std::vector<const ReachableFac
 
 		double time_spend_on_iteration = end_time_iteration.tv_sec - start_time_iteration.tv_sec + (end_time_iteration.tv_usec - start_time_iteration.tv_usec) / 1000000.0;
 		std::cerr << iteration << "th iteration. Number of EOGs: " << equivalent_object_manager_->getNumberOfEquivalentGroups() << ". Time spend: " << time_spend_on_iteration << "." << std::endl;
+		ThreadMemory& thread_memory = getThreadMemory();
+		std::cerr << "Leaves in the delta / leaves considered: " << thread_memory.delta_leaves_ << " / " << thread_memory.total_leaves_ << ". Merged EOGs: " << updated_eogs.size() << "." << std::endl;
+		thread_memory.delta_leaves_ = 0;
+		thread_memory.total_leaves_ = 0;
 		
 		unsigned int nr_leaves = 0;
-		for (std::vector<ReachableNode*>::const_iterator ci = reachable_nodes_.begin(); ci != reachable_nodes_.end(); ci++)
+		for (std::map<const HEURISTICS::FactSet*, ReachableSet*>::const_iterator ci = fact_set_to_reachable_set_.begin(); ci != fact_set_to_reachable_set_.end(); ++ci)
 		{
-			ReachableNode* reachable_node = *ci;
-			for (std::vector<ReachableTree*>::const_iterator ci = reachable_node->getReachableTrees().begin(); ci != reachable_node->getReachableTrees().end(); ci++)
-			{
-				nr_leaves += (*ci)->getTotalNumberOfLeafs();
-			}
-			for (std::vector<ReachableTransition*>::const_iterator ci = reachable_node->getReachableTransitions().begin(); ci != reachable_node->getReachableTransitions().end(); ci++)
+			for (std::vector<ReachableTree*>::const_iterator ti = (*ci).second->getReachableTrees().begin(); ti != (*ci).second->getReachableTrees().end(); ++ti)
 			{
-				ReachableTransition* reachable_transition = *ci;
-				
-				for (std::vector<ReachableTree*>::const_iterator ci = reachable_transition->getReachableTrees().begin(); ci != reachable_transition->getReachableTrees().end(); ci++)
-				{
-					nr_leaves += (*ci)->getTotalNumberOfLeafs();
-				}
+				nr_leaves += (*ti)->getTotalNumberOfLeafs();
 			}
 		}
 		std::cerr << "Total number of complete sets: " << nr_leaves << std::endl;
@@ -4137,8 +4646,11 @@ void DTGReachability::performReachabilityAnalysis(std::vector<const ReachableFac
 		++iteration;
 	}
 	
-	// Ignore the last fact layer since it will be empty.
-	current_fact_layer_->removeAllFacts();
+	// Ignore the last fact layer since it will be empty, unless we stopped because all the goals were covered.
+	if (!goals_covered)
+	{
+		current_fact_layer_->removeAllFacts();
+	}
 
 /*
 #ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_PERFORM_REACHABILITY_COMMENT
@@ -4155,8 +4667,13 @@ void DTGReachability::performReachabilityAnalysis(std::vector<const ReachableFac
 #endif
 */
 #ifdef DTG_REACHABILITY_KEEP_TIME
-	std::cerr << "Generated facts / Accepted facts [%] - " << ReachableTransition::generated_new_reachable_facts << " / " << ReachableTransition::accepted_new_reachable_facts << " [" << (((double)(ReachableTransition::accepted_new_reachable_facts) / ReachableTransition::generated_new_reachable_facts) * 100) << "%]" << std::endl;
+	struct timeval end_time_analysis;
+	gettimeofday(&end_time_analysis, NULL);
+	
+	double time_spend_on_analysis = end_time_analysis.tv_sec - start_time_eog.tv_sec + (end_time_analysis.tv_usec - start_time_eog.tv_usec) / 1000000.0;
+	std::cerr << "Reachability analysis: " << (iteration - 1) << " iterations in " << time_spend_on_analysis << " seconds." << std::endl;
 	std::cerr << "Compression rate " << 100 - ((double)equivalent_object_manager_->getNumberOfEquivalentGroups() / (double)total_number_of_eog) * 100 << std::endl;
+	std::cerr << getThreadMemory();
 #endif
 
 //	for (std::vector<const REACHABILITY::ReachableFact*>::const_iterator ci = reachable_persistent_facts.begin(); ci != reachable_persistent_facts.end(); ++ci)
@@ -4183,22 +4700,51 @@ void DTGReachability::setHeuristicForState(MyPOP::State& state, const std::vecto
 		deleteHelpfulActions();
 	}
 	
+	// Reuse the heuristic value if this state has been evaluated before. The helpful actions are extracted from the lifted RPG, so
+	// if we need them the reachability analysis must be performed.
+	std::vector<std::size_t> fact_keys;
+	if (!find_helpful_actions)
+	{
+		std::vector<std::size_t> goal_keys;
+		for (std::vector<const GroundedAtom*>::const_iterator ci = goal_facts.begin(); ci != goal_facts.end(); ++ci)
+		{
+			goal_keys.push_back((*ci)->getSignature());
+		}
+		
+		if (goal_keys != evaluated_goal_keys_ || evaluated_states_.size() >= MAX_EVALUATED_STATES)
+		{
+			evaluated_states_.clear();
+			evaluated_goal_keys_ = goal_keys;
+		}
+		
+		for (std::vector<unsigned int>::const_iterator ci = state.getFactIds().begin(); ci != state.getFactIds().end(); ++ci)
+		{
+			fact_keys.push_back(GroundedAtom::getGroundedAtom(*ci).getSignature());
+		}
+		std::sort(fact_keys.begin(), fact_keys.end());
+		
+		std::pair<boost::unordered_multimap<std::size_t, EvaluatedState>::const_iterator, boost::unordered_multimap<std::size_t, EvaluatedState>::const_iterator> candidates = evaluated_states_.equal_range(state.getSignature());
+		for (boost::unordered_multimap<std::size_t, EvaluatedState>::const_iterator ci = candidates.first; ci != candidates.second; ++ci)
+		{
+			const EvaluatedState& evaluated_state = (*ci).second;
+			if (evaluated_state.allow_new_goals_to_be_added_ == allow_new_goals_to_be_added && evaluated_state.fact_keys_ == fact_keys)
+			{
+				state.setDistanceToGoal(evaluated_state.heuristic_value_);
+				return;
+			}
+		}
+	}
+	
 	getEquivalentObjectGroupManager().reset();
 	std::vector<REACHABILITY::ReachableFact*> reachable_facts;
 	
 	std::vector<const GroundedAtom*> state_facts;
-	state.getFacts(initial_facts, state_facts);
+	state.getFacts(state_facts);
 	///for (std::vector<const GroundedAtom*>::const_iterator ci = state.getFacts().begin(); ci != state.getFacts().end(); ci++)
 	for (std::vector<const GroundedAtom*>::const_iterator ci = state_facts.begin(); ci != state_facts.end(); ci++)
 	{
 		const GroundedAtom* grounded_atom = *ci;
-		std::vector<REACHABILITY::EquivalentObjectGroup*>* variables = new std::vector<REACHABILITY::EquivalentObjectGroup*>(grounded_atom->getPredicate().getArity());
-		for (unsigned int i = 0; i < grounded_atom->getPredicate().getArity(); i++)
-		{
-			(*variables)[i] = &getEquivalentObjectGroupManager().getEquivalentObject(grounded_atom->getObject(i)).getEquivalentObjectGroup();
-		}
-		
-		reachable_facts.push_back(&REACHABILITY::ReachableFact::createReachableFact(grounded_atom->getPredicate(), *variables));
+		reachable_facts.push_back(&REACHABILITY::ReachableFact::createReachableFact(*grounded_atom, getEquivalentObjectGroupManager()));
 	}
 
 #ifdef MYPOP_FORWARD_CHAIN_PLANNER_COMMENTS
@@ -4217,12 +4763,19 @@ void DTGReachability::setHeuristicForState(MyPOP::State& state, const std::vecto
 	// Check which of the facts in the state correspond to the goal facts and prevent these from being deleted.
 	//if (!fully_grounded_)
 	{
+		boost::unordered_multimap<std::size_t, const GroundedAtom*> goals_by_signature;
+		for (std::vector<const GroundedAtom*>::const_iterator ci = goal_facts.begin(); ci != goal_facts.end(); ++ci)
+		{
+			goals_by_signature.insert(std::make_pair((*ci)->getSignature(), *ci));
+		}
+		
 		for (std::vector<const GroundedAtom*>::const_iterator ci = state_facts.begin(); ci != state_facts.end(); ci++)
 		{
 			const GroundedAtom* state_fact = *ci;
-			for (std::vector<const GroundedAtom*>::const_iterator ci = goal_facts.begin(); ci != goal_facts.end(); ++ci)
+			std::pair<boost::unordered_multimap<std::size_t, const GroundedAtom*>::const_iterator, boost::unordered_multimap<std::size_t, const GroundedAtom*>::const_iterator> candidates = goals_by_signature.equal_range(state_fact->getSignature());
+			for (boost::unordered_multimap<std::size_t, const GroundedAtom*>::const_iterator ci = candidates.first; ci != candidates.second; ++ci)
 			{
-				const GroundedAtom* goal_fact = *ci;
+				const GroundedAtom* goal_fact = (*ci).second;
 				
 				if (*state_fact == *goal_fact)
 				{
@@ -4240,44 +4793,8 @@ void DTGReachability::setHeuristicForState(MyPOP::State& state, const std::vecto
 	performReachabilityAnalysis(result, reachable_facts, persistent_facts);
 	
 	// Check if all the goals are reachable in the ultimate state of the lifted RPG.
-	bool all_goal_facts_are_achieved = true;
-	for (std::vector<const GroundedAtom*>::const_iterator ci = goal_facts.begin(); ci != goal_facts.end(); ++ci)
-	{
-		const GroundedAtom* goal_fact = *ci;
-		bool goal_fact_achieved = false;
-		for (std::vector<const REACHABILITY::ReachableFact*>::const_iterator ci = result.begin(); ci != result.end(); ++ci)
-		{
-			const REACHABILITY::ReachableFact* reachable_fact = *ci;
-			if (goal_fact->getPredicate().getArity() != reachable_fact->getPredicate().getArity() ||
-					goal_fact->getPredicate().getName() != goal_fact->getPredicate().getName())
-			{
-				continue;
-			}
-			
-			bool terms_match = true;
-			for (unsigned int i = 0; i < goal_fact->getPredicate().getArity(); ++i)
-			{
-				const REACHABILITY::EquivalentObjectGroup& eog = reachable_fact->getTermDomain(i);
-				if (!eog.contains(goal_fact->getObject(i)))
-				{
-					terms_match = false;
-					break;
-				}
-			}
-			
-			if (terms_match)
-			{
-				goal_fact_achieved = true;
-				break;
-			}
-		}
-		
-		if (!goal_fact_achieved)
-		{
-			all_goal_facts_are_achieved = false;
-			break;
-		}
-	}
+	GoalIndex goal_index(getEquivalentObjectGroupManager(), goal_facts);
+	bool all_goal_facts_are_achieved = goal_index.update();
 	
 	if (!all_goal_facts_are_achieved)
 	{
@@ -4288,19 +4805,13 @@ void DTGReachability::setHeuristicForState(MyPOP::State& state, const std::vecto
 		
 		
 		std::vector<const GroundedAtom*> state_facts;
-		state.getFacts(initial_facts, state_facts);
+		state.getFacts(state_facts);
 
 		///for (std::vector<const GroundedAtom*>::const_iterator ci = state.getFacts().begin(); ci != state.getFacts().end(); ci++)
 		for (std::vector<const GroundedAtom*>::const_iterator ci = state_facts.begin(); ci != state_facts.end(); ci++)
 		{
 			const GroundedAtom* grounded_atom = *ci;
-			std::vector<REACHABILITY::EquivalentObjectGroup*>* variables = new std::vector<REACHABILITY::EquivalentObjectGroup*>(grounded_atom->getPredicate().getArity());
-			for (unsigned int i = 0; i < grounded_atom->getPredicate().getArity(); i++)
-			{
-				(*variables)[i] = &getEquivalentObjectGroupManager().getEquivalentObject(grounded_atom->getObject(i)).getEquivalentObjectGroup();
-			}
-			
-			reachable_facts.push_back(&REACHABILITY::ReachableFact::createReachableFact(grounded_atom->getPredicate(), *variables));
+			reachable_facts.push_back(&REACHABILITY::ReachableFact::createReachableFact(*grounded_atom, getEquivalentObjectGroupManager()));
 		}
 //		std::cerr << "!";
 		performReachabilityAnalysis(result, reachable_facts, persistent_facts);
@@ -4312,6 +4823,15 @@ void DTGReachability::setHeuristicForState(MyPOP::State& state, const std::vecto
 	
 	unsigned int heuristic_value = getHeuristic(goal_facts, allow_new_goals_to_be_added, find_helpful_actions);
 	state.setDistanceToGoal(heuristic_value);
+	
+	if (!find_helpful_actions)
+	{
+		EvaluatedState evaluated_state;
+		evaluated_state.fact_keys_.swap(fact_keys);
+		evaluated_state.allow_new_goals_to_be_added_ = allow_new_goals_to_be_added;
+		evaluated_state.heuristic_value_ = heuristic_value;
+		evaluated_states_.insert(std::make_pair(state.getSignature(), evaluated_state));
+	}
 /*
 //	std::cerr << analyst.getHelpfulActions().size() << std::endl;
 	if (find_helpful_actions)
@@ -4323,6 +4843,26 @@ void DTGReachability::setHeuristicForState(MyPOP::State& state, const std::vecto
 */
 }
 
+bool DTGReachability::isDeadEnd(const MyPOP::State& state, const std::vector<const GroundedAtom*>& goal_facts)
+{
+	getEquivalentObjectGroupManager().reset();
+	std::vector<REACHABILITY::ReachableFact*> reachable_facts;
+	
+	std::vector<const GroundedAtom*> state_facts;
+	state.getFacts(state_facts);
+	for (std::vector<const GroundedAtom*>::const_iterator ci = state_facts.begin(); ci != state_facts.end(); ci++)
+	{
+		reachable_facts.push_back(&REACHABILITY::ReachableFact::createReachableFact(**ci, getEquivalentObjectGroupManager()));
+	}
+	
+	// Persistent facts only make fewer facts reachable, so without them a state is only a dead end if the goals are truly unreachable.
+	std::vector<const ReachableFact*> result;
+	std::vector<const GroundedAtom*> persistent_facts;
+	GoalIndex goal_index(getEquivalentObjectGroupManager(), goal_facts);
+	performReachabilityAnalysis(result, reachable_facts, persistent_facts, &goal_index);
+	return !goal_index.areAllGoalsCovered();
+}
+
 void DTGReachability::getFunctionalSymmetricSets(std::multimap<const Object*, const Object*>& symmetrical_groups, const State& state, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts, const TermManager& term_manager) const
 {
 	ReachableFact::deleteAllReachableFacts();
@@ -4330,7 +4870,7 @@ void DTGReachability::getFunctionalSymmetricSets(std::multimap<const Object*, co
 	std::vector<REACHABILITY::ReachableFact*> reachable_facts;
 	
 	std::vector<const GroundedAtom*> state_facts;
-	state.getFacts(initial_facts, state_facts);
+	state.getFacts(state_facts);
 
 	///for (std::vector<const GroundedAtom*>::const_iterator ci = state.getFacts().begin(); ci != state.getFacts().end(); ci++)
 	for (std::vector<const GroundedAtom*>::const_iterator ci = state_facts.begin(); ci != state_facts.end(); ci++)
@@ -4471,6 +5011,25 @@ void DTGReachability::getFunctionalSymmetricSets(std::multimap<const Object*, co
 	ReachableFact::deleteAllReachableFacts();
 }
 
+void DTGReachability::addAchievers(const ReachableFactLayer& fact_layer)
+{
+	for (std::vector<ReachableFactLayerItem*>::const_iterator ci = fact_layer.getReachableFacts().begin(); ci != fact_layer.getReachableFacts().end(); ++ci)
+	{
+		unsigned int name_id = (*ci)->getActualReachableFact().getPredicate().getNameId();
+		if (name_id >= achievers_by_name_.size())
+		{
+			achievers_by_name_.resize(name_id + 1);
+		}
+		achievers_by_name_[name_id].push_back(*ci);
+	}
+}
+
+const std::vector<const ReachableFactLayerItem*>& DTGReachability::getAchievers(const Predicate& predicate) const
+{
+	static const std::vector<const ReachableFactLayerItem*> no_achievers;
+	return predicate.getNameId() < achievers_by_name_.size() ? achievers_by_name_[predicate.getNameId()] : no_achievers;
+}
+
 std::pair<const ReachableFactLayerItem*, std::vector<const Object*>**> DTGReachability::createNewGoal(const GroundedAtom& resolved_goal)
 {
 #ifdef MYPOP_SAS_PLUS_DTG_REACHABILITY_GET_HEURISTIC_COMMENT
@@ -4478,17 +5037,15 @@ std::pair<const ReachableFactLayerItem*, std::vector<const Object*>**> DTGReacha
 #endif
 	
 	// Find the earliest layer where this goal is present.
-	const ReachableFactLayer* tmp_fact_layer = current_fact_layer_;
 	const ReachableFactLayerItem* earliest_known_achiever = NULL;
-	while (tmp_fact_layer != NULL)
+	const std::vector<const ReachableFactLayerItem*>& achievers = getAchievers(resolved_goal.getPredicate());
+	for (std::vector<const ReachableFactLayerItem*>::const_iterator ci = achievers.begin(); ci != achievers.end(); ++ci)
 	{
-//		std::cout << *tmp_fact_layer << std::endl;
-		const ReachableFactLayerItem* reachable_goal = tmp_fact_layer->contains(resolved_goal);
-		if (reachable_goal != NULL)
+		if ((*ci)->achieves(resolved_goal))
 		{
-			earliest_known_achiever = reachable_goal;
+			earliest_known_achiever = *ci;
+			break;
 		}
-		tmp_fact_layer = tmp_fact_layer->getPreviousLayer();
 	}
 	
 	// Goal is unattainable!
@@ -4526,7 +5083,7 @@ std::pair<const ReachableFactLayerItem*, std::vector<const Object*>**> DTGReacha
 	return std::make_pair(earliest_known_achiever, grounded_objects);
 }
 
-std::pair<const ReachableFactLayerItem*, std::vector<const Object*>**> DTGReachability::findFactWhichAchieves(const ReachableFactLayerItem& current_goal, std::vector<const Object*>** object_bindings, std::set<std::pair<const EquivalentObject*, const EquivalentObject*> >& combined_eogs_)
+std::pair<const ReachableFactLayerItem*, std::vector<const Object*>**> DTGReachability::findFactWhichAchieves(const ReachableFactLayerItem& current_goal, std::vector<const Object*>** object_bindings, boost::unordered_set<std::pair<const EquivalentObject*, const EquivalentObject*> >& combined_eogs_)
 {
 	// Check if the substitutions have already been made.
 	bool substitutions_have_already_been_made = true;
@@ -4579,58 +5136,52 @@ std::pair<const ReachableFactLayerItem*, std::vector<const Object*>**> DTGReacha
 		}
 	}
 */
-	// Add a new goal based on the value we expected to find.
-	const ReachableFactLayer* tmp_layer = current_fact_layer_;
+	// Add a new goal based on the value we expected to find, the earliest fact which matches it is used.
 	const ReachableFactLayerItem* matching_fact_item_layer = NULL;
-	while (tmp_layer != NULL)
+	const std::vector<const ReachableFactLayerItem*>& candidates = getAchievers(current_goal.getActualReachableFact().getPredicate());
+	for (std::vector<const ReachableFactLayerItem*>::const_iterator ci = candidates.begin(); ci != candidates.end(); ++ci)
 	{
-		for (std::vector<ReachableFactLayerItem*>::const_iterator ci = tmp_layer->getReachableFacts().begin(); ci != tmp_layer->getReachableFacts().end(); ++ci)
+		const ReachableFactLayerItem* layer_item = *ci;
+		const ReachableFact& reachable_fact = layer_item->getReachableFactCopy();
+		
+		if (reachable_fact.getPredicate().getArity() != current_goal.getActualReachableFact().getPredicate().getArity())
 		{
-			const ReachableFactLayerItem* layer_item = *ci;
-			const ReachableFact& reachable_fact = layer_item->getReachableFactCopy();
-			
-			if (reachable_fact.getPredicate().getArity() != current_goal.getActualReachableFact().getPredicate().getArity() ||
-			    reachable_fact.getPredicate().getName() != current_goal.getActualReachableFact().getPredicate().getName())
-			{
-				continue;
-			}
+			continue;
+		}
+		
+		bool terms_match = true;
+		for (unsigned int i = 0; i < reachable_fact.getPredicate().getArity(); ++i)
+		{
+			const std::vector<const Object*>* goal_variable_domain = object_bindings[i];
+			const EquivalentObjectGroup& fact_variable_domain = reachable_fact.getTermDomain(i);
 			
-			bool terms_match = true;
-			for (unsigned int i = 0; i < reachable_fact.getPredicate().getArity(); ++i)
+			for (std::vector<const Object*>::const_iterator ci = goal_variable_domain->begin(); ci != goal_variable_domain->end(); ++ci)
 			{
-				const std::vector<const Object*>* goal_variable_domain = object_bindings[i];
-				const EquivalentObjectGroup& fact_variable_domain = reachable_fact.getTermDomain(i);
-				
-				for (std::vector<const Object*>::const_iterator ci = goal_variable_domain->begin(); ci != goal_variable_domain->end(); ++ci)
-				{
-					const Object* object = *ci;
-					if (!fact_variable_domain.contains(*object, tmp_layer->getLayerNumber()))
-					{
-						terms_match = false;
-						break;
-					}
-				}
-				if (!terms_match)
+				const Object* object = *ci;
+				if (!fact_variable_domain.contains(*object, layer_item->getReachableFactLayer().getLayerNumber()))
 				{
+					terms_match = false;
 					break;
 				}
 			}
-			
-			if (terms_match)
+			if (!terms_match)
 			{
-				matching_fact_item_layer = layer_item;
 				break;
 			}
 		}
 		
-		tmp_layer = tmp_layer->getPreviousLayer();
+		if (terms_match)
+		{
+			matching_fact_item_layer = layer_item;
+			break;
+		}
 	}
 	assert (matching_fact_item_layer != NULL);
 	
 	return std::make_pair(matching_fact_item_layer, object_bindings);
 }
 
-unsigned int DTGReachability::makeSubstitutions(const ReachableFactLayerItem& current_goal, std::vector< const MyPOP::Object* >** object_bindings, std::set< std::pair< const EquivalentObject*, const EquivalentObject* > >& made_substitutions)
+unsigned int DTGReachability::makeSubstitutions(const ReachableFactLayerItem& current_goal, std::vector< const MyPOP::Object* >** object_bindings, boost::unordered_set<std::pair<const EquivalentObject*, const EquivalentObject*> >& made_substitutions)
 {
 	unsigned int substitution_cost = 0;
 	// Check if the variables still match up.
@@ -4780,9 +5331,10 @@ void DTGReachability::substitute(const EquivalentObject& lhs, const EquivalentOb
 		const ReachableFactLayerItem* initial_item = *ci;
 		bool contains_lhs = false;
 		
-		for (std::vector<EquivalentObjectGroup*>::const_iterator ci = initial_item->getReachableFactCopy().getTermDomains().begin(); ci != initial_item->getReachableFactCopy().getTermDomains().end(); ++ci)
+		const ReachableFact& initial_fact = initial_item->getReachableFactCopy();
+		for (unsigned int term_index = 0; term_index < initial_fact.getPredicate().getArity(); ++term_index)
 		{
-			EquivalentObjectGroup* eog = *ci;
+			EquivalentObjectGroup* eog = &initial_fact.getTermDomain(term_index);
 			if (eog->contains(lhs.getObject(), 0))
 			{
 				contains_lhs = true;
@@ -4795,24 +5347,23 @@ void DTGReachability::substitute(const EquivalentObject& lhs, const EquivalentOb
 			continue;
 		}
 		
-		std::vector<EquivalentObjectGroup*>* domains = new std::vector<EquivalentObjectGroup*>();
+		std::vector<EquivalentObjectGroup*> domains;
 		
-		std::vector<const Object*>** variable_domains = new std::vector<const Object*>*[initial_item->getReachableFactCopy().getTermDomains().size()];
+		std::vector<const Object*>** variable_domains = new std::vector<const Object*>*[initial_fact.getPredicate().getArity()];
 		
-		for (std::vector<EquivalentObjectGroup*>::const_iterator ci = initial_item->getReachableFactCopy().getTermDomains().begin(); ci != initial_item->getReachableFactCopy().getTermDomains().end(); ++ci)
+		for (unsigned int term_index = 0; term_index < initial_fact.getPredicate().getArity(); ++term_index)
 		{
-			unsigned int term_index = std::distance(initial_item->getReachableFactCopy().getTermDomains().begin(), ci);
 			std::vector<const Object*>* variable_domain = new std::vector<const Object*>();
 			variable_domains[term_index] = variable_domain;
-			EquivalentObjectGroup* eog = *ci;
+			EquivalentObjectGroup* eog = &initial_fact.getTermDomain(term_index);
 			if (eog->contains(lhs.getObject(), 0))
 			{
-				domains->push_back(&rhs.getEquivalentObjectGroup());
+				domains.push_back(&rhs.getEquivalentObjectGroup());
 				variable_domain->push_back(&rhs.getObject());
 			}
 			else
 			{
-				domains->push_back(eog);
+				domains.push_back(eog);
 				for (std::vector<EquivalentObject*>::const_iterator ci = eog->begin(0); ci != eog->end(0); ++ci)
 				{
 					variable_domain->push_back(&(*ci)->getObject());
@@ -4820,7 +5371,7 @@ void DTGReachability::substitute(const EquivalentObject& lhs, const EquivalentOb
 			}
 		}
 			
-		ReachableFact reachable_fact(initial_item->getReachableFactCopy().getPredicate(), *domains);
+		const ReachableFact& reachable_fact = ReachableFact::createReachableFact(initial_fact.getPredicate(), domains);
 		
 		// Find a fact layer where this reachable fact is true.
 		const ReachableFactLayerItem* found_layer_item = NULL;
@@ -5042,7 +5593,7 @@ unsigned int DTGReachability::getHeuristic(const std::vector<const GroundedAtom*
 					for (std::vector<std::pair<const Predicate*, std::vector<const Object*>** > >::const_iterator ci = newly_added_goals.begin(); ci != newly_added_goals.end(); ++ci)
 					{
 						if (predicate.getArity() != (*ci).first->getArity() ||
-							predicate.getName() != (*ci).first->getName())
+							predicate.getNameId() != (*ci).first->getNameId())
 						{
 							continue;
 						}
@@ -5316,7 +5867,7 @@ unsigned int DTGReachability::getHeuristic(const std::vector<const GroundedAtom*
 			
 			for (unsigned int term_index = 0; term_index < precondition_item->getReachableFactCopy().getPredicate().getArity(); ++term_index)
 			{
-				EquivalentObjectGroup* fact_layer_precondition_eog = precondition_item->getReachableFactCopy().getTermDomains()[term_index];
+				EquivalentObjectGroup* fact_layer_precondition_eog = &precondition_item->getReachableFactCopy().getTermDomain(term_index);
 
 				std::vector<const Object*>* precondition_term_domain = new std::vector<const Object*>();
 				precondition_object_bindings[term_index] = precondition_term_domain;
@@ -5373,7 +5924,7 @@ unsigned int DTGReachability::getHeuristic(const std::vector<const GroundedAtom*
 				{
 					const Atom* atom = *ci;
 					if (precondition->getReachableFactCopy().getPredicate().getArity() != atom->getPredicate().getArity() ||
-					    precondition->getReachableFactCopy().getPredicate().getName() != atom->getPredicate().getName())
+					    precondition->getReachableFactCopy().getPredicate().getNameId() != atom->getPredicate().getNameId())
 					{
 						continue;
 					}
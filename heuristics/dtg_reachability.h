@@ -9,6 +9,8 @@
 #include <stdio.h>
 #include <queue>
 #include <ostream>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 
 #include "plan_types.h"
 #include "utility/memory_pool.h"
@@ -21,6 +23,7 @@ class GroundedAtom;
 
 
 class Atom;
+class Action;
 class Bindings;
 class Object;
 class Predicate;
@@ -70,7 +73,7 @@ class ReachableFact
 public:
 //	static ReachableFact& createReachableFact(const SAS_Plus::BoundedAtom& bounded_atom, const Bindings& bindings, const EquivalentObjectGroupManager& eog_manager);
 	
-	static ReachableFact& createReachableFact(const Predicate& predicate, std::vector<EquivalentObjectGroup*>& term_domain_mapping, bool allow_reuse = false);
+	static ReachableFact& createReachableFact(const Predicate& predicate, const std::vector<EquivalentObjectGroup*>& term_domain_mapping, bool allow_reuse = false);
 	
 	static ReachableFact& createReachableFact(const GroundedAtom& grounded_atom, const EquivalentObjectGroupManager& eog_manager, bool allow_reuse = false);
 	
@@ -79,12 +82,6 @@ public:
 	static void deleteAllReachableFacts(const std::vector< MyPOP::REACHABILITY::ReachableFact* >& initial_facts);
 	static void deleteAllReachableFacts();
 	
-	~ReachableFact();
-	
-//	static void* operator new (size_t size);
-	
-//	static void operator delete (void* p);
-	
 	/**
 	 * This method is called everytime a merge has taken place which involves a Equivalent Object Group 
 	 * which is part of this reachable fact. In such an occasion we end up with at least one term in this
@@ -114,9 +111,6 @@ public:
 	
 	EquivalentObjectGroup& getTermDomain(unsigned int index) const;
 	
-//	EquivalentObjectGroup** getTermDomains() const { return term_domain_mapping_; }
-	const std::vector<EquivalentObjectGroup*>& getTermDomains() const { return *term_domain_mapping_; }
-	
 //	const Atom& getAtom() const { return *atom_; }
 	const Predicate& getPredicate() const { return *predicate_; }
 	
@@ -142,11 +136,27 @@ public:
 	
 	void print(std::ostream& os, unsigned int iteration) const;
 	
-	ReachableFact(const Predicate& predicate, std::vector<EquivalentObjectGroup*>& term_domain_mapping);
-	
 private:
 	
-	static std::vector<ReachableFact*> all_created_reachable_facts_;
+	/**
+	 * Every thread which evaluates a heuristic owns its own store of reachable facts.
+	 */
+	friend struct ThreadMemory;
+	
+	/**
+	 * Reachable facts are allocated from the memory pools of the thread which creates them, the terms are stored directly
+	 * after the reachable fact so a fact and its terms take a single allocation.
+	 * @param arity The number of terms of the reachable fact.
+	 */
+	static void* operator new (size_t size, unsigned int arity);
+	static void operator delete (void* p, unsigned int arity);
+	
+	/**
+	 * Return the memory of @param reachable_fact to the memory pool it has been allocated from.
+	 */
+	static void destroy(ReachableFact& reachable_fact);
+	
+	ReachableFact(const Predicate& predicate, const std::vector<EquivalentObjectGroup*>& term_domain_mapping);
 	
 //	ReachableFact(const SAS_Plus::BoundedAtom& bounded_atom, const Bindings& bindings, const EquivalentObjectGroupManager& eog_manager);
 	
@@ -157,11 +167,13 @@ private:
 	ReachableFact(const ReachableFact& reachable_fact);
 	
 	ReachableFact& operator=(const ReachableFact& other);
+	
+	// The terms are part of the same allocation, so there is nothing to delete.
+	~ReachableFact() { }
 
 	const Predicate* predicate_;
 	
-	//EquivalentObjectGroup** term_domain_mapping_;
-	std::vector<EquivalentObjectGroup*>* term_domain_mapping_;
+	EquivalentObjectGroup** term_domain_mapping_;
 	
 	// During the construction of the reachability graph terms can be merged and because of that some reachable facts are
 	// removed because they have become identical to others. E.g. consider the following two reachable facts:
@@ -307,6 +319,16 @@ public:
 	
 private:
 	
+	/**
+	 * @return The key of @param reachable_fact in @ref reachable_set_index_, based on its term domains.
+	 */
+	static std::size_t getKey(const ReachableFact& reachable_fact);
+	
+	/**
+	 * Rebuild @ref reachable_set_index_ from @ref reachable_set_.
+	 */
+	void rebuildIndex();
+	
 	const EquivalentObjectGroupManager* eog_manager_;
 	
 	const HEURISTICS::FactSet* fact_set_;
@@ -315,6 +337,10 @@ private:
 	// that bounded atom.
 	std::vector<std::list<ReachableFact*>*> reachable_set_;
 	
+	// For every bounded atom in this set, the reachable facts in @ref reachable_set_ indexed by their term domains. These are
+	// root nodes, so the index has to be rebuild when the equivalences have been updated.
+	std::vector<boost::unordered_multimap<std::size_t, ReachableFact*>*> reachable_set_index_;
+	
 	// All the facts which have been combined into a partial of complete assignment to all the facts in the set.
 	std::vector<ReachableTree*> reachability_tree_;
 	
@@ -428,8 +454,15 @@ public:
 	
 	~AchievingTransition();
 	
+	/**
+	 * Create an achieving transition which is deleted by @ref removeAllAchievingTransitions. It is allocated from the
+	 * memory pools of the calling thread, so the memory is reused by the next heuristic evaluation.
+	 * @param preconditions Owned by the created achieving transition.
+	 * @param variables Owned by the created achieving transition.
+	 */
+	static AchievingTransition& createAchievingTransition(unsigned int fact_layer_index, const ReachableTransition* achiever, const std::vector<const ReachableFactLayerItem*>& preconditions, const std::vector<EquivalentObjectGroup*>& variables);
+	
 	static void removeAllAchievingTransitions();
-	static void storeAchievingTransition(const AchievingTransition& achieving_transition);
 	
 	void addEffect(const ReachableFactLayerItem& effect, unsigned int effect_set_index, unsigned int effect_index);
 	
@@ -466,11 +499,59 @@ private:
 	//const EquivalentObjectGroup** variables_;
 	const std::vector<EquivalentObjectGroup*>* variables_;
 	
-	static std::vector<const AchievingTransition*> all_created_achieving_transitions_;
+	/**
+	 * Every thread which evaluates a heuristic owns its own store of achieving transitions.
+	 */
+	static std::vector<AchievingTransition*>& getAllCreatedAchievingTransitions();
 };
 
 std::ostream& operator<<(std::ostream& os, const AchievingTransition& executed_action);
 
+/**
+ * The facts which must not be deleted during the reachability analysis, indexed on their predicate and terms so whether a
+ * transition deletes one of them is a lookup.
+ */
+class PersistentFactIndex
+{
+public:
+	PersistentFactIndex(const std::vector<const ReachableFact*>& persistent_facts);
+	
+	/**
+	 * @param variable_assignments The EOGs assigned to the variables of @param action, NULL if a variable is not bound.
+	 * @return True if a negative effect of @param action deletes a persistent fact.
+	 */
+	bool isDeletedBy(const Action& action, const std::vector<EquivalentObjectGroup*>& variable_assignments) const;
+	
+private:
+	boost::unordered_multimap<std::size_t, const ReachableFact*> persistent_facts_;
+};
+
+/**
+ * The goals of a reachability analysis. A goal is covered once a fact with the same predicate has been reached whose term
+ * domains contain the objects of the goal. The candidates are the reachable facts of the root EOGs of the objects of the goal,
+ * so a goal is only compared with the facts of the EOG which has the fewest of them instead of with all reachable facts.
+ */
+class GoalIndex
+{
+public:
+	GoalIndex(const EquivalentObjectGroupManager& eog_manager, const std::vector<const GroundedAtom*>& goals);
+	
+	/**
+	 * Check which of the goals which were not covered yet are covered by the facts reached so far. EOGs are merged during
+	 * the analysis, so a goal can become covered without a new fact being reached.
+	 * @return True if all the goals are covered.
+	 */
+	bool update();
+	
+	bool areAllGoalsCovered() const { return uncovered_goals_.empty(); }
+	
+private:
+	bool isCovered(const GroundedAtom& goal) const;
+	
+	const EquivalentObjectGroupManager* eog_manager_;
+	std::vector<const GroundedAtom*> uncovered_goals_;
+};
+
 /**
  * When a transition is reachable we state that the transition is reachable for all possible mappings of the from node
  * of that transition. However, we need to keep track of all the domains of variables which are not present in the from node.
@@ -494,9 +575,12 @@ public:
 	
 	/**
 	 * Generate all the possible new reachable facts by combining the full sets of this reachable transition with those
-	 * of its from node.
+	 * of its from node. Only the combinations which contain at least one leaf which has not been processed yet or
+	 * which contains an EOG in @param updated_eogs are tried, all other combinations have been tried in the previous
+	 * iterations.
+	 * @param updated_eogs The root nodes of the EOGs which were merged with another EOG in the previous iteration.
 	 */
-	bool generateReachableFacts(const MyPOP::REACHABILITY::EquivalentObjectGroupManager& eog_manager, MyPOP::REACHABILITY::ReachableFactLayer& new_fact_layer, const std::vector< const MyPOP::REACHABILITY::ReachableFact* >& persistent_facts);
+	bool generateReachableFacts(const EquivalentObjectGroupManager& eog_manager, ReachableFactLayer& new_fact_layer, const PersistentFactIndex& persistent_facts, const boost::unordered_set<const EquivalentObjectGroup*>& updated_eogs);
 	
 	void equivalencesUpdated(unsigned int iteration);
 	
@@ -504,7 +588,55 @@ public:
 	
 	//void print(std::ostream& os) const;
 private:
-	bool generateReachableFacts(const EquivalentObjectGroupManager& eog_manager, std::vector<const ReachableFact*>& preconditions, std::vector<EquivalentObjectGroup*>& current_variable_assignments, unsigned int precondition_index, MyPOP::REACHABILITY::ReachableFactLayer& new_fact_layer, const std::vector<const ReachableFact*>& persistent_facts);
+	
+	/**
+	 * The leaves of the reachable trees of a precondition set, indexed on the action variables the set shares with the
+	 * precondition sets joined before it.
+	 */
+	struct JoinRelation
+	{
+		const std::vector<std::vector<unsigned int>* >* precondition_mappings_;
+		std::vector<const ReachableTreeNode*> leaves_;
+		// The action variables bound by the precondition sets joined before this one.
+		std::vector<unsigned int> join_variables_;
+		// The indexes of the leaves in @ref leaves_, keyed on the EOGs they assign to the join variables.
+		boost::unordered_map<std::size_t, std::vector<unsigned int> > index_;
+		// For every leaf in @ref leaves_, true if it is part of the delta of this iteration.
+		std::vector<bool> delta_;
+	};
+	
+	/**
+	 * @return True if @param leaf has not been processed before, or if the facts on the path to its root contain an
+	 * EOG in @param updated_eogs.
+	 */
+	static bool isDelta(const ReachableTreeNode& leaf, unsigned int depth, const boost::unordered_set<const EquivalentObjectGroup*>& updated_eogs);
+	
+	/**
+	 * Assign the EOGs of the facts on the path from @param leaf to the root to the action variables.
+	 * @return False if an EOG conflicts with an EOG already assigned to the same variable in @param variable_assignments.
+	 */
+	static bool bindLeaf(const ReachableTreeNode& leaf, const std::vector<std::vector<unsigned int>* >& precondition_mappings, std::vector<EquivalentObjectGroup*>& variable_assignments);
+	
+	static std::size_t getJoinKey(const std::vector<unsigned int>& variables, const std::vector<EquivalentObjectGroup*>& variable_assignments);
+	
+	/**
+	 * Extend the partial assignment with a leaf of the @param step-th precondition set in @param join_order, and recurse
+	 * until every precondition set has been joined. Every combination with a leaf in the delta is joined exactly once:
+	 * the leaf of the @param delta_step-th precondition set must be in the delta, the leaves of the precondition sets
+	 * before it must not.
+	 */
+	bool join(const EquivalentObjectGroupManager& eog_manager, const std::vector<JoinRelation>& relations, const std::vector<unsigned int>& join_order, unsigned int step, unsigned int delta_step, const std::vector<EquivalentObjectGroup*>& variable_assignments, std::vector<const ReachableTreeNode*>& selected_leaves, ReachableFactLayer& new_fact_layer, const PersistentFactIndex& persistent_facts);
+	
+	/**
+	 * Create the effects of this transition for a full assignment of its preconditions.
+	 */
+	bool createReachableFacts(const EquivalentObjectGroupManager& eog_manager, const std::vector<const ReachableFact*>& preconditions, const std::vector<EquivalentObjectGroup*>& current_variable_assignments, ReachableFactLayer& new_fact_layer, const PersistentFactIndex& persistent_facts);
+	
+	/**
+	 * @return The key of @param variable_assignments in @ref processed_groups_index_.
+	 */
+	static std::size_t getProcessedGroupKey(const std::vector<EquivalentObjectGroup*>& variable_assignments);
+	
 //	void generateReachableFacts(const MyPOP::REACHABILITY::EquivalentObjectGroupManager& eog_manager, std::vector< const MyPOP::REACHABILITY::AchievingTransition* >& newly_created_reachable_facts, std::vector< const MyPOP::REACHABILITY::ReachableFact* >& preconditions, std::vector< MyPOP::REACHABILITY::EquivalentObjectGroup* >& current_variable_assignments, unsigned int precondition_index, const MyPOP::REACHABILITY::ReachableFactLayer& fact_layer);
 	
 	const HEURISTICS::LiftedTransition* transition_;
@@ -514,6 +646,8 @@ private:
 	// Cache all the groups which have been processed so we do not create the same reachable facts from this
 	// node over and over again.
 	std::vector<const std::vector<EquivalentObjectGroup*>*> processed_groups_;
+	// The groups in @ref processed_groups_ keyed on the root nodes of their EOGs, rebuild when the equivalences are updated.
+	boost::unordered_multimap<std::size_t, const std::vector<EquivalentObjectGroup*>*> processed_groups_index_;
 	
 	std::vector<std::vector<std::vector<std::pair<ReachableSet*, unsigned int> >* >* > effect_propagation_listeners_;
 	//std::map<std::pair<unsigned int, unsigned int>, std::vector<std::pair<ReachableSet*, unsigned int> >* > effect_propagation_listeners_;
@@ -533,6 +667,13 @@ public:
 	ReachableFactLayerItem(const ReachableFactLayer& reachable_fact_layer, const ReachableFact& reachable_fact);
 	~ReachableFactLayerItem();
 	
+	/**
+	 * The fact layers are rebuilt for every heuristic evaluation, their items are recycled through the memory pools of the
+	 * thread which evaluates the heuristic.
+	 */
+	static void* operator new (size_t size);
+	static void operator delete (void* p, size_t size);
+	
 	bool canBeAchievedBy(const ResolvedBoundedAtom& precondition, StepID id, const Bindings& bindings, bool debug) const;
 	
 	//void addAchiever(const ReachableTransition& achiever, const ReachableTreeNode& from_tree_node, const ReachableTreeNode* transition_tree_node);
@@ -549,6 +690,11 @@ public:
 	const ReachableFact& getReachableFactCopy() const { return *reachable_fact_copy_; }
 	const ReachableFact& getActualReachableFact() const { return *link_to_actual_reachable_fact_; }
 	
+	/**
+	 * @return True if the fact of this item contains @param atom in the layer of this item.
+	 */
+	bool achieves(const GroundedAtom& atom) const;
+	
 	const ReachableFactLayer& getReachableFactLayer() const { return *reachable_fact_layer_; }
 	
 private:
@@ -568,6 +714,12 @@ class ReachableFactLayer
 public:
 	ReachableFactLayer(unsigned int nr, const ReachableFactLayer* previous_layer);
 	~ReachableFactLayer();
+	
+	/**
+	 * Fact layers are recycled through the memory pools of the thread which evaluates the heuristic.
+	 */
+	static void* operator new (size_t size);
+	static void operator delete (void* p, size_t size);
 	//void finalise();
 	
 	void removeAllFacts();
@@ -579,6 +731,12 @@ public:
 	void addFact(ReachableFactLayerItem& reachable_fact);
 	//void addFact(const AchievingTransition& achieved_transition, bool already_exists);
 	const std::vector<ReachableFactLayerItem*>& getReachableFacts() const;
+	
+	/**
+	 * @return The facts of this layer whose predicate has the same name as @param predicate, in the order they were added.
+	 */
+	const std::vector<const ReachableFactLayerItem*>& getReachableFacts(const Predicate& predicate) const;
+	
 	const ReachableFactLayerItem* contains(const GroundedAtom& atom) const;
 	unsigned int getLayerNumber() const;
 	const ReachableFactLayer* getPreviousLayer() const;
@@ -589,6 +747,11 @@ private:
 	unsigned int nr_;
 	const ReachableFactLayer* previous_layer_;
 	std::vector<ReachableFactLayerItem*> reachable_facts_;
+	
+	// The facts indexed by the name id of their predicate. A layer is no longer changed once the next layer has been created, so
+	// the index is built the first time it is needed and only rebuilt if facts are added or removed afterwards.
+	mutable std::vector<std::vector<const ReachableFactLayerItem*> > reachable_facts_by_name_;
+	mutable bool is_indexed_;
 };
 
 class compareReachableFactLayerItem
@@ -614,10 +777,16 @@ public:
 	 */
 //	DTGReachability(const SAS_Plus::DomainTransitionGraphManager& dtg_manager, const SAS_Plus::DomainTransitionGraph& dtg_graph, const TermManager& term_manager, PredicateManager& predicate_manager);
 
-	DTGReachability(const std::vector<HEURISTICS::LiftedTransition*>& lifted_transitions, const TermManager& term_manager, PredicateManager& predicate_manager, bool fully_grounded = false);
+	DTGReachability(const std::vector<HEURISTICS::LiftedTransition*>& lifted_transitions, const TermManager& term_manager, const PredicateManager& predicate_manager, bool fully_grounded = false);
 	
 	~DTGReachability();
 	
+	/**
+	 * Create a new lifted RPG from the same lifted transitions, the copy does not share any of the structures which are
+	 * modified during a reachability analysis.
+	 */
+	HeuristicInterface* clone() const;
+	
 	void setHeuristicForState(MyPOP::State& state, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts, const TermManager& term_manager, bool find_helpful_actions, bool allow_new_goals_to_be_added);
 	
 	/**
@@ -625,6 +794,13 @@ public:
 	 */
 	void getFunctionalSymmetricSets(std::multimap<const Object*, const Object*>& symmetrical_groups, const State& state, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts, const TermManager& term_manager) const;
 	
+	/**
+	 * Check whether @param goal_facts are reachable from @param state in the lifted RPG. The analysis stops as soon as all
+	 * the goals are covered, so the lifted RPG is not complete afterwards and cannot be used to extract a relaxed plan.
+	 * @return True if at least one of @param goal_facts is not reachable.
+	 */
+	bool isDeadEnd(const MyPOP::State& state, const std::vector<const GroundedAtom*>& goal_facts);
+	
 	EquivalentObjectGroupManager& getEquivalentObjectGroupManager() const { return *equivalent_object_manager_; }
 	
 	const ReachableFactLayer* getLastFactLayer() const { return current_fact_layer_; }
@@ -637,8 +813,9 @@ private:
 	 * @param initial_facts All the facts which are tru in the initial state.
 	 * @param bindings The bindings.
 	 * @param persistent_facts These facts (which may or may not true in the initial state) cannot be made untrue. Any action which does so cannot be executed.
+	 * @param goals_to_cover If not NULL the analysis stops as soon as all these goals are covered instead of at the fix point.
 	 */
-	void performReachabilityAnalysis(std::vector<const ReachableFact*>& result, const std::vector<REACHABILITY::ReachableFact*>& initial_facts, const std::vector<const GroundedAtom*>& persistent_facts);
+	void performReachabilityAnalysis(std::vector<const ReachableFact*>& result, const std::vector<REACHABILITY::ReachableFact*>& initial_facts, const std::vector<const GroundedAtom*>& persistent_facts, GoalIndex* goals_to_cover = NULL);
 	
 	/**
 	 * Find a relaxed plan for the relaxation planning problem generated by performReachabilityAnalysis.
@@ -654,13 +831,25 @@ private:
 	unsigned int getHeuristic(const std::vector< const GroundedAtom* >& bounded_goal_facts, bool allow_new_goals_added, bool create_helpful_actions);
 	
 	
-	std::set<std::pair<const EquivalentObject*, const EquivalentObject*> > combined_eogs_;
+	// The pairs of equivalent objects which have been substituted for each other while extracting the relaxed plan.
+	boost::unordered_set<std::pair<const EquivalentObject*, const EquivalentObject*> > combined_eogs_;
+	
+	/**
+	 * Add the items of @param fact_layer to the achievers, the layer must not be changed afterwards.
+	 */
+	void addAchievers(const ReachableFactLayer& fact_layer);
+	
+	/**
+	 * @return The items of all the completed fact layers whose predicate has the same name as @param predicate, the items of
+	 * earlier layers come first.
+	 */
+	const std::vector<const ReachableFactLayerItem*>& getAchievers(const Predicate& predicate) const;
 	
 	std::pair<const ReachableFactLayerItem*, std::vector<const Object*>**> createNewGoal(const GroundedAtom& resolved_goal);
 	
-	std::pair<const ReachableFactLayerItem*, std::vector<const Object*>**> findFactWhichAchieves(const MyPOP::REACHABILITY::ReachableFactLayerItem& current_goal, std::vector< const MyPOP::Object* >** object_bindings, std::set< std::pair< const MyPOP::REACHABILITY::EquivalentObject*, const MyPOP::REACHABILITY::EquivalentObject* > >& combined_eogs);
+	std::pair<const ReachableFactLayerItem*, std::vector<const Object*>**> findFactWhichAchieves(const MyPOP::REACHABILITY::ReachableFactLayerItem& current_goal, std::vector< const MyPOP::Object* >** object_bindings, boost::unordered_set<std::pair<const EquivalentObject*, const EquivalentObject*> >& combined_eogs);
 	
-	unsigned int makeSubstitutions(const ReachableFactLayerItem& current_goal, std::vector< const MyPOP::Object* >** object_bindings, std::set< std::pair< const EquivalentObject*, const EquivalentObject* > >& made_substitutions);
+	unsigned int makeSubstitutions(const ReachableFactLayerItem& current_goal, std::vector< const MyPOP::Object* >** object_bindings, boost::unordered_set<std::pair<const EquivalentObject*, const EquivalentObject*> >& made_substitutions);
 	
 	/**
 	 * Make a substitution between the EOG which needs to be substituted and the set of objects it needs to be substituted by.
@@ -681,11 +870,44 @@ private:
 	
 	ReachableFactLayer* current_fact_layer_;
 	
+	// The items of the fact layers before the current one indexed by the name id of their predicate, in the order of the layers
+	// and of the items within a layer. A layer is added once the next one is created and it no longer changes, so the first item
+	// which matches a goal is the earliest achiever of that goal.
+	std::vector<std::vector<const ReachableFactLayerItem*> > achievers_by_name_;
+	
 	std::map<const HEURISTICS::FactSet*, ReachableSet*> fact_set_to_reachable_set_;
 	
 	const PredicateManager* predicate_manager_;
 	
+	// The lifted transitions this lifted RPG has been created from.
+	std::vector<HEURISTICS::LiftedTransition*> lifted_transitions_;
+	
 	bool fully_grounded_;
+	
+	/**
+	 * The heuristic value of a state which has been evaluated before.
+	 */
+	struct EvaluatedState
+	{
+		// The sorted Zobrist keys of the facts of the state.
+		std::vector<std::size_t> fact_keys_;
+		bool allow_new_goals_to_be_added_;
+		unsigned int heuristic_value_;
+	};
+	
+	/**
+	 * The same state is often generated multiple times, e.g. a sibling which undoes the action that created its parent reaches the
+	 * grand parent again. The result of the reachability analysis of such states is reused instead of rebuilding the lifted RPG.
+	 * The states are indexed by their signature, the keys are independent of the ids of the grounded atoms so they remain valid
+	 * if the grounded atoms are removed.
+	 */
+	boost::unordered_multimap<std::size_t, EvaluatedState> evaluated_states_;
+	
+	// The goal facts the evaluated states have been evaluated for.
+	std::vector<std::size_t> evaluated_goal_keys_;
+	
+	// The maximum number of states to store.
+	static const unsigned int MAX_EVALUATED_STATES = 100000;
 };
 
 };
@@ -168,8 +168,8 @@ EquivalentObjectGroup::EquivalentObjectGroup(const std::vector<EquivalentObjectG
 }
 */
 
-EquivalentObjectGroup::EquivalentObjectGroup(const std::vector<const HEURISTICS::FactSet*>& all_fact_sets, const std::vector<EquivalentObjectGroup*>& all_eogs, const Object* object)
-	: is_not_part_of_property_state_(true), link_(NULL), finger_print_(NULL), merged_at_iteration_(std::numeric_limits<unsigned int>::max()), can_merge_(true)
+EquivalentObjectGroup::EquivalentObjectGroup(const std::vector<const HEURISTICS::FactSet*>& all_fact_sets, const std::vector<EquivalentObjectGroup*>& all_eogs, const Object* object, const std::vector<EquivalentObject*>& equivalent_object_index)
+	: is_not_part_of_property_state_(true), link_(NULL), root_(this), equivalent_object_index_(&equivalent_object_index), finger_print_(NULL), merged_at_iteration_(std::numeric_limits<unsigned int>::max()), can_merge_(true)
 {
 	finger_print_id_ = std::numeric_limits<unsigned int>::max();
 	if (object != NULL)
@@ -221,6 +221,7 @@ void EquivalentObjectGroup::reset()
 		(*equivalent_objects_.begin())->reset();
 		link_ = NULL;
 	}
+	root_ = this;
 	
 	merged_at_iteration_ = std::numeric_limits<unsigned int>::max();
 	reachable_facts_.clear();
@@ -283,6 +284,13 @@ void EquivalentObjectGroup::operator delete[](void* p)
 
 bool EquivalentObjectGroup::contains(const Object& object) const
 {
+	// A root node contains all the objects of the groups which have been merged with it.
+	const EquivalentObject* equivalent_object = object.getId() < equivalent_object_index_->size() ? (*equivalent_object_index_)[object.getId()] : NULL;
+	if (link_ == NULL && equivalent_object != NULL)
+	{
+		return &equivalent_object->getEquivalentObjectGroup().getRootNode() == this;
+	}
+	
 	for (std::vector<EquivalentObject*>::const_iterator ci = equivalent_objects_.begin(); ci != equivalent_objects_.end(); ci++)
 	{
 		const EquivalentObject* eo = *ci;
@@ -293,6 +301,13 @@ bool EquivalentObjectGroup::contains(const Object& object) const
 
 bool EquivalentObjectGroup::contains(const Object& object, unsigned int iteration) const
 {
+	// The objects this group contains at the given iteration are those whose initial group had been merged with it.
+	const EquivalentObject* equivalent_object = object.getId() < equivalent_object_index_->size() ? (*equivalent_object_index_)[object.getId()] : NULL;
+	if (equivalent_object != NULL)
+	{
+		return &equivalent_object->getEquivalentObjectGroup().getEOGAtLayer(iteration) == &getEOGAtLayer(iteration);
+	}
+	
 	// Check if we were merged with another EOG.
 	if (merged_at_iteration_ <= iteration)
 	{
@@ -623,6 +638,7 @@ void EquivalentObjectGroup::merge(EquivalentObjectGroup& other_group, std::vecto
 	assert (finger_print_ != NULL);
 	equivalent_objects_.insert(equivalent_objects_.end(), other_group.equivalent_objects_.begin(), other_group.equivalent_objects_.end());
 	other_group.link_ = this;
+	other_group.root_ = this;
 	
 	// TODO: Need to make sure we do not end up with multiple reachable facts which are identical!
 	//std::vector<EquivalentObjectGroup*> affected_groups;
@@ -829,7 +845,22 @@ EquivalentObjectGroup& EquivalentObjectGroup::getRootNode()
 {
 	if (link_ == NULL)
 		return *this;
-	return link_->getRootNode();
+	
+	EquivalentObjectGroup* root = root_;
+	while (root->link_ != NULL)
+	{
+		root = root->root_;
+	}
+	
+	// Path compression.
+	EquivalentObjectGroup* eog = this;
+	while (eog != root)
+	{
+		EquivalentObjectGroup* next = eog->root_;
+		eog->root_ = root;
+		eog = next;
+	}
+	return *root;
 }
 
 std::ostream& operator<<(std::ostream& os, const EquivalentObjectGroup& group)
@@ -922,17 +953,26 @@ EquivalentObjectGroupManager::EquivalentObjectGroupManager(const std::vector<con
 	for (std::vector<const Object*>::const_iterator ci = term_manager.getAllObjects().begin(); ci != term_manager.getAllObjects().end(); ci++)
 	{
 		const Object* object = *ci;
-		EquivalentObjectGroup* equivalent_object_group = new EquivalentObjectGroup(all_fact_sets, equivalent_groups_, object);
+		EquivalentObjectGroup* equivalent_object_group = new EquivalentObjectGroup(all_fact_sets, equivalent_groups_, object, equivalent_object_index_);
 		EquivalentObject* equivalent_object = new EquivalentObject(*object, *equivalent_object_group);
 		equivalent_object_group->addEquivalentObject(*equivalent_object);
 		
 		equivalent_groups_.push_back(equivalent_object_group);
-		object_to_equivalent_object_mapping_[object] = equivalent_object;
+		if (equivalent_object_index_.size() <= object->getId())
+		{
+			equivalent_object_index_.resize(object->getId() + 1, NULL);
+		}
+		equivalent_object_index_[object->getId()] = equivalent_object;
 	}
 
-	zero_arity_equivalent_object_group_ = new EquivalentObjectGroup(all_fact_sets, equivalent_groups_, NULL);
+	zero_arity_equivalent_object_group_ = new EquivalentObjectGroup(all_fact_sets, equivalent_groups_, NULL, equivalent_object_index_);
 	equivalent_groups_.push_back(zero_arity_equivalent_object_group_);
 	
+	for (std::vector<EquivalentObjectGroup*>::const_iterator ci = equivalent_groups_.begin(); ci != equivalent_groups_.end(); ci++)
+	{
+		finger_print_buckets_[(*ci)->getFingerPrintId()].push_back(*ci);
+	}
+	
 #ifdef MYPOP_SAS_PLUS_EQUIAVLENT_OBJECT_COMMENT
 	std::cout << "Done initialising data structures." << std::endl;
 #endif
@@ -988,7 +1028,7 @@ void EquivalentObjectGroupManager::updateEquivalences(unsigned int iteration)
 	for (std::vector<EquivalentObjectGroup*>::const_iterator ci = equivalent_groups_.begin(); ci != equivalent_groups_.end(); ci++)
 	{
 		EquivalentObjectGroup* eog = *ci;
-		eog->updateEquivalences(equivalent_groups_, affected_groups, iteration);
+		eog->updateEquivalences(finger_print_buckets_[eog->getFingerPrintId()], affected_groups, iteration);
 	}
 
 	for (std::vector<EquivalentObjectGroup*>::const_iterator ci = affected_groups.begin(); ci != affected_groups.end(); ci++)
@@ -1006,14 +1046,18 @@ void EquivalentObjectGroupManager::updateEquivalences(unsigned int iteration)
 
 EquivalentObject& EquivalentObjectGroupManager::getEquivalentObject(const Object& object) const
 {
-	std::map<const Object*, EquivalentObject*>::const_iterator ci = object_to_equivalent_object_mapping_.find(&object);
-	if (ci == object_to_equivalent_object_mapping_.end())
+	if (object.getId() >= equivalent_object_index_.size() || equivalent_object_index_[object.getId()] == NULL)
 	{
 		std::cout << "Could not find the Equivalent Object for the object: " << object << std::endl;
 		assert (false);
 	}
 	
-	return *(*ci).second;
+	return *equivalent_object_index_[object.getId()];
+}
+
+EquivalentObject* EquivalentObjectGroupManager::findEquivalentObject(const Object& object) const
+{
+	return object.getId() < equivalent_object_index_.size() ? equivalent_object_index_[object.getId()] : NULL;
 }
 
 void EquivalentObjectGroupManager::getAllReachableFacts(std::vector<const ReachableFact*>& result) const
@@ -88,7 +88,11 @@ class EquivalentObjectGroup
 {
 public:
 	//EquivalentObjectGroup(const std::vector<EquivalentObjectGroup*>& all_eogs, const SAS_Plus::DomainTransitionGraph& dtg_graph, const Object* object, bool is_grounded);
-	EquivalentObjectGroup(const std::vector<const HEURISTICS::FactSet*>& all_fact_sets, const std::vector<EquivalentObjectGroup*>& all_eogs, const Object* object);
+	/**
+	 * @param equivalent_object_index The equivalent objects indexed by the ID of their object, used to check if this
+	 * group contains an object without going through all its equivalent objects.
+	 */
+	EquivalentObjectGroup(const std::vector<const HEURISTICS::FactSet*>& all_fact_sets, const std::vector<EquivalentObjectGroup*>& all_eogs, const Object* object, const std::vector<EquivalentObject*>& equivalent_object_index);
 
 	~EquivalentObjectGroup();
 	
@@ -111,6 +115,11 @@ public:
 	
 	bool hasSameFingerPrint(const EquivalentObjectGroup& other) const;
 	
+	/**
+	 * Groups can only be merged if their finger print IDs are the same.
+	 */
+	unsigned int getFingerPrintId() const { return finger_print_id_; }
+	
 	const std::vector<ReachableFact*>& getReachableFacts() const { return reachable_facts_; }
 	
 	bool operator==(const EquivalentObjectGroup& other) const;
@@ -119,7 +128,7 @@ public:
 	/**
 	 * As equivalent object groups are merged the merged node will become a child node of the node it got merged into. Internally
 	 * we store this relationship which means that EOGs do not need to be deleted and any calls to the methods will automatically
-	 * be redirected to the root node.
+	 * be redirected to the root node. The path to the root node is compressed, so repeated calls take constant time.
 	 * @return The root node of this EOG.
 	 */
 	EquivalentObjectGroup& getRootNode();
@@ -140,6 +149,11 @@ public:
 	 * Sometimes we do not want some EOGs to merge with others.
 	 */
 	void setMergeable(bool can_merge) { can_merge_ = can_merge; }
+	
+	/**
+	 * @return True if this EOG was merged into another EOG at @param iteration.
+	 */
+	bool isMergedAt(unsigned int iteration) const { return merged_at_iteration_ == iteration; }
 	//void setMergeable(bool can_merge) { }
 	
 	void printObjects(std::ostream& os) const;
@@ -170,6 +184,13 @@ private:
 	// another Equivalent Object Group link will link to that object instead.
 	EquivalentObjectGroup* link_;
 	
+	// The root node, or a node on the path to it, of this EOG. Unlike @ref link_ this is updated by getRootNode to point
+	// directly to the root node; @ref link_ must keep pointing to the EOG this EOG was merged with as it is used to find
+	// the EOG at a given layer.
+	EquivalentObjectGroup* root_;
+	
+	const std::vector<EquivalentObject*>* equivalent_object_index_;
+	
 	// For the group of objects, we keep a list of reachable facts which can be achieved and contain the equivalent objects.
 	std::vector<ReachableFact*> reachable_facts_;
 	
@@ -236,6 +257,11 @@ public:
 	
 	EquivalentObject& getEquivalentObject(const Object& object) const;
 	
+	/**
+	 * @return The equivalent object of @param object or NULL if @param object is not part of any EOG.
+	 */
+	EquivalentObject* findEquivalentObject(const Object& object) const;
+	
 	EquivalentObjectGroup& getZeroArityEOG() const { return *zero_arity_equivalent_object_group_; }
 	
 	void getAllReachableFacts(std::vector<const ReachableFact*>& result) const;
@@ -251,9 +277,14 @@ private:
 	 */
 	void merge(const Object& object1, const Object& object2);
 
-	std::map<const Object*, EquivalentObject*> object_to_equivalent_object_mapping_;
+	// The equivalent objects indexed by the ID of their object, NULL for IDs which do not belong to an object.
+	std::vector<EquivalentObject*> equivalent_object_index_;
 	std::vector<EquivalentObjectGroup*> equivalent_groups_;
 	
+	// Only groups with the same finger print can be merged, so every group only needs to be compared with the groups
+	// in the same bucket.
+	std::map<unsigned int, std::vector<EquivalentObjectGroup*> > finger_print_buckets_;
+	
 	EquivalentObjectGroup* zero_arity_equivalent_object_group_;
 	
 	friend std::ostream& operator<<(std::ostream& os, const EquivalentObjectGroupManager& group);
@@ -5,9 +5,17 @@
 #include <action_manager.h>
 #include <utility/memory_pool.h>
 #include <parser_utils.h>
+#include <preprocessing_cache.h>
 
+#include <algorithm>
 #include <set>
 #include <map>
+#include <iterator>
+#include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 #include <predicate_manager.h>
 
 //#define MYPOP_HEURISTICS_LIFTED_TRANSITION_COMMENTS
@@ -24,8 +32,7 @@ VariableDomain::VariableDomain()
 
 VariableDomain::VariableDomain(const std::vector<const Object*>& variable_domain)
 {
-	variable_domain_.insert(variable_domain_.end(), variable_domain.begin(), variable_domain.end());
-	std::sort(variable_domain_.begin(), variable_domain_.end());
+	set(variable_domain);
 }
 
 VariableDomain::~VariableDomain()
@@ -35,10 +42,24 @@ VariableDomain::~VariableDomain()
 
 bool VariableDomain::sharesObjectsWith(const VariableDomain& rhs) const
 {
-	for (std::vector<const Object*>::const_iterator ci = variable_domain_.begin(); ci != variable_domain_.end(); ++ci)
+	if (variable_domain_.size() <= SMALL_DOMAIN_SIZE || rhs.variable_domain_.size() <= SMALL_DOMAIN_SIZE)
 	{
-		const Object* object = *ci;
-		if (rhs.contains(*object))
+		const VariableDomain& smallest_domain = variable_domain_.size() <= rhs.variable_domain_.size() ? *this : rhs;
+		const VariableDomain& largest_domain = variable_domain_.size() <= rhs.variable_domain_.size() ? rhs : *this;
+		for (std::vector<const Object*>::const_iterator ci = smallest_domain.variable_domain_.begin(); ci != smallest_domain.variable_domain_.end(); ++ci)
+		{
+			if (largest_domain.contains(**ci))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+	
+	unsigned int nr_words = std::min(object_bits_.size(), rhs.object_bits_.size());
+	for (unsigned int i = 0; i < nr_words; ++i)
+	{
+		if ((object_bits_[i] & rhs.object_bits_[i]) != 0)
 		{
 			return true;
 		}
@@ -48,10 +69,12 @@ bool VariableDomain::sharesObjectsWith(const VariableDomain& rhs) const
 
 void VariableDomain::getIntersection(VariableDomain& result, const VariableDomain& rhs) const
 {
-	for (std::vector<const Object*>::const_iterator ci = variable_domain_.begin(); ci != variable_domain_.end(); ++ci)
+	const VariableDomain& smallest_domain = variable_domain_.size() <= rhs.variable_domain_.size() ? *this : rhs;
+	const VariableDomain& largest_domain = variable_domain_.size() <= rhs.variable_domain_.size() ? rhs : *this;
+	for (std::vector<const Object*>::const_iterator ci = smallest_domain.variable_domain_.begin(); ci != smallest_domain.variable_domain_.end(); ++ci)
 	{
 		const Object* object = *ci;
-		if (rhs.contains(*object))
+		if (largest_domain.contains(*object))
 		{
 			result.addObject(*object);
 		}
@@ -60,35 +83,45 @@ void VariableDomain::getIntersection(VariableDomain& result, const VariableDomai
 
 bool VariableDomain::contains(const Object& object) const
 {
-	for (std::vector<const Object*>::const_iterator ci = variable_domain_.begin(); ci != variable_domain_.end(); ++ci)
-	{
-		if (*ci == &object)
-		{
-			return true;
-		}
-	}
-	
-	return false;
+	unsigned int word = object.getId() / 64;
+	return word < object_bits_.size() && (object_bits_[word] & ((uint64_t)1 << (object.getId() % 64))) != 0;
 }
 
 void VariableDomain::set(const Object& object)
 {
 	variable_domain_.clear();
+	object_bits_.clear();
 	variable_domain_.push_back(&object);
+	setBit(object);
 }
 
 void VariableDomain::set(const std::vector<const Object*>&  set)
 {
 	variable_domain_.clear();
+	object_bits_.clear();
 	variable_domain_.insert(variable_domain_.end(), set.begin(), set.end());
 	std::sort(variable_domain_.begin(), variable_domain_.end());
+	for (std::vector<const Object*>::const_iterator ci = variable_domain_.begin(); ci != variable_domain_.end(); ++ci)
+	{
+		setBit(**ci);
+	}
 }
 
 void VariableDomain::addObject(const Object& object)
 {
-	assert (std::find(variable_domain_.begin(), variable_domain_.end(), &object) == variable_domain_.end());
-	variable_domain_.push_back(&object);
-	std::sort(variable_domain_.begin(), variable_domain_.end());
+	assert (!contains(object));
+	variable_domain_.insert(std::lower_bound(variable_domain_.begin(), variable_domain_.end(), &object), &object);
+	setBit(object);
+}
+
+void VariableDomain::setBit(const Object& object)
+{
+	unsigned int word = object.getId() / 64;
+	if (word >= object_bits_.size())
+	{
+		object_bits_.resize(word + 1, 0);
+	}
+	object_bits_[word] |= (uint64_t)1 << (object.getId() % 64);
 }
 
 bool VariableDomain::operator!=(const VariableDomain& rhs) const
@@ -191,7 +224,7 @@ void Fact::setVariableDomain(unsigned int term_index, const VariableDomain& vari
 
 bool Fact::canUnifyWith(const Fact& fact) const
 {
-	if (predicate_->getName() != fact.predicate_->getName() ||
+	if (predicate_->getNameId() != fact.predicate_->getNameId() ||
 	    predicate_->getArity() != fact.predicate_->getArity())
 	{
 		return false;
@@ -212,7 +245,7 @@ bool Fact::canUnifyWith(const Fact& fact) const
 
 bool Fact::canUnifyWith(const GroundedAtom& grounded_atom) const
 {
-	if (predicate_->getName() != grounded_atom.getPredicate().getName() ||
+	if (predicate_->getNameId() != grounded_atom.getPredicate().getNameId() ||
 	    predicate_->getArity() != grounded_atom.getPredicate().getArity())
 	{
 		return false;
@@ -232,7 +265,7 @@ bool Fact::canUnifyWith(const GroundedAtom& grounded_atom) const
 bool Fact::operator==(const Fact& rhs) const
 {
 	if (predicate_->getArity() != rhs.predicate_->getArity() ||
-	    predicate_->getName() != rhs.predicate_->getName())
+	    predicate_->getNameId() != rhs.predicate_->getNameId())
 	{
 		return false;
 	}
@@ -430,6 +463,82 @@ const std::map<const TransitionFact*, const TransitionFact*>* FactSet::findBijec
 	return NULL;
 }
 
+std::size_t FactSet::getSignature() const
+{
+	// Hash every fact without its action variables.
+	std::vector<std::size_t> fact_hashes;
+	for (std::vector<const TransitionFact*>::const_iterator ci = facts_.begin(); ci != facts_.end(); ++ci)
+	{
+		const TransitionFact* fact = *ci;
+		std::size_t fact_hash = 0;
+		boost::hash_combine(fact_hash, fact->getPredicate().getNameId());
+		boost::hash_combine(fact_hash, fact->getPredicate().getArity());
+		for (std::vector<const VariableDomain*>::const_iterator ci = fact->getVariableDomains().begin(); ci != fact->getVariableDomains().end(); ++ci)
+		{
+			const VariableDomain* variable_domain = *ci;
+			boost::hash_combine(fact_hash, variable_domain->size());
+			for (std::vector<const Object*>::const_iterator ci = variable_domain->getVariableDomain().begin(); ci != variable_domain->getVariableDomain().end(); ++ci)
+			{
+				boost::hash_combine(fact_hash, (*ci)->getId());
+			}
+		}
+		fact_hashes.push_back(fact_hash);
+	}
+	
+	// Describe every action variable by the facts and the terms it occurs in.
+	std::map<const Term*, std::vector<std::size_t> > variable_occurrences;
+	for (unsigned int i = 0; i < facts_.size(); ++i)
+	{
+		const TransitionFact* fact = facts_[i];
+		for (unsigned int term_index = 0; term_index < fact->getActionVariables().size(); ++term_index)
+		{
+			std::size_t occurrence_hash = fact_hashes[i];
+			boost::hash_combine(occurrence_hash, term_index);
+			variable_occurrences[fact->getActionVariables()[term_index]].push_back(occurrence_hash);
+		}
+	}
+	
+	std::map<const Term*, std::size_t> variable_hashes;
+	for (std::map<const Term*, std::vector<std::size_t> >::iterator i = variable_occurrences.begin(); i != variable_occurrences.end(); ++i)
+	{
+		std::sort((*i).second.begin(), (*i).second.end());
+		variable_hashes[(*i).first] = boost::hash_range((*i).second.begin(), (*i).second.end());
+	}
+	
+	// Combine the hash of every fact with the hashes of its action variables, the order of the facts is irrelevant.
+	std::vector<std::size_t> signatures;
+	for (unsigned int i = 0; i < facts_.size(); ++i)
+	{
+		const TransitionFact* fact = facts_[i];
+		std::size_t signature = fact_hashes[i];
+		for (std::vector<const Term*>::const_iterator ci = fact->getActionVariables().begin(); ci != fact->getActionVariables().end(); ++ci)
+		{
+			boost::hash_combine(signature, variable_hashes[*ci]);
+		}
+		signatures.push_back(signature);
+	}
+	std::sort(signatures.begin(), signatures.end());
+	return boost::hash_range(signatures.begin(), signatures.end());
+}
+
+bool FactSet::containsDuplicateFacts() const
+{
+	for (std::vector<const TransitionFact*>::const_iterator ci = facts_.begin(); ci != facts_.end(); ++ci)
+	{
+		const TransitionFact* fact = *ci;
+		for (std::vector<const TransitionFact*>::const_iterator ci2 = ci + 1; ci2 != facts_.end(); ++ci2)
+		{
+			const TransitionFact* other_fact = *ci2;
+			if (fact->getPredicate().getNameId() == other_fact->getPredicate().getNameId() &&
+			    fact->getActionVariables() == other_fact->getActionVariables())
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
 void FactSet::addFact(const TransitionFact& fact)
 {
 	facts_.push_back(&fact);
@@ -450,143 +559,171 @@ std::ostream& operator<<(std::ostream& os, const FactSet& fact_set)
 	return os;
 }
 
-void LiftedTransition::createLiftedTransitions(std::vector<LiftedTransition*>& created_lifted_transitions, const PredicateManager& predicate_manager, const TermManager& term_manager, const TypeManager& type_manager, const Action& action, const std::vector<const Atom*>& initial_facts, const std::vector<const Object*>& part_of_property_state)
+namespace {
+
+// A static fact identified by the name id of its predicate and its objects.
+typedef std::pair<unsigned int, std::vector<const Object*> > StaticFactKey;
+
+/**
+ * Check if @param static_fact, a static fact of @param object, is a static fact of @param other_object. The occurrences of
+ * @param object in @param static_fact may be substituted by @param other_object, so every combination of substitutions is
+ * looked up in @param other_static_facts.
+ */
+bool isSharedStaticFact(const Atom& static_fact, const Object& object, const Object& other_object, const boost::unordered_set<StaticFactKey>& other_static_facts)
 {
-#ifdef MYPOP_HEURISTICS_LIFTED_TRANSITION_COMMENTS
-	std::cout << "Create lifted transitions from the action: " << action << std::endl;
-	std::cout << " === Inititial facts: === " << std::endl;
-	for (std::vector<const Atom*>::const_iterator ci = initial_facts.begin(); ci != initial_facts.end(); ++ci)
+	StaticFactKey key(static_fact.getPredicate().getNameId(), std::vector<const Object*>());
+	std::vector<unsigned int> object_indexes;
+	for (unsigned int i = 0; i < static_fact.getArity(); ++i)
 	{
-		(*ci)->print(std::cout);
-		std::cout << std::endl;
+		const Object* term = static_cast<const Object*>(static_fact.getTerms()[i]);
+		key.second.push_back(term);
+		if (term == &object)
+		{
+			object_indexes.push_back(i);
+		}
 	}
-#endif
 	
+	for (unsigned int substitutions = 0; substitutions < (1u << object_indexes.size()); ++substitutions)
+	{
+		for (unsigned int i = 0; i < object_indexes.size(); ++i)
+		{
+			key.second[object_indexes[i]] = (substitutions & (1u << i)) != 0 ? &other_object : &object;
+		}
+		if (other_static_facts.count(key) != 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+};
+
+StaticObjectEquivalences::StaticObjectEquivalences(const TermManager& term_manager, const std::vector<const Atom*>& initial_facts, const std::vector<const Object*>& part_of_property_state)
+{
 	// Determine which objects are different due to static constraints.
-	std::map<const Object*, std::vector<const Atom*>* > object_to_static_constraints_mapping;
+	std::map<const Object*, std::vector<const Atom*> > object_to_static_constraints_mapping;
 	for (std::vector<const Object*>::const_iterator ci = term_manager.getAllObjects().begin(); ci != term_manager.getAllObjects().end(); ++ci)
 	{
-		const Object* object = *ci;
-		std::vector<const Atom*>* static_constraints = new std::vector<const Atom*>();
-		object_to_static_constraints_mapping[object] = static_constraints;
-		for (std::vector<const Atom*>::const_iterator ci = initial_facts.begin(); ci != initial_facts.end(); ++ci)
+		object_to_static_constraints_mapping[*ci];
+	}
+	
+	for (std::vector<const Atom*>::const_iterator ci = initial_facts.begin(); ci != initial_facts.end(); ++ci)
+	{
+		const Atom* initial_fact = *ci;
+		if (!initial_fact->getPredicate().isStatic())
+		{
+			continue;
+		}
+		
+		std::set<const Object*> objects;
+		for (std::vector<const Term*>::const_iterator ci = initial_fact->getTerms().begin(); ci != initial_fact->getTerms().end(); ++ci)
 		{
-			const Atom* initial_fact = *ci;
-			if (!initial_fact->getPredicate().isStatic())
+			const Object* object = static_cast<const Object*>(*ci);
+			std::map<const Object*, std::vector<const Atom*> >::iterator i = object_to_static_constraints_mapping.find(object);
+			if (i != object_to_static_constraints_mapping.end() && objects.insert(object).second)
 			{
-				continue;
-			}
-			
-			for (std::vector<const Term*>::const_iterator ci = initial_fact->getTerms().begin(); ci != initial_fact->getTerms().end(); ++ci)
-			{
-				const Object* initial_fact_object = static_cast<const Object*>(*ci);
-				//const std::vector<const Object*>& variable_domain = term->getDomain(Step::INITIAL_STEP, *bindings_);
-				//if (std::find(variable_domain.begin(), variable_domain.end(), object) != variable_domain.end())
-				if (initial_fact_object == object)
-				{
-					static_constraints->push_back(initial_fact);
-					break;
-				}
+				(*i).second.push_back(initial_fact);
 			}
 		}
 	}
 	
-	// Next, compare all the static constraints of all the objects and merge those which share the same static contraints.
-	std::multimap<const Object*, const Object*> equivalent_relationships;
-	for (std::map<const Object*, std::vector<const Atom*>* >::const_iterator ci = object_to_static_constraints_mapping.begin(); ci != object_to_static_constraints_mapping.end(); ++ci)
+	// Only objects of the same type with the same number of static facts can be equivalent, hash the static facts of all the
+	// objects which are part of a property state so we can check if they are shared without comparing every pair of facts.
+	std::set<const Object*> objects_part_of_property_state(part_of_property_state.begin(), part_of_property_state.end());
+	std::map<std::pair<const Type*, unsigned int>, std::vector<const Object*> > candidates;
+	std::map<const Object*, boost::unordered_set<StaticFactKey> > object_to_static_fact_keys;
+	for (std::map<const Object*, std::vector<const Atom*> >::const_iterator ci = object_to_static_constraints_mapping.begin(); ci != object_to_static_constraints_mapping.end(); ++ci)
 	{
 		const Object* object = (*ci).first;
-		const std::vector<const Atom*>* static_facts = (*ci).second;
-		
-		// Ignore all objects which are not part of a propery state.
-		if (std::find(part_of_property_state.begin(), part_of_property_state.end(), object) == part_of_property_state.end())
+		const std::vector<const Atom*>& static_facts = (*ci).second;
+		if (objects_part_of_property_state.count(object) == 0)
 		{
-#ifdef MYPOP_HEURISTICS_LIFTED_TRANSITION_COMMENTS
-			std::cout << *object << " is not part of a property state " << std::endl;
-#endif
 			continue;
 		}
 		
-		for (std::map<const Object*, std::vector<const Atom*>* >::const_iterator ci = object_to_static_constraints_mapping.begin(); ci != object_to_static_constraints_mapping.end(); ++ci)
+		candidates[std::make_pair(object->getType(), static_facts.size())].push_back(object);
+		
+		boost::unordered_set<StaticFactKey>& static_fact_keys = object_to_static_fact_keys[object];
+		for (std::vector<const Atom*>::const_iterator ci = static_facts.begin(); ci != static_facts.end(); ++ci)
 		{
-			const Object* other_object = (*ci).first;
-			const std::vector<const Atom*>* other_static_facts = (*ci).second;
-			if (other_object == object || static_facts->size() != other_static_facts->size() || object->getType() != other_object->getType() ||
-			    std::find(part_of_property_state.begin(), part_of_property_state.end(), other_object) == part_of_property_state.end())
+			const Atom* static_fact = *ci;
+			StaticFactKey key(static_fact->getPredicate().getNameId(), std::vector<const Object*>());
+			for (std::vector<const Term*>::const_iterator ci = static_fact->getTerms().begin(); ci != static_fact->getTerms().end(); ++ci)
 			{
-#ifdef MYPOP_HEURISTICS_LIFTED_TRANSITION_COMMENTS
-				std::cout << *object << " cannot be equivalent to " << *other_object << " because of ";
-				std::cout << static_facts->size() << " != " << other_static_facts->size() << std::endl;
-				std::cout << object->getType() << " != " << other_object->getType() << std::endl;
-			   if (std::find(part_of_property_state.begin(), part_of_property_state.end(), other_object) == part_of_property_state.end())
-				{
-					std::cout << "Not part of a property state!" << std::endl;
-				}
-				std::cout << "." << std::endl;
-#endif
-				continue;
+				key.second.push_back(static_cast<const Object*>(*ci));
 			}
-			
-			// Make sure that all the static facts are shared and identical.
-			bool all_static_constraints_shared = true;
-			for (std::vector<const Atom*>::const_iterator ci = static_facts->begin(); ci != static_facts->end(); ++ci)
+			static_fact_keys.insert(key);
+		}
+	}
+	
+	// Next, compare all the static constraints of the candidates and merge those which share the same static contraints.
+	for (std::map<std::pair<const Type*, unsigned int>, std::vector<const Object*> >::const_iterator ci = candidates.begin(); ci != candidates.end(); ++ci)
+	{
+		const std::vector<const Object*>& objects = (*ci).second;
+		for (std::vector<const Object*>::const_iterator ci = objects.begin(); ci != objects.end(); ++ci)
+		{
+			const Object* object = *ci;
+			const std::vector<const Atom*>& static_facts = object_to_static_constraints_mapping[object];
+			for (std::vector<const Object*>::const_iterator ci = objects.begin(); ci != objects.end(); ++ci)
 			{
-				const Atom* static_fact = *ci;
-				bool shares_static_constraint = false;
-				for (std::vector<const Atom*>::const_iterator ci = other_static_facts->begin(); ci != other_static_facts->end(); ++ci)
+				const Object* other_object = *ci;
+				if (other_object == object)
 				{
-					const Atom* other_static_fact = *ci;
-					if (static_fact->getArity() != other_static_fact->getArity() ||
-					    static_fact->getPredicate().getName() != other_static_fact->getPredicate().getName())
-					{
-						continue;
-					}
-					
-					bool terms_match = true;
-					for (unsigned int i = 0; i < static_fact->getArity(); ++i)
-					{
-						const Object* o1 = static_cast<const Object*>(static_fact->getTerms()[i]);
-						const Object* o2 = static_cast<const Object*>(other_static_fact->getTerms()[i]);
-						if (o1 == object && o2 == other_object)
-						{
-							continue;
-						}
-						
-						if (o1 != o2)
-						{
-							terms_match = false;
-							break;
-						}
-					}
-					
-					if (terms_match)
+					continue;
+				}
+				
+				// Make sure that all the static facts are shared and identical.
+				const boost::unordered_set<StaticFactKey>& other_static_fact_keys = object_to_static_fact_keys[other_object];
+				bool all_static_constraints_shared = true;
+				for (std::vector<const Atom*>::const_iterator ci = static_facts.begin(); ci != static_facts.end(); ++ci)
+				{
+					if (!isSharedStaticFact(**ci, *object, *other_object, other_static_fact_keys))
 					{
-						shares_static_constraint = true;
+#ifdef MYPOP_HEURISTICS_LIFTED_TRANSITION_COMMENTS
+						std::cout << *object << " cannot be equivalent to " << *other_object << " because of ";
+						(*ci)->print(std::cout);
+						std::cout << "." << std::endl;
+#endif
+						all_static_constraints_shared = false;
 						break;
 					}
 				}
 				
-				if (!shares_static_constraint)
+				if (all_static_constraints_shared)
 				{
+					equivalent_objects_[object].push_back(other_object);
 #ifdef MYPOP_HEURISTICS_LIFTED_TRANSITION_COMMENTS
-					std::cout << *object << " cannot be equivalent to " << *other_object << " because of ";
-					static_fact->print(std::cout);
-					std::cout << "." << std::endl;
+					std::cout << *object << " <-> " << *other_object << std::endl;
 #endif
-					all_static_constraints_shared = false;
-					break;
 				}
 			}
-			
-			if (all_static_constraints_shared)
-			{
-				equivalent_relationships.insert(std::make_pair(object, other_object));
-#ifdef MYPOP_HEURISTICS_LIFTED_TRANSITION_COMMENTS
-				std::cout << *object << " <-> " << *other_object << std::endl;
-#endif
-			}
 		}
 	}
+}
+
+const std::vector<const Object*>& StaticObjectEquivalences::getEquivalentObjects(const Object& object) const
+{
+	static const std::vector<const Object*> no_equivalent_objects;
+	std::map<const Object*, std::vector<const Object*> >::const_iterator ci = equivalent_objects_.find(&object);
+	if (ci == equivalent_objects_.end())
+	{
+		return no_equivalent_objects;
+	}
+	return (*ci).second;
+}
+
+void LiftedTransition::createLiftedTransitions(std::vector<LiftedTransition*>& created_lifted_transitions, const PredicateManager& predicate_manager, const TypeManager& type_manager, const Action& action, const std::vector<const Atom*>& initial_facts, const StaticObjectEquivalences& static_object_equivalences)
+{
+#ifdef MYPOP_HEURISTICS_LIFTED_TRANSITION_COMMENTS
+	std::cout << "Create lifted transitions from the action: " << action << std::endl;
+	std::cout << " === Inititial facts: === " << std::endl;
+	for (std::vector<const Atom*>::const_iterator ci = initial_facts.begin(); ci != initial_facts.end(); ++ci)
+	{
+		(*ci)->print(std::cout);
+		std::cout << std::endl;
+	}
+#endif
 	
 	// Partially ground the variables based on which objects can be made equivalent.
 	std::map<const Term*, std::vector<const VariableDomain*>*> action_variable_to_variable_domain_set;
@@ -622,14 +759,13 @@ void LiftedTransition::createLiftedTransitions(std::vector<LiftedTransition*>& c
 			action_variable_domain->push_back(current_variable_domain);
 			
 			// Find all objects which are equivalent to current_object.
-			std::pair<std::multimap<const Object*, const Object*>::const_iterator, std::multimap<const Object*, const Object*>::const_iterator > eq_objects_range;
-			eq_objects_range = equivalent_relationships.equal_range(current_object);
+			const std::vector<const Object*>& equivalent_objects = static_object_equivalences.getEquivalentObjects(*current_object);
 			
 			// TODO: Make types more general so that we do not run into problems in domains like depots where there is no functional differences between the
 			// depot and distributor types.
-			for (std::multimap<const Object*, const Object*>::const_iterator ci = eq_objects_range.first; ci != eq_objects_range.second; ++ci)
+			for (std::vector<const Object*>::const_iterator ci = equivalent_objects.begin(); ci != equivalent_objects.end(); ++ci)
 			{
-				const Object* equivalent_object = (*ci).second;
+				const Object* equivalent_object = *ci;
 				
 				if (equivalent_object->getType() != current_object->getType() ||
 				    processed_objects.count(equivalent_object) > 0)
@@ -662,11 +798,6 @@ void LiftedTransition::createLiftedTransitions(std::vector<LiftedTransition*>& c
 	{
 		if ((*ci)->size() == 0)
 		{
-			for (std::map<const Object*, std::vector<const Atom*>* >::const_iterator ci = object_to_static_constraints_mapping.begin(); ci != object_to_static_constraints_mapping.end(); ++ci)
-			{
-				delete (*ci).second;
-			}
-			
 			for (std::vector<std::vector<const VariableDomain*>*>::const_iterator ci = partially_grounded_action_variable_domains.begin(); ci != partially_grounded_action_variable_domains.end(); ++ci)
 			{
 				const std::vector<const VariableDomain*>* variable_domains = *ci;
@@ -720,7 +851,7 @@ void LiftedTransition::createLiftedTransitions(std::vector<LiftedTransition*>& c
 				{
 					const Atom* initial_fact = *ci;
 					
-					if (new_fact->getPredicate().getName() != initial_fact->getPredicate().getName() ||
+					if (new_fact->getPredicate().getNameId() != initial_fact->getPredicate().getNameId() ||
 					    new_fact->getPredicate().getArity() != initial_fact->getPredicate().getArity())
 					{
 						continue;
@@ -763,7 +894,7 @@ void LiftedTransition::createLiftedTransitions(std::vector<LiftedTransition*>& c
 				const Atom* effect = *ci;
 				if (!effect->isNegative() ||
 				    effect->getArity() != precondition->getArity() ||
-				    effect->getPredicate().getName() != precondition->getPredicate().getName())
+				    effect->getPredicate().getNameId() != precondition->getPredicate().getNameId())
 				{
 					continue;
 				}
@@ -852,11 +983,6 @@ void LiftedTransition::createLiftedTransitions(std::vector<LiftedTransition*>& c
 		}
 	}
 	
-	for (std::map<const Object*, std::vector<const Atom*>* >::const_iterator ci = object_to_static_constraints_mapping.begin(); ci != object_to_static_constraints_mapping.end(); ++ci)
-	{
-		delete (*ci).second;
-	}
-	
 	for (std::vector<std::vector<const VariableDomain*>*>::const_iterator ci = partially_grounded_action_variable_domains.begin(); ci != partially_grounded_action_variable_domains.end(); ++ci)
 	{
 		const std::vector<const VariableDomain*>* variable_domains = *ci;
@@ -872,10 +998,82 @@ void LiftedTransition::createLiftedTransitions(std::vector<LiftedTransition*>& c
 #endif
 }
 
+namespace {
+
+/**
+ * The actions which are split up into lifted transitions by several threads, every thread takes the next action until none
+ * are left.
+ */
+struct LiftedTransitionJobs
+{
+	const PredicateManager* predicate_manager_;
+	const TypeManager* type_manager_;
+	const std::vector<Action*>* actions_;
+	const std::vector<const Atom*>* initial_facts_;
+	const StaticObjectEquivalences* static_object_equivalences_;
+	
+	// The lifted transitions created for every action.
+	std::vector<std::vector<LiftedTransition*> > created_lifted_transitions_;
+	
+	boost::mutex mutex_;
+	unsigned int next_action_;
+};
+
+void createLiftedTransitionsOfJobs(LiftedTransitionJobs& jobs)
+{
+	while (true)
+	{
+		unsigned int action_index;
+		{
+			boost::lock_guard<boost::mutex> lock(jobs.mutex_);
+			if (jobs.next_action_ == jobs.actions_->size())
+			{
+				return;
+			}
+			action_index = jobs.next_action_++;
+		}
+		LiftedTransition::createLiftedTransitions(jobs.created_lifted_transitions_[action_index], *jobs.predicate_manager_, *jobs.type_manager_, *(*jobs.actions_)[action_index], *jobs.initial_facts_, *jobs.static_object_equivalences_);
+	}
+}
+
+};
+
+void LiftedTransition::createLiftedTransitions(std::vector<LiftedTransition*>& created_lifted_transitions, const PredicateManager& predicate_manager, const TypeManager& type_manager, const std::vector<Action*>& actions, const std::vector<const Atom*>& initial_facts, const StaticObjectEquivalences& static_object_equivalences, unsigned int number_of_threads)
+{
+	LiftedTransitionJobs jobs;
+	jobs.predicate_manager_ = &predicate_manager;
+	jobs.type_manager_ = &type_manager;
+	jobs.actions_ = &actions;
+	jobs.initial_facts_ = &initial_facts;
+	jobs.static_object_equivalences_ = &static_object_equivalences;
+	jobs.created_lifted_transitions_.resize(actions.size());
+	jobs.next_action_ = 0;
+	
+	boost::thread_group threads;
+	for (unsigned int i = 1; i < std::min<unsigned int>(number_of_threads, actions.size()); ++i)
+	{
+		threads.create_thread(boost::bind(&createLiftedTransitionsOfJobs, boost::ref(jobs)));
+	}
+	createLiftedTransitionsOfJobs(jobs);
+	threads.join_all();
+	
+	for (std::vector<std::vector<LiftedTransition*> >::const_iterator ci = jobs.created_lifted_transitions_.begin(); ci != jobs.created_lifted_transitions_.end(); ++ci)
+	{
+		created_lifted_transitions.insert(created_lifted_transitions.end(), (*ci).begin(), (*ci).end());
+	}
+}
+
 void LiftedTransition::mergeFactSets(const std::vector<LiftedTransition*>& all_lifted_transitions)
 {
 	std::vector<const FactSet*> merged_fact_sets;
 	std::vector<const FactSet*> facts_to_remove;
+	
+	// Only fact sets with the same signature can be merged, unless a fact set contains the same fact twice. Such a fact set can
+	// be mapped to a fact set with a different signature, so it is compared with every other fact set. The fact sets are stored
+	// together with their index in merged_fact_sets so they are compared in the same order.
+	typedef std::vector<std::pair<unsigned int, const FactSet*> > IndexedFactSets;
+	boost::unordered_map<std::size_t, IndexedFactSets> merged_fact_sets_by_signature;
+	IndexedFactSets merged_fact_sets_with_duplicate_facts;
 	for (std::vector<LiftedTransition*>::const_iterator ci = all_lifted_transitions.begin(); ci != all_lifted_transitions.end(); ++ci)
 	{
 		LiftedTransition* lifted_transition = *ci;
@@ -890,9 +1088,27 @@ void LiftedTransition::mergeFactSets(const std::vector<LiftedTransition*>& all_l
 			//const FactSet* precondition_set = lifted_transition->preconditions_[i];
 			const FactSet* fact_set = *ci;
 			
+			bool contains_duplicate_facts = fact_set->containsDuplicateFacts();
+			std::size_t signature = contains_duplicate_facts ? 0 : fact_set->getSignature();
+			std::vector<const FactSet*> candidates;
+			if (contains_duplicate_facts)
+			{
+				candidates = merged_fact_sets;
+			}
+			else
+			{
+				IndexedFactSets indexed_candidates;
+				const IndexedFactSets& same_signature = merged_fact_sets_by_signature[signature];
+				std::merge(same_signature.begin(), same_signature.end(), merged_fact_sets_with_duplicate_facts.begin(), merged_fact_sets_with_duplicate_facts.end(), std::back_inserter(indexed_candidates));
+				for (IndexedFactSets::const_iterator ci = indexed_candidates.begin(); ci != indexed_candidates.end(); ++ci)
+				{
+					candidates.push_back((*ci).second);
+				}
+			}
+			
 			// Check if there is another fact set that can merge with this one.
 			bool found_bijection = false;
-			for (std::vector<const FactSet*>::const_iterator ci = merged_fact_sets.begin(); ci != merged_fact_sets.end(); ++ci)
+			for (std::vector<const FactSet*>::const_iterator ci = candidates.begin(); ci != candidates.end(); ++ci)
 			{
 				const FactSet* merged_fact_set = *ci;
 				//const std::map<const TransitionFact*, const TransitionFact*>* bijection = merged_fact_set->findBijection(*precondition_set);
@@ -923,6 +1139,14 @@ void LiftedTransition::mergeFactSets(const std::vector<LiftedTransition*>& all_l
 //					std::cout << "* " << **ci << std::endl;
 //				}
 				//merged_fact_sets.push_back(precondition_set);
+				if (contains_duplicate_facts)
+				{
+					merged_fact_sets_with_duplicate_facts.push_back(std::make_pair(merged_fact_sets.size(), fact_set));
+				}
+				else
+				{
+					merged_fact_sets_by_signature[signature].push_back(std::make_pair(merged_fact_sets.size(), fact_set));
+				}
 				merged_fact_sets.push_back(fact_set);
 			}
 			else
@@ -1145,6 +1369,364 @@ void LiftedTransition::mapFactsToActionVariables(std::map<const FactSet*, std::v
 	}
 }
 
+LiftedTransition::LiftedTransition(const Action& action)
+	: action_(&action)
+{
+	
+}
+
+namespace {
+
+bool isManaged(const Term& term, const TermManager& term_manager)
+{
+	return term.getId() < term_manager.getManagableObjects().size() && term_manager.getManagableObjects()[term.getId()] == &term;
+}
+
+bool isManaged(const VariableDomain& variable_domain, const TermManager& term_manager)
+{
+	for (std::vector<const Object*>::const_iterator ci = variable_domain.getVariableDomain().begin(); ci != variable_domain.getVariableDomain().end(); ++ci)
+	{
+		if (!isManaged(**ci, term_manager))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void writeVariableDomain(PreprocessingCache& preprocessing_cache, const VariableDomain& variable_domain)
+{
+	preprocessing_cache.write(variable_domain.size());
+	for (std::vector<const Object*>::const_iterator ci = variable_domain.getVariableDomain().begin(); ci != variable_domain.getVariableDomain().end(); ++ci)
+	{
+		preprocessing_cache.write((*ci)->getId());
+	}
+}
+
+void writeMappings(PreprocessingCache& preprocessing_cache, const std::map<const FactSet*, std::vector<std::vector<unsigned int>* >* >& mappings, const std::map<const FactSet*, unsigned int>& fact_set_indexes)
+{
+	preprocessing_cache.write(mappings.size());
+	for (std::map<const FactSet*, std::vector<std::vector<unsigned int>* >* >::const_iterator ci = mappings.begin(); ci != mappings.end(); ++ci)
+	{
+		preprocessing_cache.write((*fact_set_indexes.find((*ci).first)).second);
+		const std::vector<std::vector<unsigned int>* >* fact_mappings = (*ci).second;
+		preprocessing_cache.write(fact_mappings->size());
+		for (std::vector<std::vector<unsigned int>* >::const_iterator ci = fact_mappings->begin(); ci != fact_mappings->end(); ++ci)
+		{
+			preprocessing_cache.write((*ci)->size());
+			for (std::vector<unsigned int>::const_iterator ci2 = (*ci)->begin(); ci2 != (*ci)->end(); ++ci2)
+			{
+				preprocessing_cache.write(*ci2);
+			}
+		}
+	}
+}
+
+/**
+ * Read a number which must be smaller than @param bound.
+ */
+bool readIndex(PreprocessingCache& preprocessing_cache, uint32_t& index, std::size_t bound)
+{
+	return preprocessing_cache.read(index) && index < bound;
+}
+
+/**
+ * @return The variable domain stored by writeVariableDomain, NULL if it does not match the objects of @param term_manager.
+ */
+VariableDomain* readVariableDomain(PreprocessingCache& preprocessing_cache, const TermManager& term_manager)
+{
+	uint32_t size;
+	if (!readIndex(preprocessing_cache, size, term_manager.getManagableObjects().size() + 1))
+	{
+		return NULL;
+	}
+	
+	std::vector<const Object*> objects;
+	for (uint32_t i = 0; i < size; ++i)
+	{
+		uint32_t term_id;
+		if (!readIndex(preprocessing_cache, term_id, term_manager.getManagableObjects().size()))
+		{
+			return NULL;
+		}
+		const Object* object = dynamic_cast<const Object*>(term_manager.getManagableObjects()[term_id]);
+		if (object == NULL)
+		{
+			return NULL;
+		}
+		objects.push_back(object);
+	}
+	return new VariableDomain(objects);
+}
+
+/**
+ * @return The fact stored by LiftedTransition::save, NULL if it does not match the managers.
+ */
+TransitionFact* readTransitionFact(PreprocessingCache& preprocessing_cache, const PredicateManager& predicate_manager, const TermManager& term_manager)
+{
+	uint32_t predicate_id;
+	if (!readIndex(preprocessing_cache, predicate_id, predicate_manager.getManagableObjects().size()))
+	{
+		return NULL;
+	}
+	const Predicate* predicate = predicate_manager.getManagableObjects()[predicate_id];
+	
+	std::vector<const VariableDomain*>* variable_domains = new std::vector<const VariableDomain*>();
+	std::vector<const Term*> action_variables;
+	bool matches = true;
+	for (unsigned int i = 0; i < predicate->getArity(); ++i)
+	{
+		VariableDomain* variable_domain = readVariableDomain(preprocessing_cache, term_manager);
+		uint32_t term_id;
+		if (variable_domain == NULL || !readIndex(preprocessing_cache, term_id, term_manager.getManagableObjects().size()))
+		{
+			delete variable_domain;
+			matches = false;
+			break;
+		}
+		variable_domains->push_back(variable_domain);
+		action_variables.push_back(term_manager.getManagableObjects()[term_id]);
+	}
+	
+	if (!matches)
+	{
+		for (std::vector<const VariableDomain*>::const_iterator ci = variable_domains->begin(); ci != variable_domains->end(); ++ci)
+		{
+			delete *ci;
+		}
+		delete variable_domains;
+		return NULL;
+	}
+	return new TransitionFact(predicate_manager, *predicate, *variable_domains, action_variables);
+}
+
+bool readMappings(PreprocessingCache& preprocessing_cache, std::map<const FactSet*, std::vector<std::vector<unsigned int>* >* >& mappings, const std::vector<const FactSet*>& fact_sets, const Action& action)
+{
+	uint32_t nr_mappings;
+	if (!readIndex(preprocessing_cache, nr_mappings, fact_sets.size() + 1))
+	{
+		return false;
+	}
+	
+	for (uint32_t i = 0; i < nr_mappings; ++i)
+	{
+		uint32_t fact_set_index, nr_facts;
+		if (!readIndex(preprocessing_cache, fact_set_index, fact_sets.size()) || mappings.count(fact_sets[fact_set_index]) != 0 ||
+		    !preprocessing_cache.read(nr_facts) || nr_facts != fact_sets[fact_set_index]->getFacts().size())
+		{
+			return false;
+		}
+		
+		std::vector<std::vector<unsigned int>* >* fact_mappings = new std::vector<std::vector<unsigned int>* >();
+		mappings[fact_sets[fact_set_index]] = fact_mappings;
+		for (uint32_t fact_index = 0; fact_index < nr_facts; ++fact_index)
+		{
+			std::vector<unsigned int>* terms = new std::vector<unsigned int>();
+			fact_mappings->push_back(terms);
+			
+			uint32_t nr_terms;
+			if (!preprocessing_cache.read(nr_terms) || nr_terms != fact_sets[fact_set_index]->getFacts()[fact_index]->getActionVariables().size())
+			{
+				return false;
+			}
+			for (uint32_t term_index = 0; term_index < nr_terms; ++term_index)
+			{
+				// An action variable which is not a parameter of the action is mapped to the number of parameters.
+				uint32_t action_variable_index;
+				if (!readIndex(preprocessing_cache, action_variable_index, action.getVariables().size() + 1))
+				{
+					return false;
+				}
+				terms->push_back(action_variable_index);
+			}
+		}
+	}
+	return true;
+}
+
+};
+
+bool LiftedTransition::save(PreprocessingCache& preprocessing_cache, const std::vector<LiftedTransition*>& lifted_transitions, const ActionManager& action_manager, const PredicateManager& predicate_manager, const TermManager& term_manager)
+{
+	// Number the fact sets, after merging they are shared by the lifted transitions.
+	std::vector<const FactSet*> fact_sets;
+	std::map<const FactSet*, unsigned int> fact_set_indexes;
+	for (std::vector<LiftedTransition*>::const_iterator ci = lifted_transitions.begin(); ci != lifted_transitions.end(); ++ci)
+	{
+		const LiftedTransition* lifted_transition = *ci;
+		if (lifted_transition->action_->getId() >= action_manager.getManagableObjects().size() || action_manager.getManagableObjects()[lifted_transition->action_->getId()] != lifted_transition->action_)
+		{
+			return false;
+		}
+		for (std::vector<const VariableDomain*>::const_iterator ci = lifted_transition->action_variable_domains_.begin(); ci != lifted_transition->action_variable_domains_.end(); ++ci)
+		{
+			if (!isManaged(**ci, term_manager))
+			{
+				return false;
+			}
+		}
+		
+		std::vector<const FactSet*> all_fact_sets(lifted_transition->preconditions_);
+		all_fact_sets.insert(all_fact_sets.end(), lifted_transition->effects_.begin(), lifted_transition->effects_.end());
+		for (std::vector<const FactSet*>::const_iterator ci = all_fact_sets.begin(); ci != all_fact_sets.end(); ++ci)
+		{
+			if (fact_set_indexes.insert(std::make_pair(*ci, fact_sets.size())).second)
+			{
+				fact_sets.push_back(*ci);
+			}
+		}
+	}
+	
+	for (std::vector<const FactSet*>::const_iterator ci = fact_sets.begin(); ci != fact_sets.end(); ++ci)
+	{
+		for (std::vector<const TransitionFact*>::const_iterator ci2 = (*ci)->getFacts().begin(); ci2 != (*ci)->getFacts().end(); ++ci2)
+		{
+			const TransitionFact* fact = *ci2;
+			if (fact->getPredicate().getId() >= predicate_manager.getManagableObjects().size() || predicate_manager.getManagableObjects()[fact->getPredicate().getId()] != &fact->getPredicate() ||
+			    fact->getVariableDomains().size() != fact->getPredicate().getArity() || fact->getActionVariables().size() != fact->getPredicate().getArity())
+			{
+				return false;
+			}
+			for (unsigned int i = 0; i < fact->getPredicate().getArity(); ++i)
+			{
+				if (!isManaged(*fact->getVariableDomains()[i], term_manager) || !isManaged(*fact->getActionVariables()[i], term_manager))
+				{
+					return false;
+				}
+			}
+		}
+	}
+	
+	preprocessing_cache.write(fact_sets.size());
+	for (std::vector<const FactSet*>::const_iterator ci = fact_sets.begin(); ci != fact_sets.end(); ++ci)
+	{
+		preprocessing_cache.write((*ci)->getFacts().size());
+		for (std::vector<const TransitionFact*>::const_iterator ci2 = (*ci)->getFacts().begin(); ci2 != (*ci)->getFacts().end(); ++ci2)
+		{
+			const TransitionFact* fact = *ci2;
+			preprocessing_cache.write(fact->getPredicate().getId());
+			for (unsigned int i = 0; i < fact->getPredicate().getArity(); ++i)
+			{
+				writeVariableDomain(preprocessing_cache, *fact->getVariableDomains()[i]);
+				preprocessing_cache.write(fact->getActionVariables()[i]->getId());
+			}
+		}
+	}
+	
+	preprocessing_cache.write(lifted_transitions.size());
+	for (std::vector<LiftedTransition*>::const_iterator ci = lifted_transitions.begin(); ci != lifted_transitions.end(); ++ci)
+	{
+		const LiftedTransition* lifted_transition = *ci;
+		preprocessing_cache.write(lifted_transition->action_->getId());
+		for (std::vector<const VariableDomain*>::const_iterator ci = lifted_transition->action_variable_domains_.begin(); ci != lifted_transition->action_variable_domains_.end(); ++ci)
+		{
+			writeVariableDomain(preprocessing_cache, **ci);
+		}
+		
+		preprocessing_cache.write(lifted_transition->preconditions_.size());
+		for (std::vector<const FactSet*>::const_iterator ci = lifted_transition->preconditions_.begin(); ci != lifted_transition->preconditions_.end(); ++ci)
+		{
+			preprocessing_cache.write(fact_set_indexes[*ci]);
+		}
+		writeMappings(preprocessing_cache, lifted_transition->precondition_variable_domains_to_action_parameters_, fact_set_indexes);
+		
+		preprocessing_cache.write(lifted_transition->effects_.size());
+		for (std::vector<const FactSet*>::const_iterator ci = lifted_transition->effects_.begin(); ci != lifted_transition->effects_.end(); ++ci)
+		{
+			preprocessing_cache.write(fact_set_indexes[*ci]);
+		}
+		writeMappings(preprocessing_cache, lifted_transition->effect_variable_domains_to_action_parameters_, fact_set_indexes);
+	}
+	return true;
+}
+
+bool LiftedTransition::load(PreprocessingCache& preprocessing_cache, std::vector<LiftedTransition*>& lifted_transitions, const ActionManager& action_manager, const PredicateManager& predicate_manager, const TermManager& term_manager)
+{
+	std::vector<const FactSet*> fact_sets;
+	std::vector<LiftedTransition*> loaded_lifted_transitions;
+	bool matches = true;
+	
+	uint32_t nr_fact_sets;
+	matches = preprocessing_cache.read(nr_fact_sets);
+	for (uint32_t i = 0; matches && i < nr_fact_sets; ++i)
+	{
+		FactSet* fact_set = new FactSet();
+		fact_sets.push_back(fact_set);
+		
+		uint32_t nr_facts;
+		matches = preprocessing_cache.read(nr_facts);
+		for (uint32_t fact_index = 0; matches && fact_index < nr_facts; ++fact_index)
+		{
+			TransitionFact* fact = readTransitionFact(preprocessing_cache, predicate_manager, term_manager);
+			if (fact == NULL)
+			{
+				matches = false;
+				break;
+			}
+			fact_set->addFact(*fact);
+		}
+	}
+	
+	uint32_t nr_lifted_transitions;
+	matches = matches && preprocessing_cache.read(nr_lifted_transitions);
+	for (uint32_t i = 0; matches && i < nr_lifted_transitions; ++i)
+	{
+		uint32_t action_id;
+		if (!readIndex(preprocessing_cache, action_id, action_manager.getManagableObjects().size()))
+		{
+			matches = false;
+			break;
+		}
+		const Action* action = action_manager.getManagableObjects()[action_id];
+		LiftedTransition* lifted_transition = new LiftedTransition(*action);
+		loaded_lifted_transitions.push_back(lifted_transition);
+		
+		for (unsigned int variable_index = 0; variable_index < action->getVariables().size(); ++variable_index)
+		{
+			VariableDomain* variable_domain = readVariableDomain(preprocessing_cache, term_manager);
+			if (variable_domain == NULL)
+			{
+				matches = false;
+				break;
+			}
+			lifted_transition->action_variable_domains_.push_back(variable_domain);
+		}
+		
+		uint32_t nr_preconditions, nr_effects, fact_set_index;
+		matches = matches && readIndex(preprocessing_cache, nr_preconditions, fact_sets.size() + 1);
+		for (uint32_t j = 0; matches && j < nr_preconditions; ++j)
+		{
+			matches = readIndex(preprocessing_cache, fact_set_index, fact_sets.size());
+			lifted_transition->preconditions_.push_back(matches ? fact_sets[fact_set_index] : NULL);
+		}
+		matches = matches && readMappings(preprocessing_cache, lifted_transition->precondition_variable_domains_to_action_parameters_, fact_sets, *action);
+		
+		matches = matches && readIndex(preprocessing_cache, nr_effects, fact_sets.size() + 1);
+		for (uint32_t j = 0; matches && j < nr_effects; ++j)
+		{
+			matches = readIndex(preprocessing_cache, fact_set_index, fact_sets.size());
+			lifted_transition->effects_.push_back(matches ? fact_sets[fact_set_index] : NULL);
+		}
+		matches = matches && readMappings(preprocessing_cache, lifted_transition->effect_variable_domains_to_action_parameters_, fact_sets, *action);
+	}
+	
+	if (!matches)
+	{
+		for (std::vector<LiftedTransition*>::const_iterator ci = loaded_lifted_transitions.begin(); ci != loaded_lifted_transitions.end(); ++ci)
+		{
+			delete *ci;
+		}
+		for (std::vector<const FactSet*>::const_iterator ci = fact_sets.begin(); ci != fact_sets.end(); ++ci)
+		{
+			delete *ci;
+		}
+		return false;
+	}
+	
+	lifted_transitions.insert(lifted_transitions.end(), loaded_lifted_transitions.begin(), loaded_lifted_transitions.end());
+	return true;
+}
+
 LiftedTransition::~LiftedTransition()
 {
 /*	for (std::vector<const FactSet*>::const_iterator ci = preconditions_.begin(); ci != preconditions_.end(); ++ci)
@@ -4,11 +4,13 @@
 #include <ostream>
 #include <map>
 #include <vector>
+#include <stdint.h>
 
 namespace MyPOP {
 
 class Atom;
 class Action;
+class ActionManager;
 class Predicate;
 class Object;
 class PredicateManager;
@@ -17,9 +19,14 @@ class Variable;
 class TermManager;
 class TypeManager;
 class GroundedAtom;
+class PreprocessingCache;
 
 namespace HEURISTICS {
 
+/**
+ * A set of objects. Besides the sorted vector of objects the domain keeps a bitset indexed by the IDs of the objects,
+ * so membership tests take constant time and overlap tests between large domains compare 64 objects at a time.
+ */
 class VariableDomain
 {
 public:
@@ -45,8 +52,16 @@ public:
 	bool operator!=(const VariableDomain& rhs) const;
 	
 private:
+	void setBit(const Object& object);
+	
 	std::vector<const Object*> variable_domain_;
 	
+	// Bit i is set iff the object with ID i is part of this domain.
+	std::vector<uint64_t> object_bits_;
+	
+	// Domains up to this size are compared object by object rather than word by word.
+	static const unsigned int SMALL_DOMAIN_SIZE = 8;
+	
 	friend std::ostream& operator<<(std::ostream& os, const VariableDomain& variable_domain);
 };
 
@@ -121,6 +136,18 @@ public:
 	 */
 	const std::map<const TransitionFact*, const TransitionFact*>* findBijection(const FactSet& other) const;
 	
+	/**
+	 * A hash of the predicates and variable domains of the facts and of the way the facts share their action variables, it does
+	 * not depend on the order of the facts nor on the action variables themselves. If there is a bijection between two fact
+	 * sets which do not contain the same fact twice then both have the same signature.
+	 */
+	std::size_t getSignature() const;
+	
+	/**
+	 * @return True if two facts of this set have the same predicate and the same action variables.
+	 */
+	bool containsDuplicateFacts() const;
+	
 	void addFact(const TransitionFact& fact);
 private:
 	std::vector<const TransitionFact*> facts_;
@@ -132,6 +159,29 @@ private:
 
 std::ostream& operator<<(std::ostream& os, const FactSet& fact_set);
 
+/**
+ * The objects which cannot be told apart by the static facts of the initial state. An object is equivalent to another object
+ * iff both are part of a property state, are of the same type, have the same number of static facts and every static fact of
+ * the object is also a static fact of the other object once (some of) its occurrences of the object are substituted by the
+ * other object.
+ *
+ * This only depends on the problem, so it is determined once and shared by all the actions which are split up into lifted
+ * transitions.
+ */
+class StaticObjectEquivalences
+{
+public:
+	StaticObjectEquivalences(const TermManager& term_manager, const std::vector<const Atom*>& initial_facts, const std::vector<const Object*>& part_of_property_state);
+	
+	/**
+	 * @return The objects which are equivalent to @param object.
+	 */
+	const std::vector<const Object*>& getEquivalentObjects(const Object& object) const;
+	
+private:
+	std::map<const Object*, std::vector<const Object*> > equivalent_objects_;
+};
+
 /**
  * A lifted transition contains references to fact sets instead of the normal preconditions and effects in order
  * to speed up finding consistent sets.
@@ -141,10 +191,34 @@ class LiftedTransition
 public:
 	~LiftedTransition();
 	
-	static void createLiftedTransitions(std::vector<LiftedTransition*>& created_lifted_transitions, const PredicateManager& predicate_manager, const TermManager& term_manager, const TypeManager& type_manager, const Action& action, const std::vector<const Atom*>& initial_facts, const std::vector<const Object*>& part_of_property_state);
+	/**
+	 * Split up @param action into lifted transitions, the variables of the action are partially grounded such that equivalent
+	 * objects share the same variable domain.
+	 */
+	static void createLiftedTransitions(std::vector<LiftedTransition*>& created_lifted_transitions, const PredicateManager& predicate_manager, const TypeManager& type_manager, const Action& action, const std::vector<const Atom*>& initial_facts, const StaticObjectEquivalences& static_object_equivalences);
+	
+	/**
+	 * Split up all the @param actions into lifted transitions, the actions are divided among @param number_of_threads threads
+	 * (the calling thread is one of them). The lifted transitions are stored in the order of the actions regardless of the
+	 * number of threads.
+	 */
+	static void createLiftedTransitions(std::vector<LiftedTransition*>& created_lifted_transitions, const PredicateManager& predicate_manager, const TypeManager& type_manager, const std::vector<Action*>& actions, const std::vector<const Atom*>& initial_facts, const StaticObjectEquivalences& static_object_equivalences, unsigned int number_of_threads);
 	
 	static void mergeFactSets(const std::vector<LiftedTransition*>& all_lifted_transitions);
 	
+	/**
+	 * Store @param lifted_transitions, together with the fact sets they share, in @param preprocessing_cache. The predicates,
+	 * terms and actions are stored by their IDs.
+	 * @return False if a predicate or term is not managed, nothing is written in that case.
+	 */
+	static bool save(PreprocessingCache& preprocessing_cache, const std::vector<LiftedTransition*>& lifted_transitions, const ActionManager& action_manager, const PredicateManager& predicate_manager, const TermManager& term_manager);
+	
+	/**
+	 * Restore the lifted transitions stored by @ref save and append them to @param lifted_transitions.
+	 * @return False if the stored lifted transitions do not match the managers, @param lifted_transitions is left unchanged.
+	 */
+	static bool load(PreprocessingCache& preprocessing_cache, std::vector<LiftedTransition*>& lifted_transitions, const ActionManager& action_manager, const PredicateManager& predicate_manager, const TermManager& term_manager);
+	
 	const Action& getAction() const { return *action_; }
 	
 	const std::vector<const VariableDomain*>& getActionVariables() const { return action_variable_domains_; }
@@ -167,6 +241,11 @@ private:
 	
 	LiftedTransition(const Action& action, const std::vector<const VariableDomain*>& action_variable_domains, const std::vector<const FactSet*>& preconditions, const std::vector<const FactSet*>& effects);
 	
+	/**
+	 * Create a lifted transition without any variable domains or fact sets, used by @ref load.
+	 */
+	LiftedTransition(const Action& action);
+	
 	void mapFactsToActionVariables(std::map<const FactSet*, std::vector<std::vector<unsigned int>* >* >& fact_variable_domains_to_action_parameters, const std::vector<const FactSet*>& fact_sets);
 	const std::map<const TransitionFact*, const TransitionFact*>* findBijection(const FactSet& other, const std::map<const TransitionFact*, const TransitionFact*>& variable_domain_bijection, const std::map<const Term*, const Term*>& variable_bijection) const;
 	
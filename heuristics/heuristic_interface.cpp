@@ -2,6 +2,8 @@
 #define MYPOP_HEURISTICS_HEURISTIC_INTERFACE_H
 
 #include <iostream>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 #include "heuristic_interface.h"
 #include "dtg_reachability.h"
@@ -14,9 +16,208 @@ class State;
 
 namespace HEURISTICS {
 
+/**
+ * A set of worker threads, each of which owns a clone of a heuristic, which evaluate a batch of states together with the thread
+ * which hands out the batch.
+ */
+class HeuristicWorkerPool
+{
+public:
+	/**
+	 * Start a worker thread for every heuristic, the workers take ownership of these heuristics.
+	 */
+	HeuristicWorkerPool(const std::vector<HeuristicInterface*>& heuristics);
+	
+	~HeuristicWorkerPool();
+	
+	unsigned int getNumberOfThreads() const { return threads_.size() + 1; }
+	
+	/**
+	 * Evaluate all the states, @param heuristic is used to evaluate states on the calling thread.
+	 */
+	void setHeuristicForStates(HeuristicInterface& heuristic, const std::vector<State*>& states, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts, const TermManager& term_manager, bool allow_new_goals_to_be_added);
+	
+private:
+	
+	/**
+	 * The main loop of a worker thread, the reachable facts and achieving transitions created by @param heuristic are stored per
+	 * thread so it must be deleted by the same thread.
+	 */
+	void run(HeuristicInterface* heuristic);
+	
+	/**
+	 * Evaluate states from the current batch until none are left.
+	 */
+	void evaluateStates(HeuristicInterface& heuristic);
+	
+	boost::thread_group threads_;
+	boost::mutex mutex_;
+	boost::condition_variable batch_available_;
+	boost::condition_variable batch_finished_;
+	
+	// Incremented every time a new batch is handed out.
+	unsigned int batch_number_;
+	// The number of workers which have not yet finished the current batch.
+	unsigned int busy_workers_;
+	bool stop_;
+	
+	// The current batch.
+	const std::vector<State*>* states_;
+	const std::vector<const GroundedAtom*>* initial_facts_;
+	const std::vector<const GroundedAtom*>* goal_facts_;
+	const TermManager* term_manager_;
+	bool allow_new_goals_to_be_added_;
+	unsigned int next_state_;
+};
+
+HeuristicWorkerPool::HeuristicWorkerPool(const std::vector<HeuristicInterface*>& heuristics)
+	: batch_number_(0), busy_workers_(0), stop_(false), states_(NULL), initial_facts_(NULL), goal_facts_(NULL), term_manager_(NULL), allow_new_goals_to_be_added_(false), next_state_(0)
+{
+	for (std::vector<HeuristicInterface*>::const_iterator ci = heuristics.begin(); ci != heuristics.end(); ++ci)
+	{
+		threads_.create_thread(boost::bind(&HeuristicWorkerPool::run, this, *ci));
+	}
+}
+
+HeuristicWorkerPool::~HeuristicWorkerPool()
+{
+	{
+		boost::lock_guard<boost::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	batch_available_.notify_all();
+	threads_.join_all();
+}
+
+void HeuristicWorkerPool::setHeuristicForStates(HeuristicInterface& heuristic, const std::vector<State*>& states, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts, const TermManager& term_manager, bool allow_new_goals_to_be_added)
+{
+	{
+		boost::lock_guard<boost::mutex> lock(mutex_);
+		states_ = &states;
+		initial_facts_ = &initial_facts;
+		goal_facts_ = &goal_facts;
+		term_manager_ = &term_manager;
+		allow_new_goals_to_be_added_ = allow_new_goals_to_be_added;
+		next_state_ = 0;
+		busy_workers_ = threads_.size();
+		++batch_number_;
+	}
+	batch_available_.notify_all();
+	
+	evaluateStates(heuristic);
+	
+	boost::unique_lock<boost::mutex> lock(mutex_);
+	while (busy_workers_ != 0)
+	{
+		batch_finished_.wait(lock);
+	}
+	states_ = NULL;
+}
+
+void HeuristicWorkerPool::run(HeuristicInterface* heuristic)
+{
+	unsigned int last_batch_number = 0;
+	while (true)
+	{
+		{
+			boost::unique_lock<boost::mutex> lock(mutex_);
+			while (!stop_ && batch_number_ == last_batch_number)
+			{
+				batch_available_.wait(lock);
+			}
+			if (stop_)
+			{
+				break;
+			}
+			last_batch_number = batch_number_;
+		}
+		
+		evaluateStates(*heuristic);
+		
+		boost::lock_guard<boost::mutex> lock(mutex_);
+		if (--busy_workers_ == 0)
+		{
+			batch_finished_.notify_all();
+		}
+	}
+	delete heuristic;
+}
+
+void HeuristicWorkerPool::evaluateStates(HeuristicInterface& heuristic)
+{
+	while (true)
+	{
+		State* state = NULL;
+		{
+			boost::lock_guard<boost::mutex> lock(mutex_);
+			if (next_state_ == states_->size())
+			{
+				return;
+			}
+			state = (*states_)[next_state_];
+			++next_state_;
+		}
+		heuristic.setHeuristicForState(*state, *initial_facts_, *goal_facts_, *term_manager_, false, allow_new_goals_to_be_added_);
+	}
+}
+
+HeuristicInterface::HeuristicInterface()
+	: worker_pool_(NULL)
+{
+	
+}
+
 HeuristicInterface::~HeuristicInterface()
 {
+	delete worker_pool_;
+}
+
+void HeuristicInterface::setHeuristicForStates(const std::vector<State*>& states, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts, const TermManager& term_manager, bool allow_new_goals_to_be_added)
+{
+	if (worker_pool_ != NULL && states.size() > 1)
+	{
+		worker_pool_->setHeuristicForStates(*this, states, initial_facts, goal_facts, term_manager, allow_new_goals_to_be_added);
+		return;
+	}
 	
+	for (std::vector<State*>::const_iterator ci = states.begin(); ci != states.end(); ++ci)
+	{
+		setHeuristicForState(**ci, initial_facts, goal_facts, term_manager, false, allow_new_goals_to_be_added);
+	}
+}
+
+unsigned int HeuristicInterface::setNumberOfThreads(unsigned int number_of_threads)
+{
+	delete worker_pool_;
+	worker_pool_ = NULL;
+	
+	std::vector<HeuristicInterface*> clones;
+	for (unsigned int i = 1; i < number_of_threads; ++i)
+	{
+		HeuristicInterface* heuristic = clone();
+		if (heuristic == NULL)
+		{
+			break;
+		}
+		clones.push_back(heuristic);
+	}
+	
+	if (clones.empty())
+	{
+		return 1;
+	}
+	worker_pool_ = new HeuristicWorkerPool(clones);
+	return worker_pool_->getNumberOfThreads();
+}
+
+HeuristicInterface* HeuristicInterface::clone() const
+{
+	return NULL;
+}
+
+bool HeuristicInterface::isDeadEnd(const MyPOP::State& state, const std::vector<const GroundedAtom*>& goal_facts)
+{
+	return false;
 }
 
 void HeuristicInterface::getFunctionalSymmetricSets(std::multimap<const Object*, const Object*>& symmetrical_groups, const State& state, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts, const TermManager& term_manager) const
@@ -18,12 +18,42 @@ class AchievingTransition;
 namespace HEURISTICS {
 
 class VariableDomain;
+class HeuristicWorkerPool;
 	
 class HeuristicInterface
 {
 public:
+	HeuristicInterface();
 	virtual ~HeuristicInterface();
 	virtual void setHeuristicForState(MyPOP::State& state, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts, const TermManager& term_manager, bool find_helpful_actions, bool allow_new_goals_to_be_added) = 0;
+	
+	/**
+	 * Set the heuristic of all the given states, no helpful actions are searched for. If more than one thread has been assigned
+	 * by @ref setNumberOfThreads the states are divided among the worker threads, each of which evaluates them with its own
+	 * clone of this heuristic. The heuristic values are the same as those found by calling @ref setHeuristicForState for every state.
+	 */
+	void setHeuristicForStates(const std::vector<MyPOP::State*>& states, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts, const TermManager& term_manager, bool allow_new_goals_to_be_added);
+	
+	/**
+	 * Set the number of threads used by @ref setHeuristicForStates, the calling thread is one of them.
+	 * @param number_of_threads The number of threads, 1 evaluates all states on the calling thread.
+	 * @return The number of threads which will be used, this is 1 if this heuristic cannot be cloned.
+	 */
+	unsigned int setNumberOfThreads(unsigned int number_of_threads);
+	
+	/**
+	 * Create a copy of this heuristic which does not share any mutable state with this heuristic, so it can be used by another thread.
+	 * @return The copy, or NULL if this heuristic cannot be cloned.
+	 */
+	virtual HeuristicInterface* clone() const;
+	
+	/**
+	 * Check whether @param goal_facts cannot be reached from @param state. This can be cheaper than calculating the heuristic
+	 * value of the state, because the search for the goals can stop as soon as all of them are found.
+	 * @return True if @param state is known to be a dead end, heuristics which cannot tell always return false.
+	 */
+	virtual bool isDeadEnd(const MyPOP::State& state, const std::vector<const GroundedAtom*>& goal_facts);
+	
 	virtual void getFunctionalSymmetricSets(std::multimap<const Object*, const Object*>& symmetrical_groups, const State& state, const std::vector<const GroundedAtom*>& initial_facts, const std::vector<const GroundedAtom*>& goal_facts, const TermManager& term_manager) const;
 	
 	const std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > >& getHelpfulActions() const { return helpful_actions_; }
@@ -33,6 +63,11 @@ public:
 protected:
 	
 	std::vector<std::pair<const REACHABILITY::AchievingTransition*, const std::vector<HEURISTICS::VariableDomain*>* > > helpful_actions_;
+	
+private:
+	
+	// The worker threads which evaluate states in parallel, NULL if all states are evaluated on the calling thread.
+	HeuristicWorkerPool* worker_pool_;
 };
 
 };
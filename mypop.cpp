@@ -1,4 +1,7 @@
 #include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <fstream>
@@ -29,6 +32,9 @@
 #include "heuristics/dtg_reachability.h"
 #include "heuristics/equivalent_object_group.h"
 #include "fc_planner.h"
+#include "search_trace.h"
+#include "preprocessing_cache.h"
+#include "portfolio.h"
 #include "heuristics/fact_set.h"
 #include "sas/lifted_dtg.h"
 #include "heuristics/cg_heuristic.h"
@@ -57,19 +63,204 @@ namespace VAL {
 //using namespace VAL;
 using namespace MyPOP;
 
-enum PLANNER_CONFIG { LIFTED_FF, LIFTED_CG, GROUNDED_FF };
+/**
+ * Split up the actions into lifted transitions, these are used by the (grounded) FF heuristic.
+ * @param number_of_threads The number of threads among which the actions are divided.
+ * @param preprocessing_cache If not NULL, the lifted transitions are loaded from this cache if it holds them, otherwise they
+ * are stored in it.
+ */
+void createLiftedTransitions(std::vector<HEURISTICS::LiftedTransition*>& lifted_transitions, const ActionManager& action_manager, const PredicateManager& predicate_manager, const TermManager& term_manager, const TypeManager& type_manager, const std::vector<const Atom*>& initial_facts, unsigned int number_of_threads, PreprocessingCache* preprocessing_cache)
+{
+	if (preprocessing_cache != NULL && preprocessing_cache->startReading() &&
+	    HEURISTICS::LiftedTransition::load(*preprocessing_cache, lifted_transitions, action_manager, predicate_manager, term_manager))
+	{
+		std::cerr << "Lifted transitions: " << lifted_transitions.size() << " (loaded from " << preprocessing_cache->getFileName() << ")" << std::endl;
+		return;
+	}
+	
+	std::vector<const Object*> objects_part_of_property_state;
+	for (std::vector<TIM::PropertySpace*>::const_iterator property_space_i = TIM::TA->pbegin(); property_space_i != TIM::TA->pend(); ++property_space_i)
+	{
+		TIM::PropertySpace* property_space = *property_space_i;
+		for (TIM::PropertySpace::OIterator object_i = property_space->obegin(); object_i != property_space->oend(); ++object_i)
+		{
+			TIM::TIMobjectSymbol* tim_object = *object_i;
+			
+			const Object& object = term_manager.getObject(tim_object->getName());
+			if (std::find(objects_part_of_property_state.begin(), objects_part_of_property_state.end(), &object) == objects_part_of_property_state.end())
+			{
+				objects_part_of_property_state.push_back(&object);
+			}
+		}
+	}
+
+	HEURISTICS::StaticObjectEquivalences static_object_equivalences(term_manager, initial_facts, objects_part_of_property_state);
+	HEURISTICS::LiftedTransition::createLiftedTransitions(lifted_transitions, predicate_manager, type_manager, action_manager.getManagableObjects(), initial_facts, static_object_equivalences, number_of_threads);
+	std::cerr << "Lifted transitions: " << lifted_transitions.size() << std::endl;
+	HEURISTICS::LiftedTransition::mergeFactSets(lifted_transitions);
+	
+	if (preprocessing_cache != NULL && preprocessing_cache->startWriting())
+	{
+		if (HEURISTICS::LiftedTransition::save(*preprocessing_cache, lifted_transitions, action_manager, predicate_manager, term_manager))
+		{
+			preprocessing_cache->finishWriting();
+		}
+		else
+		{
+			preprocessing_cache->abortWriting();
+		}
+	}
+}
+
+/**
+ * Create the heuristic used by @param planner_config.
+ * @param lifted_dtgs The lifted DTGs, only used by the lifted causal graph heuristic.
+ * @param lifted_transitions The lifted transitions, only used by the (grounded) FF heuristic.
+ */
+HEURISTICS::HeuristicInterface* createHeuristic(PLANNER_CONFIG planner_config, const std::vector<SAS_Plus::LiftedDTG*>& lifted_dtgs, const std::vector<HEURISTICS::LiftedTransition*>& lifted_transitions, const ActionManager& action_manager, const PredicateManager& predicate_manager, const TermManager& term_manager, const std::vector<const Atom*>& initial_facts, const std::vector<const Atom*>& goal_facts)
+{
+	if (planner_config == LIFTED_CG)
+	{
+		std::vector<const GroundedAtom*> grounded_goal_facts;
+		for (std::vector<const Atom*>::const_iterator ci = goal_facts.begin(); ci != goal_facts.end(); ++ci)
+		{
+			const Atom* goal = *ci;
+			const Object** variables = new const Object*[goal->getArity()];
+			for (unsigned int term_index = 0; term_index < goal->getArity(); ++term_index)
+			{
+				variables[term_index] = static_cast<const Object*>(goal->getTerms()[term_index]);
+			}
+			grounded_goal_facts.push_back(&GroundedAtom::getGroundedAtom(goal->getPredicate(), variables));
+		}
+		
+		std::vector<const GroundedAtom*> grounded_initial_facts;
+		for (std::vector<const Atom*>::const_iterator ci = initial_facts.begin(); ci != initial_facts.end(); ++ci)
+		{
+			const Atom* init = *ci;
+			const Object** variables = new const Object*[init->getArity()];
+			for (unsigned int term_index = 0; term_index < init->getArity(); ++term_index)
+			{
+				variables[term_index] = static_cast<const Object*>(init->getTerms()[term_index]);
+			}
+			grounded_initial_facts.push_back(&GroundedAtom::getGroundedAtom(init->getPredicate(), variables));
+		}
+		
+		return new HEURISTICS::LiftedCausalGraphHeuristic(lifted_dtgs, action_manager, predicate_manager, grounded_goal_facts);
+	}
+	
+	// Do the reachability analysis.
+#ifdef MYPOP_KEEP_TIME
+	struct timeval start_time_prepare_reachability;
+	gettimeofday(&start_time_prepare_reachability, NULL);
+#endif
+
+	HEURISTICS::HeuristicInterface* heuristic_interface = new REACHABILITY::DTGReachability(lifted_transitions, term_manager, predicate_manager, planner_config == GROUNDED_FF);
+#ifdef MYPOP_KEEP_TIME
+	struct timeval end_time_prepare_reachability;
+	gettimeofday(&end_time_prepare_reachability, NULL);	
+	
+	double time_spend_preparing = end_time_prepare_reachability.tv_sec - start_time_prepare_reachability.tv_sec + (end_time_prepare_reachability.tv_usec - start_time_prepare_reachability.tv_usec) / 1000000.0;
+	std::cerr << "Prepare reachability analysis: " << time_spend_preparing << " seconds" << std::endl;
+#endif
+	return heuristic_interface;
+}
+
+/**
+ * Runs a single configuration of the portfolio, the plan is only reported if it is valid.
+ */
+class PlannerPortfolioSolver : public PortfolioSolver
+{
+public:
+	PlannerPortfolioSolver(const std::vector<SAS_Plus::LiftedDTG*>& lifted_dtgs, const std::vector<HEURISTICS::LiftedTransition*>& lifted_transitions, const ActionManager& action_manager, PredicateManager& predicate_manager, const TypeManager& type_manager, const TermManager& term_manager, const std::vector<const Atom*>& initial_facts, const std::vector<const Atom*>& goal_facts, const std::string& domain_name, const std::string& problem_name)
+		: number_of_threads_(1), memory_budget_(0), seed_(0), lifted_dtgs_(&lifted_dtgs), lifted_transitions_(&lifted_transitions), action_manager_(&action_manager), predicate_manager_(&predicate_manager), type_manager_(&type_manager), term_manager_(&term_manager), initial_facts_(&initial_facts), goal_facts_(&goal_facts), domain_name_(domain_name), problem_name_(problem_name)
+	{
+		
+	}
+	
+	bool solve(const PortfolioConfiguration& configuration, std::ostream& result)
+	{
+		HEURISTICS::HeuristicInterface* heuristic_interface = createHeuristic(configuration.planner_config_, *lifted_dtgs_, *lifted_transitions_, *action_manager_, *predicate_manager_, *term_manager_, *initial_facts_, *goal_facts_);
+		if (number_of_threads_ > 1)
+		{
+			heuristic_interface->setNumberOfThreads(number_of_threads_);
+		}
+		
+		ForwardChainingPlanner fcp(*action_manager_, *predicate_manager_, *type_manager_, *heuristic_interface);
+		fcp.setSearchStrategy(search_strategy_);
+		fcp.setMemoryBudget(memory_budget_);
+		fcp.setSeed(seed_);
+		
+		std::vector<const GroundedAction*> found_plan;
+		std::pair<int, int> search_result = fcp.findPlan(found_plan, *initial_facts_, *goal_facts_, *term_manager_, configuration.prune_unhelpful_actions_, configuration.allow_restarts_, false);
+		if (search_result.first == -1)
+		{
+			return false;
+		}
+		
+		std::stringstream plan_stream;
+		for (std::vector<const GroundedAction*>::const_iterator ci = found_plan.begin(); ci != found_plan.end(); ci++)
+		{
+			plan_stream << **ci << std::endl;
+		}
+		std::string plan = plan_stream.str();
+		if (!VAL::checkPlan(domain_name_, problem_name_, plan_stream))
+		{
+			return false;
+		}
+		
+		result << search_result.first << " " << search_result.second << std::endl << plan;
+		return true;
+	}
+	
+	SearchStrategy search_strategy_;
+	unsigned int number_of_threads_;
+	std::size_t memory_budget_;
+	uint32_t seed_;
+	
+private:
+	const std::vector<SAS_Plus::LiftedDTG*>* lifted_dtgs_;
+	const std::vector<HEURISTICS::LiftedTransition*>* lifted_transitions_;
+	const ActionManager* action_manager_;
+	PredicateManager* predicate_manager_;
+	const TypeManager* type_manager_;
+	const TermManager* term_manager_;
+	const std::vector<const Atom*>* initial_facts_;
+	const std::vector<const Atom*>* goal_facts_;
+	std::string domain_name_;
+	std::string problem_name_;
+};
+
+/**
+ * Print the command line options to @param os.
+ */
+void printUsage(std::ostream& os)
+{
+	os << "Usage: mypop <options> <domain file> <problem file>." << std::endl;
+	os << "\tOptions:" << std::endl;
+	os << "\t-cg  - Lifted Causal Graph Heuristic." << std::endl;
+	os << "\t-ff  - Lifted Fast Forward. (default)" << std::endl;
+	os << "\t-gff - Grounded Fast Forward." << std::endl;
+	os << "\t-nr  - Disable restarts. (default = restarts are allowed)" << std::endl;
+	os << "\t-portfolio - Run -ff, -gff and -cg with and without pruning and restarts in parallel, the first plan found wins." << std::endl;
+	os << "\t-j <jobs> - Number of configurations of -portfolio which run at the same time. (default = number of hardware threads)" << std::endl;
+	os << "\t-t <threads> - Number of threads used to create the lifted transitions and to evaluate successor states. (default = 1)" << std::endl;
+	os << "\t-wa <weight> - Weighted A* with the given weight. (default = greedy best first search)" << std::endl;
+	os << "\t-fifo - Break ties first in first out. (default = random)" << std::endl;
+	os << "\t-lifo - Break ties last in first out. (default = random)" << std::endl;
+	os << "\t-ha  - Alternate between states reached by helpful actions and other states. (default = false)" << std::endl;
+	os << "\t--seed <seed> - Seed of the random number generator. (default = the current time)" << std::endl;
+	os << "\t-m <megabytes> - Memory budget of the search. (default = unlimited)" << std::endl;
+	os << "\t--trace <file> - Record the order in which states are expanded to a file." << std::endl;
+	os << "\t--replay <file> - Compare the search against a recorded trace, uses the recorded seed unless --seed is given." << std::endl;
+	os << "\t--cache <directory> - Store the lifted transitions in the directory and reuse them for the same domain and problem." << std::endl;
+}
 
 int main(int argc,char * argv[])
 {
 	// The first line is the debug level.
 	if (argc < 3)
 	{
-		std::cout << "Usage: mypop <options> <domain file> <problem file>." << std::endl;
-		std::cout << "\tOptions:" << std::endl;
-		std::cout << "\t-cg  - Lifted Causal Graph Heuristic." << std::endl;
-		std::cout << "\t-ff  - Lifted Fast Forward. (default)" << std::endl;
-		std::cout << "\t-gff - Grounded Fast Forward." << std::endl;
-		std::cout << "\t-r   - Allow restarts. (default = false)" << std::endl;
+		printUsage(std::cout);
 		exit(1);
 	}
 
@@ -78,6 +269,16 @@ int main(int argc,char * argv[])
 
 	PLANNER_CONFIG planner_config = LIFTED_FF;
 	bool allow_restarts = true;
+	unsigned int number_of_threads = 1;
+	SearchStrategy search_strategy;
+	uint32_t seed = time(NULL);
+	bool use_seed = false;
+	std::string trace_file;
+	bool replay_trace = false;
+	std::string cache_directory;
+	std::size_t memory_budget = 0;
+	bool use_portfolio = false;
+	unsigned int portfolio_jobs = 0;
 	
 	//bool use_ff = true;
 	//bool use_grounded_ff = false;
@@ -97,23 +298,71 @@ int main(int argc,char * argv[])
 		{
 			planner_config = GROUNDED_FF;
 		}
+		else if (command_line == "-portfolio")
+		{
+			use_portfolio = true;
+		}
+		else if (command_line == "-j" && i + 1 < argc - 2)
+		{
+			portfolio_jobs = std::max(1, atoi(argv[++i]));
+		}
 		else if (command_line == "-nr")
 		{
 			allow_restarts = false;
 		}
+		else if (command_line == "-t" && i + 1 < argc - 2)
+		{
+			number_of_threads = std::max(1, atoi(argv[++i]));
+		}
+		else if (command_line == "-wa" && i + 1 < argc - 2)
+		{
+			search_strategy.g_weight_ = 1;
+			search_strategy.h_weight_ = std::max(1, atoi(argv[++i]));
+		}
+		else if (command_line == "-fifo")
+		{
+			search_strategy.tie_breaking_ = TIE_BREAKING_FIFO;
+		}
+		else if (command_line == "-lifo")
+		{
+			search_strategy.tie_breaking_ = TIE_BREAKING_LIFO;
+		}
+		else if (command_line == "-ha")
+		{
+			search_strategy.alternate_helpful_states_ = true;
+		}
+		else if (command_line == "-m" && i + 1 < argc - 2)
+		{
+			memory_budget = strtoul(argv[++i], NULL, 10) * 1024 * 1024;
+		}
+		else if (command_line == "--seed" && i + 1 < argc - 2)
+		{
+			seed = strtoul(argv[++i], NULL, 10);
+			use_seed = true;
+		}
+		else if ((command_line == "--trace" || command_line == "--replay") && i + 1 < argc - 2)
+		{
+			trace_file = argv[++i];
+			replay_trace = command_line == "--replay";
+		}
+		else if (command_line == "--cache" && i + 1 < argc - 2)
+		{
+			cache_directory = argv[++i];
+		}
 		else
 		{
 			std::cerr << "Unknown option " << command_line << std::endl << std::endl;
-			std::cerr << "Usage: mypop <options> <domain file> <problem file>." << std::endl;
-			std::cerr << "\tOptions:" << std::endl;
-			std::cerr << "\t-cg  - Lifted Causal Graph Heuristic." << std::endl;
-			std::cerr << "\t-ff  - Lifted Fast Forward. (default)" << std::endl;
-			std::cerr << "\t-gff - Grounded Fast Forward." << std::endl;
-			std::cerr << "\t-nr  - Disable restarts." << std::endl;
+			printUsage(std::cerr);
 			exit(1);
 		}
 	}
 	
+	if (use_portfolio && !trace_file.empty())
+	{
+		std::cerr << "--trace and --replay cannot be combined with -portfolio." << std::endl;
+		exit(1);
+	}
+	
 	std::string problem_name(argv[argc - 1]);
 	std::string domain_name(argv[argc - 2]);
 	
@@ -271,108 +520,127 @@ int main(int argc,char * argv[])
 	std::vector<const Atom*> goal_facts;
 	Utility::convertFormula(goal_facts, goal);
 
-	HEURISTICS::HeuristicInterface* heuristic_interface = NULL;
+	// The preprocessing is done once, before the configurations of a portfolio are started.
+	std::vector<PortfolioConfiguration> configurations;
+	if (use_portfolio)
+	{
+		PortfolioRunner::getDefaultConfigurations(configurations);
+	}
+	else
+	{
+		configurations.push_back(PortfolioConfiguration(planner_config, true, allow_restarts));
+	}
 	
-	if (planner_config == LIFTED_CG)
+	bool use_lifted_dtgs = false;
+	bool use_lifted_transitions = false;
+	for (std::vector<PortfolioConfiguration>::const_iterator ci = configurations.begin(); ci != configurations.end(); ++ci)
+	{
+		if ((*ci).planner_config_ == LIFTED_CG) use_lifted_dtgs = true;
+		else use_lifted_transitions = true;
+	}
+	
+	std::vector<SAS_Plus::LiftedDTG*>* lifted_dtgs = new std::vector<SAS_Plus::LiftedDTG*>();
+	if (use_lifted_dtgs)
 	{
-		std::vector<SAS_Plus::LiftedDTG*>* lifted_dtgs = new std::vector<SAS_Plus::LiftedDTG*>();
 		SAS_Plus::LiftedDTG::createLiftedDTGs(*lifted_dtgs, *the_domain->types, predicate_manager, type_manager, action_manager, term_manager, initial_facts);
 		Graphviz::printToDot(*lifted_dtgs);
-		
-		std::vector<const GroundedAtom*> grounded_goal_facts;
-		for (std::vector<const Atom*>::const_iterator ci = goal_facts.begin(); ci != goal_facts.end(); ++ci)
+	}
+	
+	std::vector<HEURISTICS::LiftedTransition*> lifted_transitions;
+	if (use_lifted_transitions)
+	{
+		PreprocessingCache* preprocessing_cache = NULL;
+		if (!cache_directory.empty())
 		{
-			const Atom* goal = *ci;
-			const Object** variables = new const Object*[goal->getArity()];
-			for (unsigned int term_index = 0; term_index < goal->getArity(); ++term_index)
-			{
-				variables[term_index] = static_cast<const Object*>(goal->getTerms()[term_index]);
-			}
-			grounded_goal_facts.push_back(&GroundedAtom::getGroundedAtom(goal->getPredicate(), variables));
+			preprocessing_cache = new PreprocessingCache(cache_directory, domain_name, problem_name);
 		}
+		createLiftedTransitions(lifted_transitions, action_manager, predicate_manager, term_manager, type_manager, initial_facts, number_of_threads, preprocessing_cache);
+		delete preprocessing_cache;
+	}
+	
+	HEURISTICS::HeuristicInterface* heuristic_interface = NULL;
+	std::stringstream plan_stream;
+	std::pair<int, int> result(-1, -1);
+	
+	if (use_portfolio)
+	{
+		std::cerr << "Seed: " << seed << std::endl;
+		PlannerPortfolioSolver solver(*lifted_dtgs, lifted_transitions, action_manager, predicate_manager, type_manager, term_manager, initial_facts, goal_facts, domain_name, problem_name);
+		solver.search_strategy_ = search_strategy;
+		solver.number_of_threads_ = number_of_threads;
+		solver.memory_budget_ = memory_budget;
+		solver.seed_ = seed;
 		
-		std::vector<const GroundedAtom*> grounded_initial_facts;
-		for (std::vector<const Atom*>::const_iterator ci = initial_facts.begin(); ci != initial_facts.end(); ++ci)
+		PortfolioRunner portfolio(configurations, portfolio_jobs);
+		std::string portfolio_result;
+		int winner = portfolio.run(solver, portfolio_result);
+		if (winner != -1)
 		{
-			const Atom* init = *ci;
-			const Object** variables = new const Object*[init->getArity()];
-			for (unsigned int term_index = 0; term_index < init->getArity(); ++term_index)
+			std::cerr << "Plan found by: " << configurations[winner] << std::endl;
+			
+			// The first line holds the number of states visited and the length of the plan, followed by the plan itself.
+			std::size_t end_of_line = portfolio_result.find('\n');
+			std::stringstream header(portfolio_result.substr(0, end_of_line));
+			header >> result.first >> result.second;
+			if (end_of_line != std::string::npos)
 			{
-				variables[term_index] = static_cast<const Object*>(init->getTerms()[term_index]);
+				plan_stream << portfolio_result.substr(end_of_line + 1);
 			}
-			grounded_initial_facts.push_back(&GroundedAtom::getGroundedAtom(init->getPredicate(), variables));
+			std::cout << plan_stream.str();
 		}
-		
-		heuristic_interface = new HEURISTICS::LiftedCausalGraphHeuristic(*lifted_dtgs, action_manager, predicate_manager, grounded_goal_facts);
 	}
 	else
 	{
-		// Split up the actions into lifted actions.
-		std::vector<const Object*> objects_part_of_property_state;
-		for (std::vector<TIM::PropertySpace*>::const_iterator property_space_i = TIM::TA->pbegin(); property_space_i != TIM::TA->pend(); ++property_space_i)
+		heuristic_interface = createHeuristic(planner_config, *lifted_dtgs, lifted_transitions, action_manager, predicate_manager, term_manager, initial_facts, goal_facts);
+		
+		if (number_of_threads > 1)
 		{
-			TIM::PropertySpace* property_space = *property_space_i;
-			for (TIM::PropertySpace::OIterator object_i = property_space->obegin(); object_i != property_space->oend(); ++object_i)
+			std::cerr << "Heuristic threads: " << heuristic_interface->setNumberOfThreads(number_of_threads) << std::endl;
+		}
+		
+		std::vector<const GroundedAction*> found_plan;
+		ForwardChainingPlanner fcp(action_manager, predicate_manager, type_manager, *heuristic_interface);
+		fcp.setSearchStrategy(search_strategy);
+		fcp.setMemoryBudget(memory_budget);
+		
+		SearchTrace* search_trace = NULL;
+		if (!trace_file.empty())
+		{
+			search_trace = new SearchTrace(trace_file, replay_trace, seed);
+			if (replay_trace && !use_seed)
 			{
-				TIM::TIMobjectSymbol* tim_object = *object_i;
-				
-				const Object& object = term_manager.getObject(tim_object->getName());
-				if (std::find(objects_part_of_property_state.begin(), objects_part_of_property_state.end(), &object) == objects_part_of_property_state.end())
-				{
-					objects_part_of_property_state.push_back(&object);
-				}
+				seed = search_trace->getSeed();
 			}
+			fcp.setSearchTrace(search_trace);
 		}
-
-		std::vector<HEURISTICS::LiftedTransition*> lifted_transitions;
-		for (std::vector<Action*>::const_iterator ci = action_manager.getManagableObjects().begin(); ci != action_manager.getManagableObjects().end(); ++ci)
+		std::cerr << "Seed: " << seed << std::endl;
+		fcp.setSeed(seed);
+		
+		result = fcp.findPlan(found_plan, initial_facts, goal_facts, term_manager, true, allow_restarts, false);
+		
+		// If the greedy method failed, try the non greedy method!
+		if (result.first == -1)
 		{
-			const Action* action = *ci;
-			HEURISTICS::LiftedTransition::createLiftedTransitions(lifted_transitions, predicate_manager, term_manager, type_manager, *action, initial_facts, objects_part_of_property_state);
+			found_plan.clear();
+			GroundedAtom::removeInstantiatedGroundedAtom();
+			GroundedAction::removeInstantiatedGroundedActions();
+			result = fcp.findPlan(found_plan, initial_facts, goal_facts, term_manager, false, allow_restarts, false);
 		}
-		std::cerr << "Lifted transitions: " << lifted_transitions.size() << std::endl;
-		HEURISTICS::LiftedTransition::mergeFactSets(lifted_transitions);
-//	std::cerr << "Total number of transitions: " << nr_transitions << "; Total of DTGs: " << dtg_manager->getManagableObjects().size() << "." << std::endl;
-
-
-	// Do the reachability analysis.
-#ifdef MYPOP_KEEP_TIME
-		struct timeval start_time_prepare_reachability;
-		gettimeofday(&start_time_prepare_reachability, NULL);
-#endif
-
-		heuristic_interface = new REACHABILITY::DTGReachability(lifted_transitions, term_manager, predicate_manager, planner_config == GROUNDED_FF);
-#ifdef MYPOP_KEEP_TIME
-		struct timeval end_time_prepare_reachability;
-		gettimeofday(&end_time_prepare_reachability, NULL);	
 		
-		double time_spend_preparing = end_time_prepare_reachability.tv_sec - start_time_prepare_reachability.tv_sec + (end_time_prepare_reachability.tv_usec - start_time_prepare_reachability.tv_usec) / 1000000.0;
-		std::cerr << "Prepare reachability analysis: " << time_spend_preparing << " seconds" << std::endl;
-#endif
+		if (search_trace != NULL)
+		{
+			search_trace->finish();
+			delete search_trace;
+		}
+		
+		for (std::vector<const GroundedAction*>::const_iterator ci = found_plan.begin(); ci != found_plan.end(); ci++)
+		{
+			plan_stream << **ci << std::endl;
+			std::cout << **ci << std::endl;
+		}
 	}
 	
-	std::vector<const GroundedAction*> found_plan;
-	ForwardChainingPlanner fcp(action_manager, predicate_manager, type_manager, *heuristic_interface);
-	std::pair<int, int> result;
-	
-	result = fcp.findPlan(found_plan, initial_facts, goal_facts, term_manager, true, allow_restarts, false);
-	
-	// If the greedy method failed, try the non greedy method!
-	if (result.first == -1)
-	{
-		found_plan.clear();
-		GroundedAtom::removeInstantiatedGroundedAtom();
-		GroundedAction::removeInstantiatedGroundedActions();
-		result = fcp.findPlan(found_plan, initial_facts, goal_facts, term_manager, false, allow_restarts, false);
-	}
-		
 	// Validate the plan!
-	std::stringstream plan_stream;
-	for (std::vector<const GroundedAction*>::const_iterator ci = found_plan.begin(); ci != found_plan.end(); ci++)
-	{
-		plan_stream << **ci << std::endl;
-		std::cout << **ci << std::endl;
-	}
 	if (VAL::checkPlan(domain_name, problem_name, plan_stream))
 	{
 		std::cerr << "Valid plan!" << std::endl;
@@ -382,10 +650,7 @@ int main(int argc,char * argv[])
 	else
 	{
 		std::cerr << "Invalid plan!" << std::endl;
-		for (std::vector<const GroundedAction*>::const_iterator ci = found_plan.begin(); ci != found_plan.end(); ci++)
-		{
-			std::cerr << **ci << std::endl;
-		}
+		std::cerr << plan_stream.str();
 		std::cerr << "States visited: -1" << std::endl;
 		std::cerr << "Plan length: -1" << std::endl;
 	}
@@ -619,7 +619,7 @@ void Bindings::removeRedundantVariables()
 bool Bindings::canUnify(const Atom& atom1, StepID step1, const Atom& atom2, StepID step2, const Bindings* other_bindings) const
 {
 	// Make sure the predicates are the same.
-	if (atom1.getPredicate().getName() != atom2.getPredicate().getName())
+	if (atom1.getPredicate().getNameId() != atom2.getPredicate().getNameId())
 	{
 		return false;
 	}
@@ -752,7 +752,7 @@ bool Bindings::areEquivalent(const Atom& atom1, StepID step1, const Atom& atom2,
 bool Bindings::affects(const Atom& atom1, StepID step1, const Atom& atom2, const StepID step2) const
 {
 	// First make sure the predicates are the same.
-	if (atom1.getPredicate().getName() != atom2.getPredicate().getName())
+	if (atom1.getPredicate().getNameId() != atom2.getPredicate().getNameId())
 	//if (&atom1.getPredicate() != &atom2.getPredicate())
 		return false;
 
@@ -0,0 +1,332 @@
+#include "portfolio.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#include "fc_planner.h"
+
+namespace MyPOP
+{
+
+namespace
+{
+
+double getTime()
+{
+	struct timeval time;
+	gettimeofday(&time, NULL);
+	return time.tv_sec + time.tv_usec / 1000000.0;
+}
+
+void stopSearch(int)
+{
+	ForwardChainingPlanner::requestStop();
+}
+
+bool writeAll(int fd, const std::string& data)
+{
+	std::size_t written = 0;
+	while (written < data.size())
+	{
+		ssize_t bytes = write(fd, data.data() + written, data.size() - written);
+		if (bytes < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (bytes <= 0)
+		{
+			return false;
+		}
+		written += bytes;
+	}
+	return true;
+}
+
+};
+
+PortfolioConfiguration::PortfolioConfiguration(PLANNER_CONFIG planner_config, bool prune_unhelpful_actions, bool allow_restarts)
+	: planner_config_(planner_config), prune_unhelpful_actions_(prune_unhelpful_actions), allow_restarts_(allow_restarts)
+{
+
+}
+
+std::ostream& operator<<(std::ostream& os, const PortfolioConfiguration& configuration)
+{
+	switch (configuration.planner_config_)
+	{
+		case LIFTED_FF:
+			os << "-ff";
+			break;
+		case GROUNDED_FF:
+			os << "-gff";
+			break;
+		case LIFTED_CG:
+			os << "-cg";
+			break;
+	}
+	os << (configuration.prune_unhelpful_actions_ ? " (pruning" : " (no pruning");
+	os << (configuration.allow_restarts_ ? ", restarts)" : ", no restarts)");
+	return os;
+}
+
+const double PortfolioRunner::CANCEL_GRACE_PERIOD = 2.0;
+
+PortfolioRunner::PortfolioRunner(const std::vector<PortfolioConfiguration>& configurations, unsigned int max_running)
+	: configurations_(configurations), max_running_(max_running)
+{
+	if (max_running_ == 0)
+	{
+		long hardware_threads = sysconf(_SC_NPROCESSORS_ONLN);
+		max_running_ = hardware_threads > 0 ? hardware_threads : 1;
+	}
+}
+
+void PortfolioRunner::getDefaultConfigurations(std::vector<PortfolioConfiguration>& configurations)
+{
+	PLANNER_CONFIG planner_configs[] = { LIFTED_FF, GROUNDED_FF, LIFTED_CG };
+	for (unsigned int i = 0; i < sizeof(planner_configs) / sizeof(PLANNER_CONFIG); ++i)
+	{
+		configurations.push_back(PortfolioConfiguration(planner_configs[i], true, true));
+		configurations.push_back(PortfolioConfiguration(planner_configs[i], false, true));
+		configurations.push_back(PortfolioConfiguration(planner_configs[i], true, false));
+		configurations.push_back(PortfolioConfiguration(planner_configs[i], false, false));
+	}
+}
+
+int PortfolioRunner::run(PortfolioSolver& solver, std::string& result)
+{
+	// Otherwise the buffered output is written by every child as well.
+	std::cout.flush();
+	std::cerr.flush();
+
+	std::vector<Run> runs(configurations_.size());
+	for (std::vector<Run>::iterator i = runs.begin(); i != runs.end(); ++i)
+	{
+		(*i).pid_ = -1;
+		(*i).fd_ = -1;
+		(*i).status_ = NOT_STARTED;
+		(*i).start_time_ = 0;
+		(*i).time_ = 0;
+	}
+
+	int winner = -1;
+	double cancel_time = 0;
+	unsigned int running = 0;
+	unsigned int next_run = 0;
+
+	while (true)
+	{
+		// Start the next configurations while there is room, unless a plan has already been found.
+		while (winner == -1 && running < max_running_ && next_run < runs.size())
+		{
+			Run& run = runs[next_run];
+			start(solver, configurations_[next_run], runs, run);
+			run.start_time_ = getTime();
+			++next_run;
+			if (run.status_ == RUNNING)
+			{
+				++running;
+			}
+		}
+
+		if (running == 0)
+		{
+			break;
+		}
+
+		fd_set read_fds;
+		FD_ZERO(&read_fds);
+		int max_fd = -1;
+		for (std::vector<Run>::const_iterator ci = runs.begin(); ci != runs.end(); ++ci)
+		{
+			if ((*ci).fd_ != -1)
+			{
+				FD_SET((*ci).fd_, &read_fds);
+				max_fd = std::max(max_fd, (*ci).fd_);
+			}
+		}
+
+		struct timeval timeout = { 0, 100000 };
+		if (select(max_fd + 1, &read_fds, NULL, NULL, &timeout) < 0 && errno != EINTR)
+		{
+			std::cerr << "Portfolio: select failed." << std::endl;
+			break;
+		}
+
+		for (unsigned int i = 0; i < runs.size(); ++i)
+		{
+			Run& run = runs[i];
+			if (run.fd_ == -1 || !FD_ISSET(run.fd_, &read_fds))
+			{
+				continue;
+			}
+
+			char buffer[4096];
+			ssize_t bytes = read(run.fd_, buffer, sizeof(buffer));
+			if (bytes < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (bytes > 0)
+			{
+				run.output_.append(buffer, bytes);
+				continue;
+			}
+
+			// The child closed the pipe, it has finished.
+			finish(run, winner != -1, getTime() - run.start_time_);
+			--running;
+
+			if (run.status_ == FOUND_PLAN && winner == -1)
+			{
+				winner = i;
+				result = run.output_;
+				cancel_time = getTime();
+				for (std::vector<Run>::const_iterator ci = runs.begin(); ci != runs.end(); ++ci)
+				{
+					if ((*ci).status_ == RUNNING)
+					{
+						kill((*ci).pid_, SIGTERM);
+					}
+				}
+			}
+		}
+
+		// Configurations which ignore the request to stop, e.g. because they are still preprocessing, are killed.
+		if (winner != -1 && getTime() - cancel_time > CANCEL_GRACE_PERIOD)
+		{
+			for (std::vector<Run>::const_iterator ci = runs.begin(); ci != runs.end(); ++ci)
+			{
+				if ((*ci).status_ == RUNNING)
+				{
+					kill((*ci).pid_, SIGKILL);
+				}
+			}
+		}
+	}
+
+	for (unsigned int i = 0; i < runs.size(); ++i)
+	{
+		const Run& run = runs[i];
+		std::cerr << "Portfolio: " << configurations_[i] << ": ";
+		switch (run.status_)
+		{
+			case FOUND_PLAN:
+				std::cerr << ((int)i == winner ? "found the plan" : "found a plan");
+				break;
+			case FAILED:
+				std::cerr << "no plan found";
+				break;
+			case CANCELLED:
+				std::cerr << "cancelled";
+				break;
+			case CRASHED:
+				std::cerr << "crashed";
+				break;
+			case RUNNING:
+				std::cerr << "did not finish";
+				break;
+			case NOT_STARTED:
+				std::cerr << "not started." << std::endl;
+				continue;
+		}
+		std::cerr << " after " << run.time_ << " seconds." << std::endl;
+	}
+	return winner;
+}
+
+void PortfolioRunner::start(PortfolioSolver& solver, const PortfolioConfiguration& configuration, const std::vector<Run>& runs, Run& run) const
+{
+	run.pid_ = -1;
+	run.fd_ = -1;
+	run.status_ = CRASHED;
+
+	int fds[2];
+	if (pipe(fds) != 0)
+	{
+		std::cerr << "Portfolio: could not create a pipe for " << configuration << "." << std::endl;
+		return;
+	}
+
+	pid_t pid = fork();
+	if (pid < 0)
+	{
+		std::cerr << "Portfolio: could not start " << configuration << "." << std::endl;
+		close(fds[0]);
+		close(fds[1]);
+		return;
+	}
+
+	if (pid == 0)
+	{
+		close(fds[0]);
+		for (std::vector<Run>::const_iterator ci = runs.begin(); ci != runs.end(); ++ci)
+		{
+			if ((*ci).fd_ != -1) close((*ci).fd_);
+		}
+
+		signal(SIGTERM, stopSearch);
+
+		// The output of the configurations would be interleaved, only the result of the winner is reported.
+		int null_fd = open("/dev/null", O_WRONLY);
+		if (null_fd != -1)
+		{
+			dup2(null_fd, STDOUT_FILENO);
+			dup2(null_fd, STDERR_FILENO);
+			close(null_fd);
+		}
+
+		std::stringstream result;
+		bool found_plan = solver.solve(configuration, result) && !ForwardChainingPlanner::isStopRequested();
+		if (found_plan)
+		{
+			found_plan = writeAll(fds[1], result.str());
+		}
+		close(fds[1]);
+
+		// Skip the destructors of the static objects, they belong to the process which started the portfolio.
+		_exit(found_plan ? 0 : 1);
+	}
+
+	close(fds[1]);
+	run.pid_ = pid;
+	run.fd_ = fds[0];
+	run.status_ = RUNNING;
+}
+
+void PortfolioRunner::finish(Run& run, bool cancelled, double time) const
+{
+	close(run.fd_);
+	run.fd_ = -1;
+	run.time_ = time;
+
+	int status = 0;
+	while (waitpid(run.pid_, &status, 0) < 0 && errno == EINTR);
+
+	if (WIFEXITED(status) && WEXITSTATUS(status) == 0 && !run.output_.empty())
+	{
+		run.status_ = FOUND_PLAN;
+	}
+	else if (cancelled)
+	{
+		run.status_ = CANCELLED;
+	}
+	else if (WIFEXITED(status))
+	{
+		run.status_ = FAILED;
+	}
+	else
+	{
+		run.status_ = CRASHED;
+	}
+}
+
+};
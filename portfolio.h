@@ -0,0 +1,113 @@
+#ifndef MYPOP_PORTFOLIO_H
+#define MYPOP_PORTFOLIO_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace MyPOP
+{
+
+enum PLANNER_CONFIG { LIFTED_FF, LIFTED_CG, GROUNDED_FF };
+
+/**
+ * One configuration of the portfolio: the heuristic and the settings of the forward chaining planner.
+ */
+struct PortfolioConfiguration
+{
+	PortfolioConfiguration(PLANNER_CONFIG planner_config, bool prune_unhelpful_actions, bool allow_restarts);
+
+	PLANNER_CONFIG planner_config_;
+	bool prune_unhelpful_actions_;
+	bool allow_restarts_;
+};
+
+std::ostream& operator<<(std::ostream& os, const PortfolioConfiguration& configuration);
+
+/**
+ * Solves the problem with a single configuration of the portfolio.
+ */
+class PortfolioSolver
+{
+public:
+	virtual ~PortfolioSolver() { }
+
+	/**
+	 * Try to find a plan using @param configuration. Called in a separate process.
+	 * @param result The output of a successful run, handed to the process which started the portfolio.
+	 * @return True if a valid plan has been found, false otherwise.
+	 */
+	virtual bool solve(const PortfolioConfiguration& configuration, std::ostream& result) = 0;
+};
+
+/**
+ * Runs several configurations of the planner at the same time, each in its own process. The processes are forked after the
+ * domain and problem have been parsed and preprocessed, so they all share this work. At most a given number of configurations
+ * run at the same time, the next configuration is started once one finishes. The first configuration to find a valid plan
+ * wins, all the others are asked to stop (SIGTERM, which makes the forward chaining planner return) and are killed if they
+ * do not stop within a grace period. The configurations which have not been started by then are not started at all.
+ */
+class PortfolioRunner
+{
+public:
+	/**
+	 * @param max_running The largest number of configurations which run at the same time, 0 means one per hardware thread.
+	 */
+	PortfolioRunner(const std::vector<PortfolioConfiguration>& configurations, unsigned int max_running = 0);
+
+	/**
+	 * The default portfolio: the lifted FF, grounded FF and lifted causal graph heuristics, each with and without pruning
+	 * unhelpful actions and with and without restarts.
+	 */
+	static void getDefaultConfigurations(std::vector<PortfolioConfiguration>& configurations);
+
+	/**
+	 * Run all the configurations until one of them finds a plan or all of them fail. The time taken by every configuration
+	 * is reported on std::cerr.
+	 * @param solver Called in every child process with the configuration it has to solve.
+	 * @param result The output of the configuration which found a plan.
+	 * @return The index of the configuration which found a plan, or -1 if none did.
+	 */
+	int run(PortfolioSolver& solver, std::string& result);
+
+private:
+
+	enum RUN_STATUS { NOT_STARTED, RUNNING, FOUND_PLAN, FAILED, CANCELLED, CRASHED };
+
+	/**
+	 * The bookkeeping of a single child process.
+	 */
+	struct Run
+	{
+		pid_t pid_;
+		// The reading end of the pipe the child writes its result to, -1 once it is closed.
+		int fd_;
+		std::string output_;
+		RUN_STATUS status_;
+		// The time the child was started and the time it took to finish, both in seconds.
+		double start_time_;
+		double time_;
+	};
+
+	/**
+	 * Fork the child process which solves @param configuration.
+	 * @param runs All the runs, the child closes the pipes of those which have been started.
+	 */
+	void start(PortfolioSolver& solver, const PortfolioConfiguration& configuration, const std::vector<Run>& runs, Run& run) const;
+
+	/**
+	 * Reap the child process of @param run once the pipe it wrote to has been closed, and record how it ended.
+	 */
+	void finish(Run& run, bool cancelled, double time) const;
+
+	std::vector<PortfolioConfiguration> configurations_;
+	unsigned int max_running_;
+
+	// The number of seconds a cancelled configuration is given to stop before it is killed.
+	static const double CANCEL_GRACE_PERIOD;
+};
+
+};
+
+#endif
@@ -12,11 +12,22 @@
 
 namespace MyPOP {
 
+std::map<std::string, unsigned int> Predicate::name_ids_;
+
 //Predicate::Predicate(const std::string& name)
 Predicate::Predicate(const std::string& name, const std::vector<const Type*>& types, bool is_static)
 	: name_(name), types_(&types), is_static_(is_static), can_substitute_(NULL)
 {
-	
+	std::map<std::string, unsigned int>::const_iterator ci = name_ids_.find(name);
+	if (ci == name_ids_.end())
+	{
+		name_id_ = name_ids_.size();
+		name_ids_[name] = name_id_;
+	}
+	else
+	{
+		name_id_ = (*ci).second;
+	}
 }
 
 Predicate::~Predicate()
@@ -41,7 +52,7 @@ bool Predicate::canSubstitute(const Predicate& predicate) const
 {
 	if (can_substitute_ == NULL)
 	{
-		if (predicate.getName() != name_)
+		if (predicate.getNameId() != name_id_)
 			return false;
 
 		if (predicate.getArity() != getArity())
@@ -68,7 +79,7 @@ bool Predicate::canSubstitute(const Predicate& predicate) const
 
 bool Predicate::operator==(const Predicate& predicate) const
 {
-	if (predicate.getName() != name_)
+	if (predicate.getNameId() != name_id_)
 		return false;
 	
 	if (predicate.getArity() != getArity())
@@ -327,7 +338,7 @@ void PredicateManager::checkStaticPredicates(const ActionManager& action_manager
 				const Atom* effect = *ci;
 
 				// Check if the effect can be linked to the predicate.
-				if (effect->getPredicate().getName() != predicate->getName())
+				if (effect->getPredicate().getNameId() != predicate->getNameId())
 				{
 					continue;
 				}
@@ -30,6 +30,12 @@ public:
 	 * Get the name of the predicate.
 	 */
 	const std::string& getName() const { return name_; }
+	
+	/**
+	 * Get the id of the name of this predicate. Predicates which only differ in their types share the same name id, so this
+	 * id can be used instead of comparing the names.
+	 */
+	unsigned int getNameId() const { return name_id_; }
 
 	/**
 	 * Get the types of the predicate.
@@ -87,6 +93,12 @@ public:
 private:
 	// The name of the predicate.
 	const std::string name_;
+	
+	// The id of the name of the predicate.
+	unsigned int name_id_;
+	
+	// The ids assigned to the names of all the predicates created so far.
+	static std::map<std::string, unsigned int> name_ids_;
 
 	// The terms of this predicate.
 	const std::vector<const Type*>* types_;
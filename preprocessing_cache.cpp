@@ -0,0 +1,174 @@
+#include "preprocessing_cache.h"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+namespace MyPOP
+{
+
+static const char CACHE_MAGIC[] = "LRPGCACHE";
+static const unsigned int CACHE_VERSION = 1;
+
+namespace
+{
+
+/**
+ * Add the contents of @param file_name to the FNV-1a hash @param hash.
+ * @param size Set to the number of bytes in the file.
+ * @return False if the file could not be read.
+ */
+bool hashFile(const std::string& file_name, uint64_t& hash, uint64_t& size)
+{
+	std::ifstream file(file_name.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	size = 0;
+	char buffer[4096];
+	while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+	{
+		for (std::streamsize i = 0; i < file.gcount(); ++i)
+		{
+			hash ^= (unsigned char)buffer[i];
+			hash *= 1099511628211ULL;
+		}
+		size += file.gcount();
+	}
+	return !file.bad();
+}
+
+};
+
+PreprocessingCache::PreprocessingCache(const std::string& directory, const std::string& domain_file_name, const std::string& problem_file_name)
+	: is_valid_(false), key_(14695981039346656037ULL), domain_size_(0), problem_size_(0)
+{
+	is_valid_ = hashFile(domain_file_name, key_, domain_size_) && hashFile(problem_file_name, key_, problem_size_);
+	if (!is_valid_)
+	{
+		std::cerr << "Could not read the domain and problem files, the preprocessing cache is not used." << std::endl;
+	}
+
+	std::stringstream file_name;
+	file_name << directory << "/" << std::hex << std::setw(16) << std::setfill('0') << key_ << ".cache";
+	file_name_ = file_name.str();
+
+	std::stringstream temporary_file_name;
+	temporary_file_name << file_name_ << "." << getpid() << ".tmp";
+	temporary_file_name_ = temporary_file_name.str();
+}
+
+PreprocessingCache::~PreprocessingCache()
+{
+	file_.close();
+}
+
+bool PreprocessingCache::startReading()
+{
+	if (!is_valid_)
+	{
+		return false;
+	}
+
+	file_.close();
+	file_.clear();
+	file_.open(file_name_.c_str(), std::ios::in | std::ios::binary);
+	char magic[sizeof(CACHE_MAGIC)];
+	uint64_t version = 0;
+	uint64_t key = 0;
+	uint64_t domain_size = 0;
+	uint64_t problem_size = 0;
+	return file_.read(magic, sizeof(CACHE_MAGIC)) && memcmp(magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+	       read(version, 1) && version == CACHE_VERSION && read(key, 8) && key == key_ &&
+	       read(domain_size, 8) && domain_size == domain_size_ && read(problem_size, 8) && problem_size == problem_size_;
+}
+
+bool PreprocessingCache::startWriting()
+{
+	if (!is_valid_)
+	{
+		return false;
+	}
+
+	file_.close();
+	file_.clear();
+	file_.open(temporary_file_name_.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	file_.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	write(CACHE_VERSION, 1);
+	write(key_, 8);
+	write(domain_size_, 8);
+	write(problem_size_, 8);
+	if (!file_.good())
+	{
+		std::cerr << "Could not write the preprocessing cache " << temporary_file_name_ << "." << std::endl;
+		abortWriting();
+		return false;
+	}
+	return true;
+}
+
+bool PreprocessingCache::finishWriting()
+{
+	file_.flush();
+	bool written = file_.good();
+	file_.close();
+	if (!written || rename(temporary_file_name_.c_str(), file_name_.c_str()) != 0)
+	{
+		std::cerr << "Could not write the preprocessing cache " << file_name_ << "." << std::endl;
+		remove(temporary_file_name_.c_str());
+		return false;
+	}
+	return true;
+}
+
+void PreprocessingCache::abortWriting()
+{
+	file_.close();
+	remove(temporary_file_name_.c_str());
+}
+
+void PreprocessingCache::write(uint32_t value)
+{
+	write(value, 4);
+}
+
+bool PreprocessingCache::read(uint32_t& value)
+{
+	uint64_t read_value;
+	if (!read(read_value, 4))
+	{
+		return false;
+	}
+	value = read_value;
+	return true;
+}
+
+void PreprocessingCache::write(uint64_t value, unsigned int bytes)
+{
+	for (unsigned int i = 0; i < bytes; ++i)
+	{
+		file_.put((char)((value >> (8 * i)) & 0xff));
+	}
+}
+
+bool PreprocessingCache::read(uint64_t& value, unsigned int bytes)
+{
+	value = 0;
+	for (unsigned int i = 0; i < bytes; ++i)
+	{
+		int byte = file_.get();
+		if (byte == EOF)
+		{
+			return false;
+		}
+		value |= ((uint64_t)byte) << (8 * i);
+	}
+	return true;
+}
+
+};
@@ -0,0 +1,82 @@
+#ifndef MYPOP_PREPROCESSING_CACHE_H
+#define MYPOP_PREPROCESSING_CACHE_H
+
+#include <fstream>
+#include <string>
+#include <stdint.h>
+
+namespace MyPOP
+{
+
+/**
+ * A file in a cache directory which stores the results of the preprocessing steps that only depend on the domain and the
+ * problem, so later runs on the same domain and problem can skip them. The name of the file is derived from a hash of the
+ * contents of the domain and problem files, so a changed domain or problem never uses a stale file.
+ *
+ * The file starts with a header (magic, version, the hash and the sizes of the domain and problem files) followed by the
+ * stored results. All numbers are stored little endian. The version must be incremented whenever the results which are stored
+ * or the way they are computed change.
+ */
+class PreprocessingCache
+{
+public:
+	/**
+	 * @param directory The directory which holds the cached files, it must exist.
+	 * @param domain_file_name The PDDL domain file, its contents are part of the key.
+	 * @param problem_file_name The PDDL problem file, its contents are part of the key.
+	 */
+	PreprocessingCache(const std::string& directory, const std::string& domain_file_name, const std::string& problem_file_name);
+
+	~PreprocessingCache();
+
+	const std::string& getFileName() const { return file_name_; }
+
+	/**
+	 * Start reading the stored results.
+	 * @return True if the cache holds the results for the domain and problem.
+	 */
+	bool startReading();
+
+	/**
+	 * Start storing the results, they are written to a temporary file which only replaces the cached file once @ref
+	 * finishWriting is called. Runs which share the cache directory therefore never read a partially written file.
+	 * @return True if the temporary file could be created.
+	 */
+	bool startWriting();
+
+	/**
+	 * @return True if all the results have been written and the cached file has been replaced.
+	 */
+	bool finishWriting();
+
+	/**
+	 * Give up storing the results, the temporary file is removed.
+	 */
+	void abortWriting();
+
+	void write(uint32_t value);
+	bool read(uint32_t& value);
+
+private:
+
+	PreprocessingCache(const PreprocessingCache& other);
+	PreprocessingCache& operator=(const PreprocessingCache& other);
+
+	void write(uint64_t value, unsigned int bytes);
+	bool read(uint64_t& value, unsigned int bytes);
+
+	std::string file_name_;
+	std::string temporary_file_name_;
+	std::fstream file_;
+
+	// True if the domain and problem files could be read.
+	bool is_valid_;
+	// The hash of the contents of the domain and problem files and the sizes of both files.
+	uint64_t key_;
+	uint64_t domain_size_;
+	uint64_t problem_size_;
+};
+
+};
+
+#endif
@@ -233,7 +233,7 @@ MultiValuedTransition* MultiValuedTransition::migrateTransition(MultiValuedValue
 			{
 				const Atom* initial_fact = *ci;
 				if (initial_fact->getArity() != precondition->getArity() ||
-					initial_fact->getPredicate().getName() != precondition->getPredicate().getName())
+					initial_fact->getPredicate().getNameId() != precondition->getPredicate().getNameId())
 				{
 					continue;
 				}
@@ -330,7 +330,7 @@ MultiValuedTransition* MultiValuedTransition::migrateTransition(MultiValuedValue
 					HEURISTICS::Fact* effect = to_node.getValues()[effect_index];
 					
 					if (precondition->getPredicate().getArity() != effect->getPredicate().getArity() ||
-					    precondition->getPredicate().getName() != effect->getPredicate().getName())
+					    precondition->getPredicate().getNameId() != effect->getPredicate().getNameId())
 					{
 						continue;
 					}
@@ -509,7 +509,7 @@ void MultiValuedTransition::migrateTransition(std::vector<MultiValuedTransition*
 			for (std::vector<const Atom*>::const_iterator ci = initial_facts.begin(); ci != initial_facts.end(); ++ci)
 			{
 				const Atom* initial_fact = *ci;
-				if (initial_fact->getPredicate().getName() != precondition->getPredicate().getName() ||
+				if (initial_fact->getPredicate().getNameId() != precondition->getPredicate().getNameId() ||
 				    initial_fact->getArity() != precondition->getArity())
 				{
 					continue;
@@ -1178,7 +1178,7 @@ void LiftedDTG::createLiftedDTGs(std::vector< LiftedDTG* >& created_lifted_dtgs,
 				}
 				
 				if (effect->getArity() != predicate->getArity() ||
-				    effect->getPredicate().getName() != predicate->getName())
+				    effect->getPredicate().getNameId() != predicate->getNameId())
 				{
 					continue;
 				}
@@ -1481,7 +1481,7 @@ void LiftedDTG::splitLiftedTransitionGraphs(std::vector<LiftedDTG*>& split_ltgs,
 				{
 					const Atom* other_static_fact = *ci;
 					if (static_fact->getArity() != other_static_fact->getArity() ||
-					    static_fact->getPredicate().getName() != other_static_fact->getPredicate().getName())
+					    static_fact->getPredicate().getNameId() != other_static_fact->getPredicate().getNameId())
 					{
 						continue;
 					}
@@ -2498,7 +2498,7 @@ void LiftedDTG::ground(const std::vector<LiftedDTG*>& all_lifted_dtgs, const std
 				{
 					const Atom* other_static_fact = *ci;
 					if (static_fact->getArity() != other_static_fact->getArity() ||
-					    static_fact->getPredicate().getName() != other_static_fact->getPredicate().getName())
+					    static_fact->getPredicate().getNameId() != other_static_fact->getPredicate().getNameId())
 					{
 						continue;
 					}
@@ -52,7 +52,7 @@ PropertyStateTransition::PropertyStateTransition(PropertyState& lhs, PropertySta
 			const Atom* precondition = *ci;
 			
 			if (property->getPredicate().getArity() != precondition->getPredicate().getArity() ||
-			    property->getPredicate().getName() != precondition->getPredicate().getName())
+			    property->getPredicate().getNameId() != precondition->getPredicate().getNameId())
 			{
 				continue;
 			}
@@ -64,7 +64,7 @@ PropertyStateTransition::PropertyStateTransition(PropertyState& lhs, PropertySta
 				const Atom* effect = *ci;
 				if (!effect->isNegative() ||
 				    precondition->getArity() != effect->getArity() ||
-				    precondition->getPredicate().getName() != effect->getPredicate().getName())
+				    precondition->getPredicate().getNameId() != effect->getPredicate().getNameId())
 				{
 					continue;
 				}
@@ -127,7 +127,7 @@ PropertyStateTransition::PropertyStateTransition(PropertyState& lhs, PropertySta
 				const Property* effect = *ci;
 				if (effect->getIndex() == property->getIndex() &&
 				    effect->getPredicate().getArity() == property->getPredicate().getArity() &&
-				    effect->getPredicate().getName() == property->getPredicate().getName())
+				    effect->getPredicate().getNameId() == property->getPredicate().getNameId())
 				{
 					(*effect_properties_to_action_variable_index_)[effect] = new std::vector<unsigned int>(*mappings);
 					break;
@@ -345,7 +345,7 @@ bool PropertyState::contains(InvariableIndex index, const Predicate& predicate)
 	for (std::vector<const Property*>::const_iterator ci = property_.begin(); ci != property_.end(); ci++)
 	{
 		const Property* property = *ci;
-		if (property->getPredicate().getName() == predicate.getName() && property->getPredicate().getArity() == predicate.getArity() && property->getIndex() == index)
+		if (property->getPredicate().getNameId() == predicate.getNameId() && property->getPredicate().getArity() == predicate.getArity() && property->getIndex() == index)
 		{
 			return true;
 		}
@@ -594,7 +594,7 @@ FoundVariableMappings* PropertyState::getMappings(const TypeManager& type_manage
 	{
 		const Atom* action_fact = *ci;
 		if (action_fact->getArity() != property_to_process->getPredicate().getArity() ||
-		    action_fact->getPredicate().getName() != property_to_process->getPredicate().getName())
+		    action_fact->getPredicate().getNameId() != property_to_process->getPredicate().getNameId())
 		{
 			continue;
 		}
@@ -810,12 +810,12 @@ bool Property::isMutexWith(const Property* property) const
 			{
 				const Property* other_property = *ci;
 				
-				if (property->getIndex() == other_property->getIndex() && property->getPredicate().getName() == other_property->getPredicate().getName() && property->getPredicate().getArity() == other_property->getPredicate().getArity())
+				if (property->getIndex() == other_property->getIndex() && property->getPredicate().getNameId() == other_property->getPredicate().getNameId() && property->getPredicate().getArity() == other_property->getPredicate().getArity())
 				{
 					++counter;
 				}
 				
-				if (getIndex() == other_property->getIndex() && getPredicate().getName() == other_property->getPredicate().getName() && getPredicate().getArity() == other_property->getPredicate().getArity())
+				if (getIndex() == other_property->getIndex() && getPredicate().getNameId() == other_property->getPredicate().getNameId() && getPredicate().getArity() == other_property->getPredicate().getArity())
 				{
 					++counter;
 				}
@@ -1141,7 +1141,7 @@ void PropertySpace::copyMergedTransitions(const PropertySpace& property_space, s
 							for (std::vector<const Atom*>::const_iterator ci = old_transition->getAction().getEffects().begin(); ci != old_transition->getAction().getEffects().end(); ++ci)
 							{
 								const Atom* effect = *ci;
-								if (precondition->getPredicate().getName() != effect->getPredicate().getName() ||
+								if (precondition->getPredicate().getNameId() != effect->getPredicate().getNameId() ||
 										precondition->getPredicate().getArity() != effect->getPredicate().getArity())
 								{
 									continue;
@@ -1374,7 +1374,7 @@ void PropertySpace::getMatchingFacts(std::vector<const Atom*>& matching_facts, c
 	{
 		const Atom* fact = *ci;
 		
-		if (fact->getPredicate().getName() != property.getPredicate().getName() ||
+		if (fact->getPredicate().getNameId() != property.getPredicate().getNameId() ||
 				fact->getArity() != property.getPredicate().getArity())
 		{
 			continue;
@@ -1572,7 +1572,7 @@ bool PropertySpace::violatesPrecondition(const Atom& precondition, unsigned int
 #endif
 */
 		if (precondition.getArity() != property->getPredicate().getArity() ||
-				precondition.getPredicate().getName() != property->getPredicate().getName() ||
+				precondition.getPredicate().getNameId() != property->getPredicate().getNameId() ||
 				invariable_precondition_index != property->getIndex())
 		{
 /*
@@ -1633,7 +1633,7 @@ bool PropertySpace::violatesPrecondition(const Atom& precondition, unsigned int
 //			std::cout << "Property: " << *property << "." << std::endl;
 #endif
 			if (precondition.getArity() != property->getPredicate().getArity() ||
-					precondition.getPredicate().getName() != property->getPredicate().getName() ||
+					precondition.getPredicate().getNameId() != property->getPredicate().getNameId() ||
 					invariable_precondition_index != property->getIndex())
 			{
 #ifdef MYPOP_SAS_PLUS_PROPERTY_SPACE_COMMENT
@@ -0,0 +1,131 @@
+#include "search_trace.h"
+
+#include <iostream>
+#include <cstring>
+
+#include "fc_planner.h"
+
+namespace MyPOP
+{
+
+static const char TRACE_MAGIC[] = "LRPGTRACE";
+static const unsigned int TRACE_VERSION = 1;
+
+SearchTrace::SearchTrace(const std::string& file_name, bool replay, uint32_t seed)
+	: replay_(replay), is_open_(false), seed_(seed), number_of_events_(0), diverged_(false)
+{
+	if (replay_)
+	{
+		file_.open(file_name.c_str(), std::ios::in | std::ios::binary);
+		char magic[sizeof(TRACE_MAGIC)];
+		uint64_t version = 0;
+		uint64_t recorded_seed = 0;
+		if (file_.read(magic, sizeof(TRACE_MAGIC)) && memcmp(magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) == 0 &&
+		    read(version, 1) && version == TRACE_VERSION && read(recorded_seed, 4))
+		{
+			seed_ = recorded_seed;
+			is_open_ = true;
+		}
+	}
+	else
+	{
+		file_.open(file_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		file_.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+		write(TRACE_VERSION, 1);
+		write(seed_, 4);
+		is_open_ = file_.good();
+	}
+
+	if (!is_open_)
+	{
+		std::cerr << "Could not open the search trace " << file_name << "." << std::endl;
+	}
+}
+
+SearchTrace::~SearchTrace()
+{
+	file_.close();
+}
+
+void SearchTrace::addEvent(EVENT_TYPE type, const State& state)
+{
+	if (!is_open_)
+	{
+		return;
+	}
+
+	++number_of_events_;
+	if (!replay_)
+	{
+		write(type, 1);
+		write(state.getHeuristic(), 4);
+		write(state.getDistanceFromStart(), 4);
+		write(state.getSignature(), 8);
+		return;
+	}
+
+	// Only report the first divergence, all later events are likely to differ as well.
+	if (diverged_)
+	{
+		return;
+	}
+
+	uint64_t recorded_type, recorded_heuristic, recorded_distance_from_start, recorded_signature;
+	if (!read(recorded_type, 1) || !read(recorded_heuristic, 4) || !read(recorded_distance_from_start, 4) || !read(recorded_signature, 8))
+	{
+		std::cerr << "Search trace diverges at event " << number_of_events_ << ": the recorded trace has ended." << std::endl;
+		diverged_ = true;
+		return;
+	}
+
+	if (recorded_type != (uint64_t)type || recorded_heuristic != (uint32_t)state.getHeuristic() || recorded_distance_from_start != state.getDistanceFromStart() || recorded_signature != (uint64_t)state.getSignature())
+	{
+		std::cerr << "Search trace diverges at event " << number_of_events_ << ": recorded (type=" << recorded_type << ", h=" << recorded_heuristic << ", g=" << recorded_distance_from_start << ", signature=" << recorded_signature << "), found (type=" << type << ", h=" << state.getHeuristic() << ", g=" << state.getDistanceFromStart() << ", signature=" << (uint64_t)state.getSignature() << ")." << std::endl;
+		diverged_ = true;
+	}
+}
+
+bool SearchTrace::finish()
+{
+	if (!is_open_ || !replay_)
+	{
+		return true;
+	}
+
+	if (!diverged_ && file_.peek() != EOF)
+	{
+		std::cerr << "Search trace diverges after event " << number_of_events_ << ": the recorded trace has more events." << std::endl;
+		diverged_ = true;
+	}
+
+	if (!diverged_)
+	{
+		std::cerr << "Search trace matches the recorded trace (" << number_of_events_ << " events)." << std::endl;
+	}
+	return !diverged_;
+}
+
+void SearchTrace::write(uint64_t value, unsigned int bytes)
+{
+	for (unsigned int i = 0; i < bytes; ++i)
+	{
+		file_.put((char)((value >> (8 * i)) & 0xff));
+	}
+}
+
+bool SearchTrace::read(uint64_t& value, unsigned int bytes)
+{
+	value = 0;
+	for (unsigned int i = 0; i < bytes; ++i)
+	{
+		int byte = file_.get();
+		if (byte == EOF)
+		{
+			return false;
+		}
+		value |= ((uint64_t)byte) << (8 * i);
+	}
+	return true;
+}
+
+};
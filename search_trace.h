@@ -0,0 +1,77 @@
+#ifndef MYPOP_SEARCH_TRACE_H
+#define MYPOP_SEARCH_TRACE_H
+
+#include <fstream>
+#include <string>
+#include <stdint.h>
+
+namespace MyPOP
+{
+
+class State;
+
+/**
+ * A compact binary record of the order in which the forward chaining planner expands states, their heuristic values and the
+ * restarts. A trace is either recorded to a file, or a previously recorded trace is replayed: every event is then compared
+ * against the recorded one, so two runs can be checked for determinism.
+ *
+ * The file starts with a header (magic, version, seed) followed by one record of 17 bytes per event: the event type, the
+ * heuristic value, the distance from the initial state and the signature of the state. All numbers are stored little endian.
+ */
+class SearchTrace
+{
+public:
+	enum EVENT_TYPE { EXPAND = 0, RESTART = 1, GOAL = 2 };
+
+	/**
+	 * Open a trace.
+	 * @param file_name The file to record the trace to, or to read the trace to replay from.
+	 * @param replay If true the trace in @ref file_name is replayed, otherwise a new trace is recorded.
+	 * @param seed The seed of the search, stored in the header when recording.
+	 */
+	SearchTrace(const std::string& file_name, bool replay, uint32_t seed);
+
+	~SearchTrace();
+
+	/**
+	 * @return True if the trace file could be opened (and, when replaying, has a valid header).
+	 */
+	bool isOpen() const { return is_open_; }
+
+	bool isReplay() const { return replay_; }
+
+	/**
+	 * @return The seed stored in the header of the trace.
+	 */
+	uint32_t getSeed() const { return seed_; }
+
+	/**
+	 * Record the event for @param state, or compare it against the next recorded event when replaying.
+	 */
+	void addEvent(EVENT_TYPE type, const State& state);
+
+	/**
+	 * When replaying, report whether all the events matched the recorded trace.
+	 * @return False if the run diverged from the recorded trace, true otherwise.
+	 */
+	bool finish();
+
+private:
+
+	void write(uint64_t value, unsigned int bytes);
+	bool read(uint64_t& value, unsigned int bytes);
+
+	std::fstream file_;
+	bool replay_;
+	bool is_open_;
+	uint32_t seed_;
+
+	// The number of events recorded or compared.
+	uint64_t number_of_events_;
+	// True if an event did not match the recorded trace.
+	bool diverged_;
+};
+
+};
+
+#endif
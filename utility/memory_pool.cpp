@@ -1,57 +1,90 @@
 #include "memory_pool.h"
 #include <stdlib.h>
 #include <assert.h>
+#include <algorithm>
+#include <ostream>
 
 namespace MyPOP {
 
 namespace UTILITY {
 
-MemoryChunk::MemoryChunk(size_t unit_size, MemoryChunk* previous_chunk, unsigned int nr_units)
-	: unit_size_(unit_size), previous_chunk_(previous_chunk), nr_units_(nr_units)
+MemoryChunk::MemoryChunk(size_t unit_size, unsigned int nr_units)
+	: next_chunk_(NULL)
 {
-	// Allocate all the memory we need.
-	allocated_memory_ = malloc(nr_units_ * (unit_size + sizeof(struct MemoryElement)));
+	// Allocate all the memory we need, the units are only touched once they are handed out.
+	allocated_memory_ = static_cast<char*>(malloc(nr_units * unit_size));
 	assert (allocated_memory_ != NULL);
-	
-	// Structure the memory, such that each memory element points to the next available memory location.
-	struct MemoryElement* next_unit = NULL;
-	for (unsigned int i = 0; i < nr_units; i++)
-	{
-		unsigned int index = nr_units - 1 - i;
-		MemoryElement* cur_unit = (struct MemoryElement*)((char*)allocated_memory_ + index * (unit_size + sizeof(struct MemoryElement)));
-		cur_unit->next_free_memory_slot_ = next_unit;
-		next_unit = cur_unit;
-	}
+	end_ = allocated_memory_ + nr_units * unit_size;
 }
 
 MemoryChunk::~MemoryChunk()
 {
 	free(allocated_memory_);
-	delete previous_chunk_;
 }
 
-MemoryPool::MemoryPool(size_t unit_size)
-	: unit_size_(unit_size)
+MemoryPoolStatistics::MemoryPoolStatistics()
+	: reserved_bytes_(0), live_units_(0), high_water_mark_(0)
+{
+
+}
+
+void MemoryPoolStatistics::add(const MemoryPoolStatistics& other)
+{
+	reserved_bytes_ += other.reserved_bytes_;
+	live_units_ += other.live_units_;
+	high_water_mark_ += other.high_water_mark_;
+}
+
+std::ostream& operator<<(std::ostream& os, const MemoryPoolStatistics& statistics)
+{
+	os << "Reserved bytes: " << statistics.reserved_bytes_ << ". Live units: " << statistics.live_units_ << ". High-water mark: " << statistics.high_water_mark_ << ".";
+	return os;
+}
+
+MemoryPool::MemoryPool(size_t unit_size, unsigned int max_units_per_chunk)
+	: max_units_per_chunk_(max_units_per_chunk), first_chunk_(NULL), current_chunk_(NULL), last_chunk_(NULL), next_unit_(NULL), current_free_slot_(NULL)
 {
 //	std::cerr << "Initialise the memory pool with the size of: " << unit_size << std::endl;
-	latest_created_chunk_ = NULL;
-	createNewMemoryChunk();
+	// Every unit must be able to hold the link to the next free unit and keep the units aligned.
+	unit_size_ = std::max(unit_size, sizeof(MemoryElement));
+	unit_size_ = (unit_size_ + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*);
+	next_chunk_units_ = INITIAL_UNITS_PER_CHUNK < max_units_per_chunk_ ? INITIAL_UNITS_PER_CHUNK : max_units_per_chunk_;
 }
 
 MemoryPool::~MemoryPool()
 {
-	delete latest_created_chunk_;
+	// Release the chunks one by one, a long chain of chunks must not exhaust the stack.
+	MemoryChunk* chunk = first_chunk_;
+	while (chunk != NULL)
+	{
+		MemoryChunk* next_chunk = chunk->getNextChunk();
+		delete chunk;
+		chunk = next_chunk;
+	}
 }
 
 void* MemoryPool::allocate(size_t size)
 {
-	MemoryElement* next_free_slot = current_free_slot_->next_free_memory_slot_;
-	MemoryElement* to_return = current_free_slot_;
-	current_free_slot_ = next_free_slot;
-	
-	// Check if we need to allocate more memory!
-	if (current_free_slot_ == NULL) createNewMemoryChunk();
-	
+	assert (size <= unit_size_);
+	void* to_return;
+	if (current_free_slot_ != NULL)
+	{
+		to_return = current_free_slot_;
+		current_free_slot_ = current_free_slot_->next_free_memory_slot_;
+	}
+	else
+	{
+		// Check if we need more memory!
+		if (current_chunk_ == NULL || next_unit_ == current_chunk_->end())
+		{
+			useNextMemoryChunk();
+		}
+		to_return = next_unit_;
+		next_unit_ += unit_size_;
+	}
+
+	++statistics_.live_units_;
+	statistics_.high_water_mark_ = std::max(statistics_.high_water_mark_, statistics_.live_units_);
 	return to_return;
 }
 
@@ -60,14 +93,97 @@ void MemoryPool::free(void* p)
 	MemoryElement* to_free = static_cast<struct MemoryElement*>(p);
 	to_free->next_free_memory_slot_ = current_free_slot_;
 	current_free_slot_ = to_free;
+	--statistics_.live_units_;
+}
+
+void MemoryPool::reset()
+{
+	current_chunk_ = first_chunk_;
+	next_unit_ = first_chunk_ != NULL ? first_chunk_->begin() : NULL;
+	current_free_slot_ = NULL;
+	statistics_.live_units_ = 0;
+}
+
+void MemoryPool::useNextMemoryChunk()
+{
+	// After a reset the chunks which have already been created are used again.
+	if (current_chunk_ != NULL && current_chunk_->getNextChunk() != NULL)
+	{
+		current_chunk_ = current_chunk_->getNextChunk();
+		next_unit_ = current_chunk_->begin();
+		return;
+	}
+
+	MemoryChunk* chunk = new MemoryChunk(unit_size_, next_chunk_units_);
+	statistics_.reserved_bytes_ += chunk->getSize();
+	next_chunk_units_ = std::min(next_chunk_units_ * 2, max_units_per_chunk_);
+
+	if (last_chunk_ == NULL)
+	{
+		first_chunk_ = chunk;
+	}
+	else
+	{
+		last_chunk_->setNextChunk(chunk);
+	}
+	last_chunk_ = chunk;
+	current_chunk_ = chunk;
+	next_unit_ = chunk->begin();
+}
+
+SizeClassMemoryPool::SizeClassMemoryPool(unsigned int max_units_per_chunk)
+	: max_units_per_chunk_(max_units_per_chunk)
+{
+
 }
 
-void MemoryPool::createNewMemoryChunk()
+SizeClassMemoryPool::~SizeClassMemoryPool()
 {
-	latest_created_chunk_ = new MemoryChunk(unit_size_, latest_created_chunk_);
-	current_free_slot_ = latest_created_chunk_->begin();
+	for (std::vector<MemoryPool*>::const_iterator ci = memory_pools_.begin(); ci != memory_pools_.end(); ++ci)
+	{
+		delete *ci;
+	}
+}
+
+void SizeClassMemoryPool::reset()
+{
+	for (std::vector<MemoryPool*>::const_iterator ci = memory_pools_.begin(); ci != memory_pools_.end(); ++ci)
+	{
+		if (*ci != NULL)
+		{
+			(*ci)->reset();
+		}
+	}
+}
+
+MemoryPool& SizeClassMemoryPool::getMemoryPool(size_t size)
+{
+	unsigned int index = (size + sizeof(void*) - 1) / sizeof(void*);
+	if (index >= memory_pools_.size())
+	{
+		memory_pools_.resize(index + 1, NULL);
+	}
+
+	MemoryPool* memory_pool = memory_pools_[index];
+	if (memory_pool == NULL)
+	{
+		memory_pool = new MemoryPool(index * sizeof(void*), max_units_per_chunk_);
+		memory_pools_[index] = memory_pool;
+	}
+	return *memory_pool;
+}
+
+void SizeClassMemoryPool::getStatistics(MemoryPoolStatistics& statistics) const
+{
+	for (std::vector<MemoryPool*>::const_iterator ci = memory_pools_.begin(); ci != memory_pools_.end(); ++ci)
+	{
+		if (*ci != NULL)
+		{
+			statistics.add((*ci)->getStatistics());
+		}
+	}
 }
 
 };
 
-};
\ No newline at end of file
+};
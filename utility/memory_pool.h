@@ -2,6 +2,8 @@
 #define MYPOP_UTILITY_MEMORY_POOL_H
 
 #include <cstring>
+#include <vector>
+#include <iosfwd>
 
 namespace MyPOP {
 
@@ -12,49 +14,168 @@ struct MemoryElement
 	MemoryElement* next_free_memory_slot_;
 };
 
+/**
+ * A block of memory which is handed out by a memory pool one unit at a time.
+ */
 class MemoryChunk
 {
 public:
-	MemoryChunk(size_t unit_size, MemoryChunk* previous_chunk, unsigned int nr_units = 100000);
+	MemoryChunk(size_t unit_size, unsigned int nr_units);
 	~MemoryChunk();
 
-	MemoryElement* begin() const { return (struct MemoryElement*)allocated_memory_; }
-	
+	char* begin() const { return allocated_memory_; }
+	char* end() const { return end_; }
+
+	size_t getSize() const { return end_ - allocated_memory_; }
+
+	MemoryChunk* getNextChunk() const { return next_chunk_; }
+	void setNextChunk(MemoryChunk* next_chunk) { next_chunk_ = next_chunk; }
+
 private:
-	
-	void* allocated_memory_;
-	
-	size_t unit_size_;
-	MemoryChunk* previous_chunk_;
-	unsigned int nr_units_;
+
+	char* allocated_memory_;
+	char* end_;
+
+	MemoryChunk* next_chunk_;
+};
+
+/**
+ * The usage of one or more memory pools.
+ */
+struct MemoryPoolStatistics
+{
+	MemoryPoolStatistics();
+
+	void add(const MemoryPoolStatistics& other);
+
+	// The number of bytes allocated from the heap.
+	size_t reserved_bytes_;
+
+	// The number of units which have been handed out and not yet been freed.
+	size_t live_units_;
+
+	// The largest number of live units (summed over the pools when the statistics of several pools are combined).
+	size_t high_water_mark_;
 };
 
+std::ostream& operator<<(std::ostream& os, const MemoryPoolStatistics& statistics);
+
 /**
- * This is a memory pool which is used to make the usage of reachable facts more efficient in both time and memory.
+ * This is a memory pool which is used to make the usage of reachable facts more efficient in both time and memory. It hands
+ * out units of a fixed size from chunks which start small and double in size up to a maximum, units which are freed are
+ * reused first.
+ *
+ * A memory pool is not thread-safe, every thread which needs one owns its own (see @ref SizeClassMemoryPool) so allocating
+ * and freeing never needs to lock.
  */
 class MemoryPool
 {
 public:
 	/**
-	 * Create a memory pool for the given set of arities.
+	 * Create a memory pool which hands out units of @param unit_size bytes.
+	 * @param max_units_per_chunk The largest number of units allocated at once every time the pool runs out of memory.
 	 */
-	MemoryPool(size_t unit_size);
-	
+	MemoryPool(size_t unit_size, unsigned int max_units_per_chunk = 100000);
+
 	~MemoryPool();
-	
+
+	/**
+	 * @param size The number of bytes needed, must not exceed the unit size of this pool.
+	 */
 	void* allocate(size_t size);
-	
+
 	void free(void* p);
-	
+
+	/**
+	 * Release all the units at once, every unit handed out by this pool becomes invalid. The chunks are kept and reused.
+	 */
+	void reset();
+
+	size_t getUnitSize() const { return unit_size_; }
+
+	const MemoryPoolStatistics& getStatistics() const { return statistics_; }
+
 private:
-	
+
+	MemoryPool(const MemoryPool& other);
+	MemoryPool& operator=(const MemoryPool& other);
+
+	/**
+	 * Continue handing out units from the next chunk, a new chunk is created if all existing chunks are in use.
+	 */
+	void useNextMemoryChunk();
+
 	size_t unit_size_;
-	
-	void createNewMemoryChunk();
-	
+	unsigned int max_units_per_chunk_;
+
+	// The number of units of the next chunk to be created.
+	unsigned int next_chunk_units_;
+
+	// The chunks in the order they have been created, units are handed out from the current chunk.
+	MemoryChunk* first_chunk_;
+	MemoryChunk* current_chunk_;
+	MemoryChunk* last_chunk_;
+
+	// The first unit of the current chunk which has never been handed out.
+	char* next_unit_;
+
+	// The units which have been freed.
 	MemoryElement* current_free_slot_;
-	
-	MemoryChunk* latest_created_chunk_;
+
+	MemoryPoolStatistics statistics_;
+
+	// The number of units of the first chunk.
+	static const unsigned int INITIAL_UNITS_PER_CHUNK = 64;
+};
+
+/**
+ * A set of memory pools for units of any size. Sizes are rounded up to a multiple of the size of a pointer and every such
+ * size class gets its own memory pool once it is used.
+ *
+ * Like @ref MemoryPool it is not thread-safe; it is meant to be owned by a single thread, e.g. through a
+ * boost::thread_specific_ptr, so that it acts as a lock free cache for that thread.
+ */
+class SizeClassMemoryPool
+{
+public:
+	/**
+	 * @param max_units_per_chunk The largest number of units allocated at once by the memory pools of the size classes.
+	 */
+	SizeClassMemoryPool(unsigned int max_units_per_chunk = 100000);
+
+	~SizeClassMemoryPool();
+
+	void* allocate(size_t size) { return getMemoryPool(size).allocate(size); }
+
+	/**
+	 * @param size The size @param p has been allocated with.
+	 */
+	void free(void* p, size_t size) { getMemoryPool(size).free(p); }
+
+	/**
+	 * Release all the units of all size classes at once.
+	 */
+	void reset();
+
+	/**
+	 * @return The memory pool which hands out the units of @param size bytes.
+	 */
+	MemoryPool& getMemoryPool(size_t size);
+
+	/**
+	 * Add the usage of all the size classes to @param statistics.
+	 */
+	void getStatistics(MemoryPoolStatistics& statistics) const;
+
+private:
+
+	SizeClassMemoryPool(const SizeClassMemoryPool& other);
+	SizeClassMemoryPool& operator=(const SizeClassMemoryPool& other);
+
+	unsigned int max_units_per_chunk_;
+
+	// The memory pools indexed by the number of pointers which fit in their units.
+	std::vector<MemoryPool*> memory_pools_;
 };
 
 };